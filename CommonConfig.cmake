@@ -189,8 +189,57 @@ if (TFM_PSA_API)
 	add_definitions(-DTFM_PSA_API)
 endif()
 
+#Allow RoT Services to access client input and output vectors in place, when
+#their own memory access permissions allow it, instead of copying them.
+#This weakens the isolation of the service from its clients: a mapped vector
+#stays in client memory, so the client can change an input while the service
+#reads it and can read an output before the service has replied. The SPM
+#never maps vectors which overlap a vector of the other direction. The crypto
+#service only maps the input of hash and MAC updates and copies all outputs.
+if (NOT DEFINED TFM_MM_IOVEC)
+	set(TFM_MM_IOVEC OFF)
+endif()
+
+if (TFM_PSA_API AND TFM_MM_IOVEC)
+	add_definitions(-DTFM_MM_IOVEC)
+endif()
+
+#Dequeue the messages of a RoT Service in the priority order of their client
+#threads, instead of in arrival order only.
+if (NOT DEFINED TFM_MSG_QUEUE_PRIORITY)
+	set(TFM_MSG_QUEUE_PRIORITY OFF)
+endif()
+
+if (TFM_PSA_API AND TFM_MSG_QUEUE_PRIORITY)
+	add_definitions(-DTFM_MSG_QUEUE_PRIORITY)
+endif()
+
 if (DEFINED TFM_MULTI_CORE_TOPOLOGY AND TFM_MULTI_CORE_TOPOLOGY)
 	add_definitions(-DTFM_MULTI_CORE_TOPOLOGY)
+
+	#Number of PSA client calls the NSPE can have in flight through the mailbox.
+	if (NOT DEFINED NUM_MAILBOX_QUEUE_SLOT)
+		set(NUM_MAILBOX_QUEUE_SLOT 4)
+	endif()
+	add_definitions(-DNUM_MAILBOX_QUEUE_SLOT=${NUM_MAILBOX_QUEUE_SLOT})
+
+	#Pass mailbox requests and replies through lock-free single-producer
+	#single-consumer rings, instead of slot bitmasks shared by both cores.
+	if (NOT DEFINED TFM_MAILBOX_RING)
+		set(TFM_MAILBOX_RING OFF)
+	endif()
+	if (TFM_MAILBOX_RING)
+		add_definitions(-DTFM_MAILBOX_RING)
+	endif()
+
+	#Put the non-secure caller thread to sleep until the reply interrupt from
+	#SPE wakes it up, instead of polling the NSPE mailbox queue.
+	if (NOT DEFINED TFM_MAILBOX_WAIT_IRQ)
+		set(TFM_MAILBOX_WAIT_IRQ OFF)
+	endif()
+	if (TFM_MAILBOX_WAIT_IRQ)
+		add_definitions(-DTFM_MAILBOX_WAIT_IRQ)
+	endif()
 endif()
 
 if (TFM_LEGACY_API)
@@ -351,6 +400,16 @@ if (NOT DEFINED SST_ROLLBACK_PROTECTION)
 	set (SST_ROLLBACK_PROTECTION OFF)
 endif()
 
+#Keeping the storage key resident saves a key derivation per SST access, but
+#the key then stays in the crypto service and occupies one of its key slots.
+if (NOT DEFINED SST_CACHE_STORAGE_KEY)
+	set (SST_CACHE_STORAGE_KEY OFF)
+endif()
+
+if (NOT DEFINED SST_TABLE_JOURNAL)
+	set (SST_TABLE_JOURNAL OFF)
+endif()
+
 if (NOT DEFINED SST_CREATE_FLASH_LAYOUT)
 	set (SST_CREATE_FLASH_LAYOUT OFF)
 endif()
@@ -367,6 +426,10 @@ if (NOT DEFINED SST_RAM_FS)
 	endif()
 endif()
 
+if (NOT DEFINED SST_FLASH_COPY_HAL)
+	set (SST_FLASH_COPY_HAL OFF)
+endif()
+
 if (NOT DEFINED SST_TEST_NV_COUNTERS)
 	if (REGRESSION AND ENABLE_SECURE_STORAGE_SERVICE_TESTS)
 		set(SST_TEST_NV_COUNTERS ON)
@@ -375,9 +438,10 @@ if (NOT DEFINED SST_TEST_NV_COUNTERS)
 	endif()
 endif()
 
-# The SST NV counter tests depend on the SST test partition to call
-# sst_system_prepare().
-if (SST_TEST_NV_COUNTERS)
+# The SST NV counter and object table journal tests depend on the SST test
+# partition to call sst_system_prepare().
+if (SST_TEST_NV_COUNTERS OR
+    (SST_TABLE_JOURNAL AND REGRESSION AND ENABLE_SECURE_STORAGE_SERVICE_TESTS))
 	set(TFM_PARTITION_TEST_SST ON)
 	add_definitions(-DTFM_PARTITION_TEST_SST)
 endif()
@@ -391,6 +455,10 @@ if (NOT DEFINED ITS_VALIDATE_METADATA_FROM_FLASH)
 	set (ITS_VALIDATE_METADATA_FROM_FLASH ON)
 endif()
 
+if (NOT DEFINED ITS_METADATA_CACHE)
+	set (ITS_METADATA_CACHE OFF)
+endif()
+
 if (NOT DEFINED ITS_RAM_FS)
 	if (REGRESSION)
 		set (ITS_RAM_FS ON)
@@ -399,6 +467,16 @@ if (NOT DEFINED ITS_RAM_FS)
 	endif()
 endif()
 
+if (NOT DEFINED ITS_FLASH_COPY_HAL)
+	set (ITS_FLASH_COPY_HAL OFF)
+endif()
+
+#Default TF-M crypto service flags.
+#Documentation about these flags can be found in docs/design_documents/tfm_crypto_design.rst
+if (NOT DEFINED CRYPTO_NS_CONN_REUSE)
+	set(CRYPTO_NS_CONN_REUSE OFF)
+endif()
+
 if (NOT DEFINED MBEDCRYPTO_DEBUG)
 	set(MBEDCRYPTO_DEBUG OFF)
 endif()
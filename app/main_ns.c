@@ -26,6 +26,9 @@
 #endif
 #include "log/tfm_assert.h"
 #include "log/tfm_log.h"
+#ifdef TFM_CRYPTO_NS_CONN_REUSE
+#include "tfm_crypto_ns_conn.h"
+#endif
 
 /**
  * \brief Modified table template for user defined SVC functions
@@ -189,6 +192,11 @@ int main(void)
     /* Initialize the TFM NS interface */
     tfm_ns_interface_init();
 
+#ifdef TFM_CRYPTO_NS_CONN_REUSE
+    /* Initialize the cache of connections to the Crypto service */
+    tfm_crypto_ns_conn_init();
+#endif
+
 #if defined(TEST_FRAMEWORK_NS)
     thread_func = test_app;
 #elif defined(PSA_API_TEST_NS)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -11,6 +11,9 @@
 
 #include <string.h>
 #include "cmsis_os2.h"
+#ifdef TFM_CRYPTO_NS_CONN_REUSE
+#include "tfm_crypto_ns_conn.h"
+#endif
 
 /* This is an example OS abstraction layer for CMSIS-RTOSv2 */
 
@@ -164,7 +167,38 @@ uint32_t os_wrapper_thread_get_priority(void *handle, uint32_t *priority)
     return OS_WRAPPER_SUCCESS;
 }
 
+uint32_t os_wrapper_thread_wait_flag(uint32_t flags, uint32_t timeout)
+{
+    uint32_t ret;
+
+    ret = osThreadFlagsWait(flags, osFlagsWaitAny,
+                            (timeout == OS_WRAPPER_WAIT_FOREVER) ?
+                            osWaitForever : timeout);
+    /* Errors are returned with the most significant bit set */
+    if (ret & osFlagsError) {
+        return OS_WRAPPER_ERROR;
+    }
+
+    return ret;
+}
+
+uint32_t os_wrapper_thread_set_flag_isr(void *handle, uint32_t flags)
+{
+    uint32_t ret;
+
+    ret = osThreadFlagsSet((osThreadId_t)handle, flags);
+    if (ret & osFlagsError) {
+        return OS_WRAPPER_ERROR;
+    }
+
+    return OS_WRAPPER_SUCCESS;
+}
+
 void os_wrapper_thread_exit(void)
 {
+#ifdef TFM_CRYPTO_NS_CONN_REUSE
+    /* Drop the connection to the Crypto service cached for this thread */
+    tfm_crypto_ns_conn_release();
+#endif
     osThreadExit();
 }
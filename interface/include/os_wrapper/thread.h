@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -51,6 +51,29 @@ void *os_wrapper_thread_get_handle(void);
  */
 uint32_t os_wrapper_thread_get_priority(void *handle, uint32_t *priority);
 
+/**
+ * \brief Waits for any of the given flags to be set for the calling thread,
+ *        and clears the flags which have been set
+ *
+ * \param[in] flags    Flags to wait for
+ * \param[in] timeout  Timeout value, or \ref OS_WRAPPER_WAIT_FOREVER
+ *
+ * \return Returns the flags which have been set, or \ref OS_WRAPPER_ERROR in
+ *                 case of error or timeout
+ */
+uint32_t os_wrapper_thread_wait_flag(uint32_t flags, uint32_t timeout);
+
+/**
+ * \brief Sets flags of a thread. It can be called from an interrupt handler.
+ *
+ * \param[in] handle   Thread handle
+ * \param[in] flags    Flags to set
+ *
+ * \return Returns \ref OS_WRAPPER_SUCCESS on success, or \ref OS_WRAPPER_ERROR
+ *                 in case of error
+ */
+uint32_t os_wrapper_thread_set_flag_isr(void *handle, uint32_t flags);
+
 /**
  * \brief Exits the calling thread
  */
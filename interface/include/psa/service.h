@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -202,6 +202,93 @@ size_t psa_skip(psa_handle_t msg_handle, uint32_t invec_idx, size_t num_bytes);
 void psa_write(psa_handle_t msg_handle, uint32_t outvec_idx,
                const void *buffer, size_t num_bytes);
 
+#ifdef TFM_MM_IOVEC
+/**
+ * \brief Map a client input vector into the address space of the Secure
+ *        Partition, so that it can be read directly without a copy.
+ *
+ * \note  The mapped data stays in client memory, and the client can change
+ *        it while the Secure Partition reads it. It must only be used by
+ *        operations which read each byte once and whose result is only
+ *        returned to the client.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] invec_idx         Index of the input vector to map. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ *
+ * \retval !NULL                Address of the data remaining in the client
+ *                              input vector. The number of bytes which can be
+ *                              read is the remaining size of the input vector
+ *                              in the message.
+ * \retval NULL                 The input vector cannot be accessed directly by
+ *                              the Secure Partition, overlaps an output
+ *                              vector, or it is empty. The data has to be
+ *                              copied with \ref psa_read.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a
+ *                                \ref PSA_IPC_CALL message.
+ * \arg                           invec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ */
+const void *psa_map_invec(psa_handle_t msg_handle, uint32_t invec_idx);
+
+/**
+ * \brief Map a client output vector into the address space of the Secure
+ *        Partition, so that the response can be written directly without a
+ *        copy.
+ *
+ * \note  The client can read the data written through the mapping, and
+ *        change it, before the message is replied to. It must not be used
+ *        for intermediate results, or for output which is only released
+ *        to the client once it has been verified.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] outvec_idx        Index of the output vector to map. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ *
+ * \retval !NULL                Address following the data already written to
+ *                              the client output vector.
+ * \retval NULL                 The output vector cannot be accessed directly
+ *                              by the Secure Partition, overlaps an input
+ *                              vector, or it is empty. The response has to
+ *                              be copied with \ref psa_write.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a
+ *                                \ref PSA_IPC_CALL message.
+ * \arg                           outvec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ */
+void *psa_map_outvec(psa_handle_t msg_handle, uint32_t outvec_idx);
+
+/**
+ * \brief Unmap a client output vector mapped by \ref psa_map_outvec and
+ *        report the number of bytes written to it.
+ *
+ * \param[in] msg_handle        Handle for the client's message.
+ * \param[in] outvec_idx        Index of the output vector to unmap. Must be
+ *                              less than \ref PSA_MAX_IOVEC.
+ * \param[in] len               Number of bytes written to the client output
+ *                              vector through the mapping.
+ *
+ * \retval void                 Success.
+ * \retval "PROGRAMMER ERROR"   The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a
+ *                                \ref PSA_IPC_CALL message.
+ * \arg                           outvec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           len is greater than the space remaining in
+ *                                the client output vector.
+ */
+void psa_unmap_outvec(psa_handle_t msg_handle, uint32_t outvec_idx,
+                      size_t len);
+#endif /* TFM_MM_IOVEC */
+
 /**
  * \brief Complete handling of a specific message and unblock the client.
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -68,6 +68,19 @@ struct tfm_control_parameter_t {
    size_t out_len;
 };
 
+/*
+ * Structure describing one request of a batched psa_call submission, see
+ * \ref tfm_psa_call_batch_veneer.
+ */
+struct tfm_psa_call_batch_req_t {
+    psa_handle_t handle;
+    int32_t type;
+    const psa_invec *in_vec;
+    size_t in_len;
+    psa_outvec *out_vec;
+    size_t out_len;
+};
+
 /********************* Secure function declarations ***************************/
 
 /**
@@ -133,8 +146,47 @@ psa_status_t tfm_psa_call_veneer(psa_handle_t handle,
  */
 void tfm_psa_close_veneer(psa_handle_t handle);
 
+/**
+ * \brief Call several secure functions in one secure entry.
+ *
+ * \param[in] reqs              Array of requests, processed in order.
+ * \param[in] num               Number of requests in \p reqs.
+ * \param[out] status           Array of \p num status codes, one per request,
+ *                              as \ref tfm_psa_call_veneer would have
+ *                              returned for it.
+ *
+ * \retval PSA_SUCCESS          All requests have been processed. The status
+ *                              of each request is in \p status.
+ * \retval "Does not return"    One of the requests is invalid, see
+ *                              \ref psa_call.
+ */
+psa_status_t tfm_psa_call_batch_veneer(
+                                   const struct tfm_psa_call_batch_req_t *reqs,
+                                   size_t num,
+                                   psa_status_t *status);
+
 /***************** End Secure function declarations ***************************/
 
+/**
+ * \brief Submit several PSA client calls to the SPE in a single secure entry.
+ *
+ * \param[in] reqs              Array of requests, processed in order.
+ * \param[in] num               Number of requests in \p reqs.
+ * \param[out] status           Array of \p num status codes. Each entry is
+ *                              set to the value \ref psa_call would have
+ *                              returned for the corresponding request.
+ *
+ * \retval PSA_SUCCESS          All requests have been processed.
+ * \retval "Does not return"    One of the requests is invalid, see
+ *                              \ref psa_call.
+ *
+ * \note Only available in the NSPE of an IPC model build. On multi-core
+ *       platforms the requests are sent one by one through the mailbox.
+ */
+psa_status_t tfm_psa_call_batch(const struct tfm_psa_call_batch_req_t *reqs,
+                                size_t num,
+                                psa_status_t *status);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_CRYPTO_NS_CONN_H__
+#define __TFM_CRYPTO_NS_CONN_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "psa/crypto.h"
+
+/**
+ * \brief Initialises the cache of connections to the TF-M Crypto service
+ *        kept by the NS client API when TFM_CRYPTO_NS_CONN_REUSE is enabled
+ *
+ * \details This function must be called once from the NS world, after the
+ *          RTOS kernel has been initialised and before any thread issues a
+ *          PSA Crypto request. If it is not called, each request sets up and
+ *          closes its own connection.
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_ns_conn_init(void);
+
+/**
+ * \brief Releases the connection to the TF-M Crypto service cached for the
+ *        calling thread, if any
+ *
+ * \details This is the thread exit hook of the connection cache: it closes
+ *          the cached connection and frees the cache entry. It must be called
+ *          by a thread which has issued PSA Crypto requests before it exits,
+ *          which os_wrapper_thread_exit() does. A thread which exits in any
+ *          other way keeps its entry, and a new thread given the same thread
+ *          handle by the RTOS would then use a connection of another client.
+ *          The next request from the calling thread sets up a new connection.
+ */
+void tfm_crypto_ns_conn_release(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_CRYPTO_NS_CONN_H__ */
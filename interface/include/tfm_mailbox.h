@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -25,10 +25,16 @@ extern "C" {
 
 /*
  * The number of slots in NSPE mailbox queue and SPE mailbox queue.
- * So far only one slot is supported in either NSPE mailbox queue or
- * SPE mailbox queue.
+ * Each slot holds one outstanding PSA client call. NSPE and SPE mailbox must
+ * be built with the same value.
  */
-#define NUM_MAILBOX_QUEUE_SLOT              (1)
+#ifndef NUM_MAILBOX_QUEUE_SLOT
+#define NUM_MAILBOX_QUEUE_SLOT              (4)
+#endif
+
+#if (NUM_MAILBOX_QUEUE_SLOT < 1) || (NUM_MAILBOX_QUEUE_SLOT > 32)
+#error "NUM_MAILBOX_QUEUE_SLOT must be between 1 and 32"
+#endif
 
 /* PSA client call type value */
 #define MAILBOX_PSA_FRAMEWORK_VERSION       (0x1)
@@ -46,6 +52,7 @@ extern "C" {
 #define MAILBOX_CHAN_BUSY                   (INT32_MIN + 5)
 #define MAILBOX_CALLBACK_REG_ERROR          (INT32_MIN + 6)
 #define MAILBOX_INIT_ERROR                  (INT32_MIN + 7)
+#define MAILBOX_GENERIC_ERROR               (INT32_MIN + 8)
 
 /*
  * This structure holds the parameters used in a PSA client call.
@@ -116,6 +123,35 @@ struct ns_mailbox_slot_t {
 
 typedef uint32_t   mailbox_queue_status_t;
 
+/* Bitmask of a single slot, and of all the slots, in a mailbox queue */
+#define MAILBOX_QUEUE_SLOT_MASK(idx)     ((mailbox_queue_status_t)1 << (idx))
+#define MAILBOX_QUEUE_ALL_SLOTS_MASK                                   \
+    ((mailbox_queue_status_t)(((uint64_t)1 << NUM_MAILBOX_QUEUE_SLOT) - 1))
+
+#ifdef TFM_MAILBOX_RING
+/*
+ * Number of entries in a mailbox ring. One entry is always left unused to tell
+ * a full ring from an empty one. An NSPE mailbox queue slot is in at most one
+ * ring at a time, so a ring never overflows.
+ */
+#define MAILBOX_RING_SIZE                (NUM_MAILBOX_QUEUE_SLOT + 1)
+
+/*
+ * Single-producer single-consumer ring of NSPE mailbox queue slot indexes.
+ * Each index is only written by one side, so that the two cores can use the
+ * ring without a lock.
+ */
+struct mailbox_ring_t {
+    volatile uint32_t head;                     /* Next entry to be written.
+                                                 * Only written by producer
+                                                 */
+    volatile uint32_t tail;                     /* Next entry to be read.
+                                                 * Only written by consumer
+                                                 */
+    volatile uint8_t  entries[MAILBOX_RING_SIZE];
+};
+#endif /* TFM_MAILBOX_RING */
+
 /* NSPE mailbox queue */
 struct ns_mailbox_queue_t {
     mailbox_queue_status_t   empty_slots;       /* Bitmask of empty slots */
@@ -126,6 +162,19 @@ struct ns_mailbox_queue_t {
                                                  * containing PSA client call
                                                  * return result
                                                  */
+#ifdef TFM_MAILBOX_RING
+    /*
+     * With the ring transport, the slot bitmasks above are only accessed by
+     * NSPE and pend_slots is unused. Requests and replies are passed through
+     * the rings below instead.
+     */
+    struct mailbox_ring_t    req_ring;          /* Slots with a request.
+                                                 * NSPE to SPE
+                                                 */
+    struct mailbox_ring_t    reply_ring;        /* Slots with a reply.
+                                                 * SPE to NSPE
+                                                 */
+#endif
 
     struct ns_mailbox_slot_t queue[NUM_MAILBOX_QUEUE_SLOT];
 };
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -39,6 +39,8 @@ int32_t tfm_platform_ns_wait_for_s_cpu_ready(void);
 /**
  * \brief Acquire the multi-core lock for synchronizing PSA client call(s)
  *        The actual implementation depends on the use scenario.
+ *        The default implementation reserves one of the NUM_MAILBOX_QUEUE_SLOT
+ *        mailbox queue slots, so that several calls can be in flight at once.
  *
  * \return \ref OS_WRAPPER_SUCCESS on success
  * \return \ref OS_WRAPPER_ERROR on error
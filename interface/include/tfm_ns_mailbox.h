@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -56,6 +56,57 @@ int32_t tfm_ns_mailbox_rx_client_reply(mailbox_msg_handle_t handle,
  */
 bool tfm_ns_mailbox_is_msg_replied(mailbox_msg_handle_t handle);
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+/**
+ * \brief Put the current non-secure thread to sleep until a specific mailbox
+ *        message has been replied.
+ *
+ * \param[in] handle            The handle to the mailbox message
+ *
+ * \retval MAILBOX_SUCCESS      The PSA client call return value is replied.
+ * \retval Other return code    Operation failed with an error code.
+ */
+int32_t tfm_ns_mailbox_wait_reply(mailbox_msg_handle_t handle);
+
+/**
+ * \brief Fetch the first replied mailbox message whose owner has not been woken
+ *        up yet. Each replied message is only returned once.
+ *        It can only be called in the IRQ handler of SPE notifications.
+ *
+ * \retval MAILBOX_MSG_NULL_HANDLE  No more mailbox message has been replied.
+ * \retval > 0                      The handle to the replied mailbox message.
+ */
+mailbox_msg_handle_t tfm_ns_mailbox_fetch_reply_msg_isr(void);
+
+/**
+ * \brief Get the owner of a mailbox message.
+ *
+ * \param[in] handle            The handle to the mailbox message
+ *
+ * \return The handle of the non-secure thread which sent the message, or NULL
+ *         if the handle is invalid.
+ */
+void *tfm_ns_mailbox_get_msg_owner(mailbox_msg_handle_t handle);
+
+/**
+ * \brief Get the handle of the current non-secure thread, which is set as the
+ *        owner of the mailbox messages it sends.
+ *
+ * \note The implementation depends on the NS OS.
+ *
+ * \return The handle of the current non-secure thread.
+ */
+void *tfm_ns_mailbox_get_task_handle(void);
+
+/**
+ * \brief Wake up the owner threads of all the newly replied mailbox messages.
+ *        It is called by the IRQ handler of SPE notifications.
+ *
+ * \note The implementation depends on the NS OS.
+ */
+void tfm_ns_mailbox_wake_reply_owner_isr(void);
+#endif /* TFM_MAILBOX_WAIT_IRQ */
+
 /**
  * \brief NSPE mailbox initialization
  *
@@ -103,6 +154,37 @@ void tfm_ns_mailbox_hal_enter_critical(void);
  */
 void tfm_ns_mailbox_hal_exit_critical(void);
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+/**
+ * \brief Put the current non-secure thread to sleep until it is woken up by
+ *        \ref tfm_ns_mailbox_wake_reply_owner_isr().
+ *        Invoked by \ref tfm_ns_mailbox_wait_reply().
+ *
+ * \note The implementation depends on platform specific hardware and the NS
+ *       OS. The thread may be woken up before its message is replied.
+ *
+ * \param[in] handle            The handle to the mailbox message
+ *
+ * \retval MAILBOX_SUCCESS      Operation succeeded.
+ * \retval Other return code    Operation failed with an error code.
+ */
+int32_t tfm_ns_mailbox_hal_wait_reply(mailbox_msg_handle_t handle);
+
+/**
+ * \brief Enter critical section of NSPE mailbox in an IRQ handler.
+ *
+ * \note The implementation depends on platform specific hardware and use case.
+ */
+void tfm_ns_mailbox_hal_enter_critical_isr(void);
+
+/**
+ * \brief Exit critical section of NSPE mailbox in an IRQ handler.
+ *
+ * \note The implementation depends on platform specific hardware and use case.
+ */
+void tfm_ns_mailbox_hal_exit_critical_isr(void);
+#endif /* TFM_MAILBOX_WAIT_IRQ */
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -14,6 +14,203 @@
 
 #define ARRAY_SIZE(arr) (sizeof(arr)/sizeof(arr[0]))
 
+#ifdef TFM_CRYPTO_NS_CONN_REUSE
+#include "os_wrapper/mutex.h"
+#include "os_wrapper/thread.h"
+#include "tfm_crypto_ns_conn.h"
+
+/**
+ * \brief Default number of NS threads which can keep a cached connection to
+ *        the TF-M Crypto service at the same time
+ */
+#ifndef TFM_CRYPTO_NS_CONN_NUM
+#define TFM_CRYPTO_NS_CONN_NUM (4)
+#endif
+
+/**
+ * \brief Connection to the TF-M Crypto service cached for an NS thread
+ */
+struct tfm_crypto_ns_conn_t {
+    void *thread;        /*!< Handle of the owner thread, NULL if free */
+    psa_handle_t handle; /*!< Cached connection handle */
+};
+
+static struct tfm_crypto_ns_conn_t ns_conn[TFM_CRYPTO_NS_CONN_NUM];
+
+/**
+ * \brief Lock protecting the connection table. While it is not initialised,
+ *        every request falls back to a connection per call.
+ */
+static void *ns_conn_lock = NULL;
+
+/**
+ * \brief Gets the connection to use for a request from the calling thread
+ *
+ * \details The cached connection of the calling thread is returned if there is
+ *          one. Otherwise a new connection is set up and, if a table entry is
+ *          available, cached for the following requests from the same thread.
+ *          When no entry is free, the connection is set up for the request
+ *          only. An entry is never handed over to another thread, as its
+ *          connection is bound to the client ID of its owner.
+ *
+ * \param[out] conn Table entry holding the connection, or NULL if the
+ *                  connection is not cached and has to be closed after the
+ *                  request
+ *
+ * \return Connection handle, or a negative value in case of error
+ */
+static psa_handle_t tfm_crypto_ns_conn_get(struct tfm_crypto_ns_conn_t **conn)
+{
+    void *thread;
+    struct tfm_crypto_ns_conn_t *free_conn = NULL;
+    psa_handle_t handle;
+    uint32_t i;
+
+    *conn = NULL;
+
+    thread = os_wrapper_thread_get_handle();
+    if ((thread == NULL) ||
+        (os_wrapper_mutex_acquire(ns_conn_lock, OS_WRAPPER_WAIT_FOREVER)
+                                                       != OS_WRAPPER_SUCCESS)) {
+        return psa_connect(TFM_CRYPTO_SID, TFM_CRYPTO_VERSION);
+    }
+
+    for (i = 0; i < TFM_CRYPTO_NS_CONN_NUM; i++) {
+        if (ns_conn[i].thread == thread) {
+            *conn = &ns_conn[i];
+            break;
+        }
+        if ((free_conn == NULL) && (ns_conn[i].thread == NULL)) {
+            free_conn = &ns_conn[i];
+        }
+    }
+
+    if ((*conn == NULL) && (free_conn != NULL)) {
+        /* Reserve the entry, the connection is set up outside of the lock */
+        free_conn->thread = thread;
+        free_conn->handle = PSA_NULL_HANDLE;
+        *conn = free_conn;
+    }
+
+    (void)os_wrapper_mutex_release(ns_conn_lock);
+
+    if (*conn == NULL) {
+        return psa_connect(TFM_CRYPTO_SID, TFM_CRYPTO_VERSION);
+    }
+
+    /* Entries are only modified by their owner thread once reserved */
+    if (!PSA_HANDLE_IS_VALID((*conn)->handle)) {
+        handle = psa_connect(TFM_CRYPTO_SID, TFM_CRYPTO_VERSION);
+        (*conn)->handle = PSA_HANDLE_IS_VALID(handle) ? handle :
+                                                        PSA_NULL_HANDLE;
+        return handle;
+    }
+
+    return (*conn)->handle;
+}
+
+/**
+ * \brief Releases a connection obtained with \ref tfm_crypto_ns_conn_get
+ *
+ * \param[in] conn   Table entry holding the connection, or NULL
+ * \param[in] handle Connection handle
+ */
+static void tfm_crypto_ns_conn_put(struct tfm_crypto_ns_conn_t *conn,
+                                   psa_handle_t handle)
+{
+    /* Cached connections are kept open for the next request */
+    if (conn == NULL) {
+        psa_close(handle);
+    }
+}
+
+/**
+ * \brief Sends a request on a connection obtained with
+ *        \ref tfm_crypto_ns_conn_get
+ *
+ * \details If the service terminates the cached connection while handling the
+ *          request, the connection is dropped and the next request from the
+ *          thread sets up a new one. The request itself is not sent again, as
+ *          it has already been processed by the service.
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+static psa_status_t tfm_crypto_ns_conn_call(struct tfm_crypto_ns_conn_t *conn,
+                                            psa_handle_t handle,
+                                            const psa_invec *in_vec,
+                                            size_t in_len,
+                                            psa_outvec *out_vec,
+                                            size_t out_len)
+{
+    psa_status_t status;
+
+    status = psa_call(handle, PSA_IPC_CALL, in_vec, in_len, out_vec, out_len);
+    if ((status == PSA_ERROR_PROGRAMMER_ERROR) && (conn != NULL)) {
+        psa_close(handle);
+        conn->handle = PSA_NULL_HANDLE;
+    }
+
+    return status;
+}
+
+psa_status_t tfm_crypto_ns_conn_init(void)
+{
+    void *handle;
+
+    handle = os_wrapper_mutex_create();
+    if (!handle) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    ns_conn_lock = handle;
+    return PSA_SUCCESS;
+}
+
+void tfm_crypto_ns_conn_release(void)
+{
+    void *thread;
+    psa_handle_t handle = PSA_NULL_HANDLE;
+    uint32_t i;
+
+    thread = os_wrapper_thread_get_handle();
+    if ((thread == NULL) ||
+        (os_wrapper_mutex_acquire(ns_conn_lock, OS_WRAPPER_WAIT_FOREVER)
+                                                       != OS_WRAPPER_SUCCESS)) {
+        return;
+    }
+
+    for (i = 0; i < TFM_CRYPTO_NS_CONN_NUM; i++) {
+        if (ns_conn[i].thread == thread) {
+            handle = ns_conn[i].handle;
+            ns_conn[i].handle = PSA_NULL_HANDLE;
+            ns_conn[i].thread = NULL;
+            break;
+        }
+    }
+
+    (void)os_wrapper_mutex_release(ns_conn_lock);
+
+    if (PSA_HANDLE_IS_VALID(handle)) {
+        psa_close(handle);
+    }
+}
+
+#define PSA_CONNECT(service)                                    \
+    psa_handle_t ipc_handle;                                    \
+    struct tfm_crypto_ns_conn_t *ipc_conn;                      \
+    ipc_handle = tfm_crypto_ns_conn_get(&ipc_conn);             \
+    if (!PSA_HANDLE_IS_VALID(ipc_handle)) {                     \
+        return PSA_ERROR_GENERIC_ERROR;                         \
+    }                                                           \
+
+#define PSA_CLOSE() tfm_crypto_ns_conn_put(ipc_conn, ipc_handle)
+
+#define PSA_CALL(in_vec, in_len, out_vec, out_len)              \
+    tfm_crypto_ns_conn_call(ipc_conn, ipc_handle,               \
+        in_vec, in_len, out_vec, out_len)
+
+#else /* TFM_CRYPTO_NS_CONN_REUSE */
+
 #define PSA_CONNECT(service)                                    \
     psa_handle_t ipc_handle;                                    \
     ipc_handle = psa_connect(service##_SID, service##_VERSION); \
@@ -23,14 +220,18 @@
 
 #define PSA_CLOSE() psa_close(ipc_handle)
 
-#define API_DISPATCH(sfn_name, sfn_id)                          \
+#define PSA_CALL(in_vec, in_len, out_vec, out_len)              \
     psa_call(ipc_handle, PSA_IPC_CALL,                          \
-        in_vec, ARRAY_SIZE(in_vec),                             \
+        in_vec, in_len, out_vec, out_len)
+
+#endif /* TFM_CRYPTO_NS_CONN_REUSE */
+
+#define API_DISPATCH(sfn_name, sfn_id)                          \
+    PSA_CALL(in_vec, ARRAY_SIZE(in_vec),                        \
         out_vec, ARRAY_SIZE(out_vec))
 
 #define API_DISPATCH_NO_OUTVEC(sfn_name, sfn_id)                \
-    psa_call(ipc_handle, PSA_IPC_CALL,                          \
-        in_vec, ARRAY_SIZE(in_vec),                             \
+    PSA_CALL(in_vec, ARRAY_SIZE(in_vec),                        \
         (psa_outvec *)NULL, 0)
 
 psa_status_t psa_crypto_init(void)
@@ -1101,8 +1302,7 @@ psa_status_t psa_aead_encrypt(psa_key_handle_t handle,
     if (additional_data == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
-                      out_vec, ARRAY_SIZE(out_vec));
+    status = PSA_CALL(in_vec, in_len, out_vec, ARRAY_SIZE(out_vec));
 
     *ciphertext_length = out_vec[0].len;
 
@@ -1166,8 +1366,7 @@ psa_status_t psa_aead_decrypt(psa_key_handle_t handle,
     if (additional_data == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
-                      out_vec, ARRAY_SIZE(out_vec));
+    status = PSA_CALL(in_vec, in_len, out_vec, ARRAY_SIZE(out_vec));
 
     *plaintext_length = out_vec[0].len;
 
@@ -1291,8 +1490,7 @@ psa_status_t psa_asymmetric_encrypt(psa_key_handle_t handle,
     if (salt == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
-                      out_vec, ARRAY_SIZE(out_vec));
+    status = PSA_CALL(in_vec, in_len, out_vec, ARRAY_SIZE(out_vec));
 
     *output_length = out_vec[0].len;
 
@@ -1343,8 +1541,7 @@ psa_status_t psa_asymmetric_decrypt(psa_key_handle_t handle,
     if (salt == NULL) {
         in_len--;
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
-                      out_vec, ARRAY_SIZE(out_vec));
+    status = PSA_CALL(in_vec, in_len, out_vec, ARRAY_SIZE(out_vec));
 
     *output_length = out_vec[0].len;
 
@@ -1528,8 +1725,7 @@ psa_status_t psa_key_derivation(psa_crypto_generator_t *generator,
             in_len--;
         }
     }
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len,
-                      out_vec, ARRAY_SIZE(out_vec));
+    status = PSA_CALL(in_vec, in_len, out_vec, ARRAY_SIZE(out_vec));
 
     PSA_CLOSE();
 
@@ -1642,7 +1838,7 @@ psa_status_t psa_generate_key(psa_key_handle_t handle,
         in_len--;
     }
 
-    status = psa_call(ipc_handle, PSA_IPC_CALL, in_vec, in_len, NULL, 0);
+    status = PSA_CALL(in_vec, in_len, NULL, 0);
 
     PSA_CLOSE();
 
@@ -1,21 +1,37 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
 
-#include "os_wrapper/mutex.h"
+#include "os_wrapper/semaphore.h"
+#ifdef TFM_MAILBOX_WAIT_IRQ
+#include "os_wrapper/thread.h"
+#endif
 
 #include "tfm_api.h"
+#include "tfm_mailbox.h"
 #include "tfm_multi_core_api.h"
+#ifdef TFM_MAILBOX_WAIT_IRQ
+#include "tfm_ns_mailbox.h"
 
+/* Thread flag set to wake up a thread whose mailbox message is replied */
+#define MAILBOX_REPLY_THREAD_FLAG       (1UL << 30)
+#endif
+
+/*
+ * Counts the free mailbox queue slots, so that up to NUM_MAILBOX_QUEUE_SLOT
+ * PSA client calls can be in flight at once.
+ */
 static void *ns_lock_handle = NULL;
 
 __attribute__((weak))
 enum tfm_status_e tfm_ns_interface_init(void)
 {
-    ns_lock_handle = os_wrapper_mutex_create();
+    ns_lock_handle = os_wrapper_semaphore_create(NUM_MAILBOX_QUEUE_SLOT,
+                                                 NUM_MAILBOX_QUEUE_SLOT,
+                                                 NULL);
     if (!ns_lock_handle) {
         return TFM_ERROR_GENERIC;
     }
@@ -30,10 +46,51 @@ int32_t tfm_ns_wait_for_s_cpu_ready(void)
 
 uint32_t tfm_ns_multi_core_lock_acquire(void)
 {
-    return os_wrapper_mutex_acquire(ns_lock_handle, OS_WRAPPER_WAIT_FOREVER);
+    return os_wrapper_semaphore_acquire(ns_lock_handle,
+                                        OS_WRAPPER_WAIT_FOREVER);
 }
 
 uint32_t tfm_ns_multi_core_lock_release(void)
 {
-    return os_wrapper_mutex_release(ns_lock_handle);
+    return os_wrapper_semaphore_release(ns_lock_handle);
+}
+
+#ifdef TFM_MAILBOX_WAIT_IRQ
+void *tfm_ns_mailbox_get_task_handle(void)
+{
+    return os_wrapper_thread_get_handle();
+}
+
+__attribute__((weak))
+int32_t tfm_ns_mailbox_hal_wait_reply(mailbox_msg_handle_t handle)
+{
+    (void)handle;
+
+    /*
+     * A thread has a single PSA client call in flight, so a single flag is
+     * enough. It is cleared when the thread returns from the wait.
+     */
+    if (os_wrapper_thread_wait_flag(MAILBOX_REPLY_THREAD_FLAG,
+                                    OS_WRAPPER_WAIT_FOREVER) ==
+        OS_WRAPPER_ERROR) {
+        return MAILBOX_GENERIC_ERROR;
+    }
+
+    return MAILBOX_SUCCESS;
+}
+
+void tfm_ns_mailbox_wake_reply_owner_isr(void)
+{
+    mailbox_msg_handle_t handle;
+    void *owner;
+
+    /* Several messages may have been replied with a single notification */
+    while ((handle = tfm_ns_mailbox_fetch_reply_msg_isr()) !=
+           MAILBOX_MSG_NULL_HANDLE) {
+        owner = tfm_ns_mailbox_get_msg_owner(handle);
+        if (owner) {
+            os_wrapper_thread_set_flag_isr(owner, MAILBOX_REPLY_THREAD_FLAG);
+        }
+    }
 }
+#endif /* TFM_MAILBOX_WAIT_IRQ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -40,6 +40,14 @@
 
 static void mailbox_wait_reply(mailbox_msg_handle_t handle)
 {
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    /* Sleep until the reply interrupt wakes this thread up */
+    if (tfm_ns_mailbox_wait_reply(handle) == MAILBOX_SUCCESS) {
+        return;
+    }
+
+    /* Fall back to polling if the thread cannot sleep */
+#endif
     while (!tfm_ns_mailbox_is_msg_replied(handle)) {
     }
 }
@@ -213,3 +221,19 @@ void psa_close(psa_handle_t handle)
 
     tfm_ns_multi_core_lock_release();
 }
+
+psa_status_t tfm_psa_call_batch(const struct tfm_psa_call_batch_req_t *reqs,
+                                size_t num,
+                                psa_status_t *status)
+{
+    size_t i;
+
+    /* Each request is a separate mailbox message on multi-core platforms */
+    for (i = 0; i < num; i++) {
+        status[i] = psa_call(reqs[i].handle, reqs[i].type,
+                             reqs[i].in_vec, reqs[i].in_len,
+                             reqs[i].out_vec, reqs[i].out_len);
+    }
+
+    return PSA_SUCCESS;
+}
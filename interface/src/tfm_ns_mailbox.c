@@ -1,34 +1,172 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
 
 #include <string.h>
+#ifdef TFM_MAILBOX_RING
+#include "cmsis_compiler.h"
+#endif
 #include "tfm_ns_mailbox.h"
 
 /* The pointer to NSPE mailbox queue */
 static struct ns_mailbox_queue_t *mailbox_queue_ptr = NULL;
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+/*
+ * Bitmask of replied slots whose owner has already been woken up. Only used by
+ * NSPE, to fetch each replied message only once in the IRQ handler.
+ */
+static mailbox_queue_status_t woken_slots;
+#endif
+
+#ifdef TFM_MAILBOX_RING
+/* Interrupt mask state saved by mailbox_enter_critical() */
+static uint32_t mailbox_primask;
+
+/*
+ * With the ring transport, SPE never accesses the slot bitmasks and only
+ * accesses its own side of the rings. The NSPE mailbox queue is therefore only
+ * protected against the other non-secure threads and interrupt handlers, by
+ * masking the interrupts on the non-secure core.
+ */
+static inline void mailbox_enter_critical(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    mailbox_primask = primask;
+}
+
+static inline void mailbox_exit_critical(void)
+{
+    __set_PRIMASK(mailbox_primask);
+}
+
+#ifdef TFM_MAILBOX_WAIT_IRQ
+/* Interrupt mask state saved by mailbox_enter_critical_isr() */
+static uint32_t mailbox_primask_isr;
+
+static inline void mailbox_enter_critical_isr(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    mailbox_primask_isr = primask;
+}
+
+static inline void mailbox_exit_critical_isr(void)
+{
+    __set_PRIMASK(mailbox_primask_isr);
+}
+#endif
+
+static inline uint32_t mailbox_ring_next(uint32_t pos)
+{
+    return (pos + 1) % MAILBOX_RING_SIZE;
+}
+
+/*
+ * Puts a slot into the request ring. It must be called in critical section, as
+ * NSPE is the single producer of the request ring.
+ * Returns true if SPE had already consumed all the previous requests, in which
+ * case SPE must be notified of the new request.
+ */
+static bool mailbox_push_req(uint8_t idx)
+{
+    struct mailbox_ring_t *ring = &mailbox_queue_ptr->req_ring;
+    uint32_t head = ring->head;
+
+    ring->entries[head] = idx;
+
+    /* Make the entry visible to SPE before the head which covers it */
+    __DMB();
+    ring->head = mailbox_ring_next(head);
+
+    /* Publish the head before checking whether SPE is still consuming */
+    __DMB();
+
+    return ring->tail == head;
+}
+
+/*
+ * Moves all the slots from the reply ring to the replied slots bitmask. It
+ * must be called in critical section, as NSPE is the single consumer of the
+ * reply ring.
+ */
+static void mailbox_collect_replies(void)
+{
+    struct mailbox_ring_t *ring = &mailbox_queue_ptr->reply_ring;
+    uint32_t tail = ring->tail;
+    uint8_t idx;
+
+    while (tail != ring->head) {
+        while (tail != ring->head) {
+            /* Read the entry only after the head which covers it */
+            __DMB();
+            idx = ring->entries[tail];
+            if (idx < NUM_MAILBOX_QUEUE_SLOT) {
+                mailbox_queue_ptr->replied_slots |=
+                                                MAILBOX_QUEUE_SLOT_MASK(idx);
+            }
+            tail = mailbox_ring_next(tail);
+        }
+
+        /* Finish reading the entries before releasing them to SPE */
+        __DMB();
+        ring->tail = tail;
+
+        /*
+         * Publish the tail before checking the head again, so that a reply
+         * added meanwhile is either collected here or notified by SPE.
+         */
+        __DMB();
+    }
+}
+#else /* TFM_MAILBOX_RING */
+static inline void mailbox_enter_critical(void)
+{
+    tfm_ns_mailbox_hal_enter_critical();
+}
+
+static inline void mailbox_exit_critical(void)
+{
+    tfm_ns_mailbox_hal_exit_critical();
+}
+
+#ifdef TFM_MAILBOX_WAIT_IRQ
+static inline void mailbox_enter_critical_isr(void)
+{
+    tfm_ns_mailbox_hal_enter_critical_isr();
+}
+
+static inline void mailbox_exit_critical_isr(void)
+{
+    tfm_ns_mailbox_hal_exit_critical_isr();
+}
+#endif
+#endif /* TFM_MAILBOX_RING */
+
 static inline void clear_queue_slot_empty(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->empty_slots &= ~(1 << idx);
+        mailbox_queue_ptr->empty_slots &= ~MAILBOX_QUEUE_SLOT_MASK(idx);
     }
 }
 
 static inline void set_queue_slot_empty(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->empty_slots |= (1 << idx);
+        mailbox_queue_ptr->empty_slots |= MAILBOX_QUEUE_SLOT_MASK(idx);
     }
 }
 
 static inline void set_queue_slot_pend(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->pend_slots |= (1 << idx);
+        mailbox_queue_ptr->pend_slots |= MAILBOX_QUEUE_SLOT_MASK(idx);
     }
 }
 
@@ -47,7 +185,8 @@ static inline int32_t get_mailbox_msg_handle(uint8_t idx,
 static inline int32_t get_mailbox_msg_idx(mailbox_msg_handle_t handle,
                                           uint8_t *idx)
 {
-    if ((handle == MAILBOX_MSG_NULL_HANDLE) || !idx) {
+    if ((handle <= MAILBOX_MSG_NULL_HANDLE) ||
+        (handle > NUM_MAILBOX_QUEUE_SLOT) || !idx) {
         return MAILBOX_INVAL_PARAMS;
     }
 
@@ -59,33 +198,42 @@ static inline int32_t get_mailbox_msg_idx(mailbox_msg_handle_t handle,
 static inline void clear_queue_slot_replied(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        mailbox_queue_ptr->replied_slots &= ~(1 << idx);
+        mailbox_queue_ptr->replied_slots &= ~MAILBOX_QUEUE_SLOT_MASK(idx);
     }
 }
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+static inline void clear_queue_slot_woken(uint8_t idx)
+{
+    if (idx < NUM_MAILBOX_QUEUE_SLOT) {
+        woken_slots &= ~MAILBOX_QUEUE_SLOT_MASK(idx);
+    }
+}
+#endif
+
 static uint8_t acquire_empty_slot(const struct ns_mailbox_queue_t *queue)
 {
     uint8_t idx;
     mailbox_queue_status_t status;
 
-    tfm_ns_mailbox_hal_enter_critical();
+    mailbox_enter_critical();
     status = queue->empty_slots;
 
     if (!status) {
         /* No empty slot */
-        tfm_ns_mailbox_hal_exit_critical();
+        mailbox_exit_critical();
         return NUM_MAILBOX_QUEUE_SLOT;
     }
 
     for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
-        if (status & (1 << idx)) {
+        if (status & MAILBOX_QUEUE_SLOT_MASK(idx)) {
             break;
         }
     }
 
     clear_queue_slot_empty(idx);
 
-    tfm_ns_mailbox_hal_exit_critical();
+    mailbox_exit_critical();
 
     return idx;
 }
@@ -97,6 +245,9 @@ mailbox_msg_handle_t tfm_ns_mailbox_tx_client_req(uint32_t call_type,
     uint8_t idx;
     struct mailbox_msg_t *msg_ptr;
     mailbox_msg_handle_t handle;
+#ifdef TFM_MAILBOX_RING
+    bool notify;
+#endif
 
     if (!mailbox_queue_ptr) {
         return MAILBOX_MSG_NULL_HANDLE;
@@ -118,13 +269,29 @@ mailbox_msg_handle_t tfm_ns_mailbox_tx_client_req(uint32_t call_type,
     memcpy(&msg_ptr->params, params, sizeof(msg_ptr->params));
     msg_ptr->client_id = client_id;
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    /* Set the owner before SPE can reply, to know which thread to wake up */
+    mailbox_queue_ptr->queue[idx].owner = tfm_ns_mailbox_get_task_handle();
+#endif
+
     get_mailbox_msg_handle(idx, &handle);
 
-    tfm_ns_mailbox_hal_enter_critical();
+#ifdef TFM_MAILBOX_RING
+    mailbox_enter_critical();
+    notify = mailbox_push_req(idx);
+    mailbox_exit_critical();
+
+    /* SPE keeps consuming the request ring until it is empty */
+    if (notify) {
+        tfm_ns_mailbox_hal_notify_peer();
+    }
+#else
+    mailbox_enter_critical();
     set_queue_slot_pend(idx);
-    tfm_ns_mailbox_hal_exit_critical();
+    mailbox_exit_critical();
 
     tfm_ns_mailbox_hal_notify_peer();
+#endif
 
     return handle;
 }
@@ -150,10 +317,13 @@ int32_t tfm_ns_mailbox_rx_client_reply(mailbox_msg_handle_t handle,
 
     *reply = mailbox_queue_ptr->queue[idx].reply.return_val;
 
-    tfm_ns_mailbox_hal_enter_critical();
+    mailbox_enter_critical();
     set_queue_slot_empty(idx);
     clear_queue_slot_replied(idx);
-    tfm_ns_mailbox_hal_exit_critical();
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    clear_queue_slot_woken(idx);
+#endif
+    mailbox_exit_critical();
 
     return MAILBOX_SUCCESS;
 }
@@ -177,17 +347,93 @@ bool tfm_ns_mailbox_is_msg_replied(mailbox_msg_handle_t handle)
         return false;
     }
 
-    tfm_ns_mailbox_hal_enter_critical();
+    mailbox_enter_critical();
+#ifdef TFM_MAILBOX_RING
+    mailbox_collect_replies();
+#endif
     status = mailbox_queue_ptr->replied_slots;
-    tfm_ns_mailbox_hal_exit_critical();
+    mailbox_exit_critical();
 
-    if (status & (1 << idx)) {
+    if (status & MAILBOX_QUEUE_SLOT_MASK(idx)) {
         return true;
     }
 
     return false;
 }
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+int32_t tfm_ns_mailbox_wait_reply(mailbox_msg_handle_t handle)
+{
+    uint8_t idx;
+    int32_t ret;
+
+    if (!mailbox_queue_ptr) {
+        return MAILBOX_INVAL_PARAMS;
+    }
+
+    ret = get_mailbox_msg_idx(handle, &idx);
+    if (ret != MAILBOX_SUCCESS) {
+        return ret;
+    }
+
+    /*
+     * The thread can be woken up by a notification of a message which it has
+     * already seen replied, so check the reply status again every time.
+     */
+    while (!tfm_ns_mailbox_is_msg_replied(handle)) {
+        ret = tfm_ns_mailbox_hal_wait_reply(handle);
+        if (ret != MAILBOX_SUCCESS) {
+            return ret;
+        }
+    }
+
+    return MAILBOX_SUCCESS;
+}
+
+mailbox_msg_handle_t tfm_ns_mailbox_fetch_reply_msg_isr(void)
+{
+    uint8_t idx;
+    mailbox_msg_handle_t handle = MAILBOX_MSG_NULL_HANDLE;
+    mailbox_queue_status_t status;
+
+    if (!mailbox_queue_ptr) {
+        return MAILBOX_MSG_NULL_HANDLE;
+    }
+
+    mailbox_enter_critical_isr();
+#ifdef TFM_MAILBOX_RING
+    mailbox_collect_replies();
+#endif
+    status = mailbox_queue_ptr->replied_slots & ~woken_slots;
+
+    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
+        if (status & MAILBOX_QUEUE_SLOT_MASK(idx)) {
+            woken_slots |= MAILBOX_QUEUE_SLOT_MASK(idx);
+            get_mailbox_msg_handle(idx, &handle);
+            break;
+        }
+    }
+    mailbox_exit_critical_isr();
+
+    return handle;
+}
+
+void *tfm_ns_mailbox_get_msg_owner(mailbox_msg_handle_t handle)
+{
+    uint8_t idx;
+
+    if (!mailbox_queue_ptr) {
+        return NULL;
+    }
+
+    if (get_mailbox_msg_idx(handle, &idx) != MAILBOX_SUCCESS) {
+        return NULL;
+    }
+
+    return mailbox_queue_ptr->queue[idx].owner;
+}
+#endif /* TFM_MAILBOX_WAIT_IRQ */
+
 int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
 {
     int32_t ret;
@@ -204,8 +450,10 @@ int32_t tfm_ns_mailbox_init(struct ns_mailbox_queue_t *queue)
     memset(queue, 0, sizeof(*queue));
 
     /* Initialize empty bitmask */
-    queue->empty_slots = (mailbox_queue_status_t)((1 << NUM_MAILBOX_QUEUE_SLOT)
-                                                  - 1);
+    queue->empty_slots = MAILBOX_QUEUE_ALL_SLOTS_MASK;
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    woken_slots = 0;
+#endif
 
     mailbox_queue_ptr = queue;
 
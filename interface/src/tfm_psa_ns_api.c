@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -77,3 +77,15 @@ void psa_close(psa_handle_t handle)
                          0,
                          0);
 }
+
+psa_status_t tfm_psa_call_batch(const struct tfm_psa_call_batch_req_t *reqs,
+                                size_t num,
+                                psa_status_t *status)
+{
+    return tfm_ns_interface_dispatch(
+                                (veneer_fn)tfm_psa_call_batch_veneer,
+                                (uint32_t)reqs,
+                                (uint32_t)num,
+                                (uint32_t)status,
+                                0);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019 Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020 Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  */
@@ -16,4 +16,7 @@
 #define IPC_TX_CHAN                            IPC_PSA_CLIENT_CALL_CHAN
 #define IPC_TX_NOTIFY_MASK                     IPC_PSA_CLIENT_CALL_NOTIFY_MASK
 
+#define PSA_CLIENT_REPLY_NVIC_IRQn             IPC_PSA_CLIENT_REPLY_IPC_INTR
+#define PSA_CLIENT_REPLY_IRQ_PRIORITY          3
+
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  * Copyright (c) 2019, Cypress Semiconductor Corporation. All rights reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
@@ -22,12 +22,14 @@
 #define IPC_PSA_CLIENT_REPLY_INTR_STRUCT (5)
 #define IPC_PSA_CLIENT_REPLY_INTR_MASK   (1 << IPC_PSA_CLIENT_REPLY_CHAN)
 #define IPC_PSA_CLIENT_REPLY_NOTIFY_MASK (1 << IPC_PSA_CLIENT_REPLY_INTR_STRUCT)
+#define IPC_PSA_CLIENT_REPLY_IPC_INTR    cpuss_interrupts_ipc_5_IRQn
 
 #define IPC_RX_RELEASE_MASK              (0)
 
 #define CY_IPC_NOTIFY_SHIFT              (16)
 
 #define PSA_CLIENT_CALL_REQ_MAGIC        (0xA5CF50C6)
+#define PSA_CLIENT_CALL_REPLY_MAGIC      (0xC605FCA5)
 
 #define NS_MAILBOX_INIT_ENABLE           (0xAE)
 #define S_MAILBOX_READY                  (0xC3)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  * Copyright (c) 2019, Cypress Semiconductor Corporation. All rights reserved
  *
  * SPDX-License-Identifier: BSD-3-Clause
@@ -14,6 +14,7 @@
 #include "cy_ipc_drv.h"
 #include "cy_sysint.h"
 #include "cy_ipc_sema.h"
+#include "cy_syslib.h"
 
 #include "ns_ipc_config.h"
 #include "tfm_ns_mailbox.h"
@@ -21,12 +22,61 @@
 
 /* -------------------------------------- HAL API ------------------------------------ */
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+/* Interrupt state saved by the outermost tfm_ns_mailbox_hal_enter_critical() */
+static uint32_t mailbox_irq_state;
+/* Nesting depth of tfm_ns_mailbox_hal_enter_critical() */
+static uint32_t mailbox_critical_nest;
+#endif
+
 static void mailbox_ipc_init(void)
 {
     Cy_IPC_Drv_SetInterruptMask(Cy_IPC_Drv_GetIntrBaseAddr(IPC_RX_INTR_STRUCT),
                                 0, IPC_RX_INT_MASK);
 }
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+static void mailbox_ipc_config(void)
+{
+    NVIC_SetPriority(PSA_CLIENT_REPLY_NVIC_IRQn, PSA_CLIENT_REPLY_IRQ_PRIORITY);
+
+    NVIC_ClearPendingIRQ(PSA_CLIENT_REPLY_NVIC_IRQn);
+
+    NVIC_EnableIRQ(PSA_CLIENT_REPLY_NVIC_IRQn);
+}
+
+static void mailbox_clear_intr(void)
+{
+    uint32_t status;
+
+    status = Cy_IPC_Drv_GetInterruptStatusMasked(
+                            Cy_IPC_Drv_GetIntrBaseAddr(IPC_RX_INTR_STRUCT));
+    status >>= CY_IPC_NOTIFY_SHIFT;
+    if ((status & IPC_RX_INT_MASK) == 0) {
+        return;
+    }
+
+    Cy_IPC_Drv_ClearInterrupt(Cy_IPC_Drv_GetIntrBaseAddr(IPC_RX_INTR_STRUCT),
+                              0, IPC_RX_INT_MASK);
+}
+
+void cpuss_interrupts_ipc_5_IRQHandler(void)
+{
+    uint32_t magic;
+
+    mailbox_clear_intr();
+
+    /* Fetching the notification releases the channel */
+    (void)platform_mailbox_fetch_msg_data(&magic);
+
+    /*
+     * Always scan the replies after the channel is released. SPE fails to
+     * notify a reply while the channel is locked, and relies on this scan.
+     */
+    tfm_ns_mailbox_wake_reply_owner_isr();
+}
+#endif
+
 int32_t tfm_ns_mailbox_hal_notify_peer(void)
 {
     cy_en_ipcdrv_status_t status;
@@ -103,19 +153,67 @@ int32_t tfm_ns_mailbox_hal_init(struct ns_mailbox_queue_t *queue)
         }
     }
 
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    /* Replies are notified by interrupt from now on */
+    mailbox_ipc_config();
+#endif
+
     return MAILBOX_SUCCESS;
 }
 
 void tfm_ns_mailbox_hal_enter_critical(void)
 {
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    uint32_t irq_state;
+
+    /*
+     * Mask the reply interrupt as well, otherwise its handler would spin on
+     * the semaphore held by the interrupted thread.
+     */
+    irq_state = Cy_SysLib_EnterCriticalSection();
+
+    /* The semaphore is already held by an outer critical section */
+    if (mailbox_critical_nest++ != 0) {
+        return;
+    }
+    mailbox_irq_state = irq_state;
+#endif
+
     while (Cy_IPC_Sema_Set(MAILBOX_SEMAPHORE_NUM, false) !=
            CY_IPC_SEMA_SUCCESS) {
     }
 }
 
 void tfm_ns_mailbox_hal_exit_critical(void)
+{
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    /* Interrupts stay masked until the outermost critical section exits */
+    if (--mailbox_critical_nest != 0) {
+        return;
+    }
+#endif
+
+    while (Cy_IPC_Sema_Clear(MAILBOX_SEMAPHORE_NUM, false) !=
+           CY_IPC_SEMA_SUCCESS) {
+    }
+
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    Cy_SysLib_ExitCriticalSection(mailbox_irq_state);
+#endif
+}
+
+#ifdef TFM_MAILBOX_WAIT_IRQ
+void tfm_ns_mailbox_hal_enter_critical_isr(void)
+{
+    while (Cy_IPC_Sema_Set(MAILBOX_SEMAPHORE_NUM, false) !=
+           CY_IPC_SEMA_SUCCESS) {
+    }
+}
+
+void tfm_ns_mailbox_hal_exit_critical_isr(void)
 {
     while (Cy_IPC_Sema_Clear(MAILBOX_SEMAPHORE_NUM, false) !=
            CY_IPC_SEMA_SUCCESS) {
     }
 }
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  * Copyright (c) 2019, Cypress Semiconductor Corporation. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
@@ -23,6 +23,18 @@
 
 int32_t tfm_mailbox_hal_notify_peer(void)
 {
+#ifdef TFM_MAILBOX_WAIT_IRQ
+    /*
+     * The send fails if the channel is still locked by the previous
+     * notification. NSPE releases the channel before it scans the replies in
+     * its interrupt handler, so that scan collects this reply as well.
+     */
+    if (platform_mailbox_send_msg_data(PSA_CLIENT_CALL_REPLY_MAGIC) !=
+        PLATFORM_MAILBOX_SUCCESS) {
+        return MAILBOX_CHAN_BUSY;
+    }
+#endif
+
     return MAILBOX_SUCCESS;
 }
 
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#ifndef __TFM_PLAT_FLASH_COPY_H__
+#define __TFM_PLAT_FLASH_COPY_H__
+/**
+ * \file tfm_plat_flash_copy.h
+ *
+ * The storage services move data between flash blocks every time a block is
+ * updated. By default, the data is read into a RAM buffer and programmed back
+ * in chunks, through the CMSIS flash driver. A platform which can copy data
+ * from flash to flash more efficiently, for example with a DMA engine, can
+ * provide this interface and enable it with the ITS_FLASH_COPY_HAL and
+ * SST_FLASH_COPY_HAL build flags.
+ */
+
+/**
+ * \note The interfaces defined in this file are optional and only need to be
+ *       implemented by the SoCs which enable the flags above.
+ */
+
+#include <stdint.h>
+#include "Driver_Flash.h"
+#include "tfm_plat_defs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief Copies data between two regions of a flash device. The destination
+ *        region is erased. The function returns once the copy has completed.
+ *
+ * \param[in] dev       Pointer to the CMSIS driver of the flash device
+ * \param[in] dst_addr  Address of the destination region
+ * \param[in] src_addr  Address of the source region
+ * \param[in] size      Number of bytes to copy
+ *
+ * \return  TFM_PLAT_ERR_SUCCESS if the data has been copied.
+ *          TFM_PLAT_ERR_UNSUPPORTED if this copy cannot be done by the
+ *          platform, for example because of the alignment of the regions, in
+ *          which case the caller copies the data itself. Otherwise, it
+ *          returns TFM_PLAT_ERR_SYSTEM_ERR.
+ */
+enum tfm_plat_err_t tfm_plat_flash_copy(ARM_DRIVER_FLASH *dev,
+                                        uint32_t dst_addr,
+                                        uint32_t src_addr,
+                                        uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TFM_PLAT_FLASH_COPY_H__ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -11,6 +11,30 @@
 #include "tfm_wait.h"
 
 #define TFM_MSG_MAGIC               0x15154343
+
+#ifdef TFM_MSG_QUEUE_PRIORITY
+/*
+ * Number of priority classes of a message queue. Messages of a lower class
+ * are dequeued first. Messages of the same class are dequeued in FIFO order.
+ */
+#ifndef TFM_MSG_QUEUE_PRIOR_CLASSES
+#define TFM_MSG_QUEUE_PRIOR_CLASSES 4
+#endif
+
+#if (TFM_MSG_QUEUE_PRIOR_CLASSES < 1) || (TFM_MSG_QUEUE_PRIOR_CLASSES > 32)
+#error "TFM_MSG_QUEUE_PRIOR_CLASSES must be between 1 and 32"
+#endif
+
+/*
+ * Number of messages which can be dequeued before a waiting message, whatever
+ * its class. A message which has waited for so many dequeues is dequeued next,
+ * so that the messages of a low class are not starved by a flow of higher
+ * class messages.
+ */
+#ifndef TFM_MSG_QUEUE_AGING_LIMIT
+#define TFM_MSG_QUEUE_AGING_LIMIT   8
+#endif
+#endif
 /* Message struct to collect parameter from client */
 struct tfm_msg_body_t {
     int32_t magic;
@@ -24,17 +48,45 @@ struct tfm_msg_body_t {
                                      * Save caller outvec pointer for
                                      * write length update
                                      */
+    const void *caller_data;        /*
+                                     * Identify the NSPE PSA client call
+                                     * delivered via RPC, set by the
+                                     * mailbox implementation
+                                     */
+#ifdef TFM_MSG_QUEUE_PRIORITY
+    uint32_t prior_class;           /* Priority class in message queue  */
+    uint32_t enqueue_stamp;         /* Dequeue count of queue at enqueue */
+#endif
     struct tfm_msg_body_t *next;    /* List operators                   */
 };
 
+#ifdef TFM_MSG_QUEUE_PRIORITY
+/* FIFO of the messages of one priority class */
+struct tfm_msg_class_queue_t {
+    struct tfm_msg_body_t *head;    /* Queue head                       */
+    struct tfm_msg_body_t *tail;    /* Queue tail                       */
+};
+#endif
+
 struct tfm_msg_queue_t {
+#ifdef TFM_MSG_QUEUE_PRIORITY
+    struct tfm_msg_class_queue_t classes[TFM_MSG_QUEUE_PRIOR_CLASSES];
+    uint32_t class_bitmap;          /*
+                                     * Bitmap of the non-empty classes.
+                                     * Class 'n' is held in bit (31 - n)
+                                     */
+    uint32_t dequeue_count;         /* Number of messages dequeued      */
+#else
     struct tfm_msg_body_t *head;    /* Queue head                       */
     struct tfm_msg_body_t *tail;    /* Queue tail                       */
+#endif
     uint32_t size;                  /* Number of the queue member       */
 };
 
 /**
  * \brief Enqueue a message into message queue.
+ *        With TFM_MSG_QUEUE_PRIORITY, the message is appended to the FIFO of
+ *        its priority class.
  *
  * \param[in] queue             Message queue, it will be initialized
  *                              if has not been initialized.
@@ -48,6 +100,10 @@ int32_t tfm_msg_enqueue(struct tfm_msg_queue_t *queue,
 
 /**
  * \brief Dequeue a message from message queue.
+ *        With TFM_MSG_QUEUE_PRIORITY, the first message of the highest
+ *        priority class which is not empty is dequeued, unless the first
+ *        message of another class has waited for TFM_MSG_QUEUE_AGING_LIMIT
+ *        dequeues.
  *
  * \param[in] queue             Message queue.
  *
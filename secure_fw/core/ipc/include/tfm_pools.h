@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -18,6 +18,12 @@ extern "C" {
  * so pool is more applicable than heap.
  */
 
+/*
+ * Alignment of the chunk data, so that a chunk can hold any object type,
+ * including the ones with 64-bit fields.
+ */
+#define POOL_CHUNK_ALIGN                8
+
 /*
  * Pool Instance:
  *  [ Pool Instance ] + N * [ Pool Chunks ]
@@ -25,7 +31,8 @@ extern "C" {
 struct tfm_pool_chunk_t {
     struct tfm_list_node_t list;        /* Chunk list                     */
     void *pool;                         /* Point to the parent pool       */
-    uint8_t data[0];                    /* Data indicator                 */
+    uint8_t data[0]                     /* Data indicator                 */
+                __attribute__((aligned(POOL_CHUNK_ALIGN)));
 };
 
 struct tfm_pool_instance_t {
@@ -35,6 +42,11 @@ struct tfm_pool_instance_t {
     struct tfm_pool_chunk_t chunks[0];  /* Data indicator                 */
 };
 
+/* Get the size of a chunk, header included, padded to keep data aligned */
+#define POOL_CHUNK_SIZE(chunksz)                                            \
+    (sizeof(struct tfm_pool_chunk_t) +                                      \
+     (((chunksz) + POOL_CHUNK_ALIGN - 1) & ~(size_t)(POOL_CHUNK_ALIGN - 1)))
+
 /*
  * This will declares a static memory pool variable with chunk memory.
  * Parameters:
@@ -43,10 +55,9 @@ struct tfm_pool_instance_t {
  *  num         -   Number of chunks
  */
 #define TFM_POOL_DECLARE(name, chunksz, num)                                \
-    static uint8_t name##_pool_buf[((chunksz) +                             \
-                                   sizeof(struct tfm_pool_chunk_t)) * (num) \
+    static uint8_t name##_pool_buf[POOL_CHUNK_SIZE(chunksz) * (num)         \
                                    + sizeof(struct tfm_pool_instance_t)]    \
-                                   __attribute__((aligned(4)));            \
+                        __attribute__((aligned(POOL_CHUNK_ALIGN)));         \
     static struct tfm_pool_instance_t *name =                               \
                             (struct tfm_pool_instance_t *)name##_pool_buf
 
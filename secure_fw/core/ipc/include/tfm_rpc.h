@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -48,13 +48,17 @@ struct client_call_params_t {
  * the specific operations to complete the RPC functionalities.
  *
  * It includes the following operations:
- * handle_req() - Handle PSA client call request from NSPE
- * reply()      - Reply PSA client call return result to NSPE. The parameter
- *                owner identifies the owner of the PSA client call.
+ * handle_req()      - Handle PSA client call request from NSPE
+ * reply()           - Reply PSA client call return result to NSPE. The
+ *                     parameter owner identifies the owner of the PSA client
+ *                     call.
+ * get_caller_data() - Get the private data of the NSPE PSA client call being
+ *                     handled. It is passed back as owner in reply().
  */
 struct tfm_rpc_ops_t {
     void (*handle_req)(void);
     void (*reply)(const void *owner, int32_t ret);
+    const void * (*get_caller_data)(int32_t client_id);
 };
 
 /**
@@ -165,6 +169,16 @@ void tfm_rpc_client_call_handler(void);
  */
 void tfm_rpc_client_call_reply(const void *owner, int32_t ret);
 
+/**
+ * \brief Set the private data of the NSPE PSA client call into the message,
+ *        to identify the call when the message is replied.
+ *
+ * \param[in] msg               The message body context pointer
+ *                              \ref msg_body_t structures
+ * \param[in] client_id         The client ID of the NSPE PSA client call.
+ */
+void tfm_rpc_set_caller_data(struct tfm_msg_body_t *msg, int32_t client_id);
+
 /*
  * Check if the message was allocated for a non-secure request via RPC
  *
@@ -202,5 +216,7 @@ __STATIC_INLINE bool is_tfm_rpc_msg(const struct tfm_msg_body_t *msg)
 
 #define tfm_rpc_client_call_reply(owner, ret)   do {} while (0)
 
+#define tfm_rpc_set_caller_data(msg, client_id) do {} while (0)
+
 #endif /* TFM_MULTI_CORE_TOPOLOGY */
 #endif /* __TFM_RPC_H__ */
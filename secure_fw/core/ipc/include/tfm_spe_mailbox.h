@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -8,6 +8,7 @@
 #ifndef __TFM_SPE_MAILBOX_H__
 #define __TFM_SPE_MAILBOX_H__
 
+#include <stdbool.h>
 #include "tfm_mailbox.h"
 
 /* A single slot structure in SPE mailbox queue */
@@ -23,10 +24,30 @@ struct secure_mailbox_queue_t {
 
     struct secure_mailbox_slot_t queue[NUM_MAILBOX_QUEUE_SLOT];
     struct ns_mailbox_queue_t    *ns_queue;
+#ifdef TFM_MAILBOX_RING
+    /*
+     * SPE side positions of the rings in NSPE mailbox queue. They are kept in
+     * secure memory, so that a corrupted NSPE mailbox queue cannot move them.
+     */
+    uint32_t                     req_tail;         /* Next request to read */
+    uint32_t                     reply_head;       /* Next reply to write */
+#else
+    mailbox_queue_status_t       reply_slots;      /* NSPE slots replied but
+                                                    * not published yet
+                                                    */
+#endif
+    bool                         notify_pending;   /* NSPE is to be notified
+                                                    * of replies
+                                                    */
+    bool                         retry_pending;    /* A request waits for a
+                                                    * free SPE slot
+                                                    */
 };
 
 /**
  * \brief Handle mailbox message(s) from NSPE.
+ *        NSPE is only notified of the replies when the RPC handle_req()
+ *        callback completes.
  *
  * \retval MAILBOX_SUCCESS      Successfully get PSA client call return result.
  * \retval Other return code    Operation failed with an error code.
@@ -35,6 +56,8 @@ int32_t tfm_mailbox_handle_msg(void);
 
 /**
  * \brief Return PSA client call return result to NSPE.
+ *        NSPE is notified of all the replies returned meanwhile at once, when
+ *        the scheduler runs after the current exception.
  *
  * \param[in] handle            The handle to the mailbox message
  * \param[in] reply             PSA client call return result to be written
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -11,6 +11,7 @@
 #include <stddef.h>
 #include "tfm_arch.h"
 #include "cmsis_compiler.h"
+#include "tfm_list.h"
 
 /* Status code */
 #define THRD_STAT_CREATING        0
@@ -30,6 +31,15 @@
 #define THRD_PRIOR_MEDIUM         0x7F
 #define THRD_PRIOR_LOWEST         0xFF
 
+/*
+ * The scheduler keeps one ready queue per priority level. A level groups
+ * (1 << THRD_PRIOR_LEVEL_SHIFT) consecutive priority values, so that the
+ * ready levels fit in a single 32-bit bitmap.
+ */
+#define THRD_PRIOR_LEVEL_SHIFT    3
+#define THRD_PRIOR_LEVELS         \
+                        ((THRD_PRIOR_MASK >> THRD_PRIOR_LEVEL_SHIFT) + 1)
+
 /* Error code */
 #define THRD_SUCCESS              0
 #define THRD_ERR_INVALID_PARAM    1
@@ -51,7 +61,8 @@ struct tfm_thrd_ctx {
     uint32_t        status;             /* status                       */
 
     struct tfm_state_context state_ctx; /* State context                */
-    struct tfm_thrd_ctx *next;          /* next thread in list          */
+    uint32_t        ready_level;        /* level of the ready queue     */
+    struct tfm_list_node_t ready_node;  /* node in the ready queue      */
 };
 
 /*
@@ -176,10 +187,15 @@ uint32_t tfm_thrd_start(struct tfm_thrd_ctx *pth);
 struct tfm_thrd_ctx *tfm_thrd_curr_thread(void);
 
 /*
- * Get next running thread in list.
+ * Get next running thread.
  *
  * Return :
- *  Pointer of next thread to be run.
+ *  Pointer of next thread to be run, NULL if no thread is running.
+ *
+ * Notes :
+ *  The thread is the first one of the ready queue of the highest priority
+ *  level which has a running thread. The cost does not depend on the number
+ *  of threads.
  */
 struct tfm_thrd_ctx *tfm_thrd_next_thread(void);
 
@@ -1,12 +1,88 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
+#ifdef TFM_MSG_QUEUE_PRIORITY
+#include "cmsis_compiler.h"
+#endif
 #include "tfm_internal_defines.h"
 #include "tfm_message_queue.h"
 
+#ifdef TFM_MSG_QUEUE_PRIORITY
+#define MSG_CLASS_BIT(prior_class)  (1UL << (31 - (prior_class)))
+
+/* Message queue process */
+int32_t tfm_msg_enqueue(struct tfm_msg_queue_t *queue,
+                        struct tfm_msg_body_t *node)
+{
+    struct tfm_msg_class_queue_t *class_queue;
+
+    if (!queue || !node) {
+        return IPC_ERROR_BAD_PARAMETERS;
+    }
+
+    if (node->prior_class >= TFM_MSG_QUEUE_PRIOR_CLASSES) {
+        node->prior_class = TFM_MSG_QUEUE_PRIOR_CLASSES - 1;
+    }
+
+    class_queue = &queue->classes[node->prior_class];
+
+    node->enqueue_stamp = queue->dequeue_count;
+    node->next = NULL;
+    if (!(queue->class_bitmap & MSG_CLASS_BIT(node->prior_class))) {
+        class_queue->head = node;
+        class_queue->tail = node;
+        queue->class_bitmap |= MSG_CLASS_BIT(node->prior_class);
+    } else {
+        class_queue->tail->next = node;
+        class_queue->tail = node;
+    }
+    queue->size++;
+    return IPC_SUCCESS;
+}
+
+struct tfm_msg_body_t *tfm_msg_dequeue(struct tfm_msg_queue_t *queue)
+{
+    struct tfm_msg_body_t *pop_node;
+    struct tfm_msg_class_queue_t *class_queue;
+    uint32_t prior_class, i, bitmap, wait, max_wait = 0;
+
+    if (!queue) {
+        return NULL;
+    }
+
+    if (queue->class_bitmap == 0) {
+        return NULL;
+    }
+
+    /* First message of the highest priority class */
+    prior_class = __CLZ(queue->class_bitmap);
+
+    /* Unless the first message of a lower class has waited for too long */
+    bitmap = queue->class_bitmap & ~MSG_CLASS_BIT(prior_class);
+    while (bitmap != 0) {
+        i = __CLZ(bitmap);
+        bitmap &= ~MSG_CLASS_BIT(i);
+        wait = queue->dequeue_count - queue->classes[i].head->enqueue_stamp;
+        if ((wait >= TFM_MSG_QUEUE_AGING_LIMIT) && (wait > max_wait)) {
+            max_wait = wait;
+            prior_class = i;
+        }
+    }
+    class_queue = &queue->classes[prior_class];
+
+    pop_node = class_queue->head;
+    if (pop_node == class_queue->tail) {
+        queue->class_bitmap &= ~MSG_CLASS_BIT(prior_class);
+    }
+    class_queue->head = pop_node->next;
+    queue->dequeue_count++;
+    queue->size--;
+    return pop_node;
+}
+#else /* TFM_MSG_QUEUE_PRIORITY */
 /* Message queue process */
 int32_t tfm_msg_enqueue(struct tfm_msg_queue_t *queue,
                         struct tfm_msg_body_t *node)
@@ -43,6 +119,7 @@ struct tfm_msg_body_t *tfm_msg_dequeue(struct tfm_msg_queue_t *queue)
     queue->size--;
     return pop_node;
 }
+#endif /* TFM_MSG_QUEUE_PRIORITY */
 
 int32_t tfm_msg_queue_is_empty(struct tfm_msg_queue_t *queue)
 {
@@ -1,22 +1,18 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
-#include "tfm_thread.h"
-#include "tfm_wait.h"
-#include "psa/client.h"
-#include "psa/service.h"
 #include "tfm_internal_defines.h"
 #include "cmsis_compiler.h"
 #include "tfm_utils.h"
 #include "tfm_list.h"
 #include "tfm_pools.h"
-#include "tfm_memory_utils.h"
 #include "tfm_core_utils.h"
 
 int32_t tfm_pool_init(struct tfm_pool_instance_t *pool, size_t poolsz,
@@ -30,7 +26,7 @@ int32_t tfm_pool_init(struct tfm_pool_instance_t *pool, size_t poolsz,
     }
 
     /* Ensure buffer is large enough */
-    if (poolsz != ((chunksz + sizeof(struct tfm_pool_chunk_t)) * num +
+    if (poolsz != (POOL_CHUNK_SIZE(chunksz) * num +
         sizeof(struct tfm_pool_instance_t))) {
         return IPC_ERROR_BAD_PARAMETERS;
     }
@@ -45,7 +41,8 @@ int32_t tfm_pool_init(struct tfm_pool_instance_t *pool, size_t poolsz,
     for (i = 0; i < num; i++) {
         pchunk->pool = pool;
         tfm_list_add_tail(&pool->chunks_list, &pchunk->list);
-        pchunk = (struct tfm_pool_chunk_t *)&pchunk->data[chunksz];
+        pchunk = (struct tfm_pool_chunk_t *)((uint8_t *)pchunk +
+                                             POOL_CHUNK_SIZE(chunksz));
     }
 
     /* Prepare instance and insert to pool list */
@@ -91,7 +88,7 @@ bool is_valid_chunk_data_in_pool(struct tfm_pool_instance_t *pool,
                                  uint8_t *data)
 {
     const uintptr_t chunks_start = (uintptr_t)(pool->chunks);
-    const size_t chunks_size = pool->chunksz + sizeof(struct tfm_pool_chunk_t);
+    const size_t chunks_size = POOL_CHUNK_SIZE(pool->chunksz);
     const size_t chunk_count = pool->chunk_count;
     const uintptr_t chunks_end = chunks_start + chunks_size * chunk_count;
     uintptr_t pool_chunk_address = 0;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -13,6 +13,7 @@
 #include "tfm_memory_utils.h"
 #include "tfm_message_queue.h"
 #include "tfm_psa_client_call.h"
+#include "tfm_rpc.h"
 #include "tfm_utils.h"
 #include "tfm_wait.h"
 #include "tfm_nspm.h"
@@ -99,6 +100,9 @@ psa_status_t tfm_psa_connect(uint32_t sid, uint32_t version, bool ns_caller)
     /* No input or output needed for connect message */
     tfm_spm_fill_msg(msg, service, connect_handle, PSA_IPC_CONNECT,
                      client_id, NULL, 0, NULL, 0, NULL);
+    if (ns_caller) {
+        tfm_rpc_set_caller_data(msg, client_id);
+    }
 
     /*
      * Send message and wake up the SP who is waiting on message queue,
@@ -234,6 +238,9 @@ psa_status_t tfm_psa_call(psa_handle_t handle, int32_t type,
 
     tfm_spm_fill_msg(msg, service, handle, type, client_id, invecs,
                      in_num, outvecs, out_num, outptr);
+    if (ns_caller) {
+        tfm_rpc_set_caller_data(msg, client_id);
+    }
 
     /*
      * Send message and wake up the SP who is waiting on message queue,
@@ -291,6 +298,9 @@ void tfm_psa_close(psa_handle_t handle, bool ns_caller)
     /* No input or output needed for close message */
     tfm_spm_fill_msg(msg, service, handle, PSA_IPC_DISCONNECT, client_id,
                      NULL, 0, NULL, 0, NULL);
+    if (ns_caller) {
+        tfm_rpc_set_caller_data(msg, client_id);
+    }
 
     /*
      * Send message and wake up the SP who is waiting on message queue,
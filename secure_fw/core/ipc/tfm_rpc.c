@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -20,9 +20,17 @@ static void default_mailbox_reply(const void *owner, int32_t ret)
     (void)ret;
 }
 
+static const void *default_get_caller_data(int32_t client_id)
+{
+    (void)client_id;
+
+    return NULL;
+}
+
 static struct tfm_rpc_ops_t rpc_ops = {
-    .handle_req = default_handle_req,
-    .reply      = default_mailbox_reply,
+    .handle_req      = default_handle_req,
+    .reply           = default_mailbox_reply,
+    .get_caller_data = default_get_caller_data,
 };
 
 uint32_t tfm_rpc_psa_framework_version(void)
@@ -71,18 +79,21 @@ int32_t tfm_rpc_register_ops(const struct tfm_rpc_ops_t *ops_ptr)
         return TFM_RPC_INVAL_PARAM;
     }
 
-    if (!ops_ptr->handle_req || !ops_ptr->reply) {
+    if (!ops_ptr->handle_req || !ops_ptr->reply ||
+        !ops_ptr->get_caller_data) {
         return TFM_RPC_INVAL_PARAM;
     }
 
     /* Currently, one and only one mailbox implementation is supported. */
     if ((rpc_ops.handle_req != default_handle_req) ||
-        (rpc_ops.reply != default_mailbox_reply)) {
+        (rpc_ops.reply != default_mailbox_reply) ||
+        (rpc_ops.get_caller_data != default_get_caller_data)) {
         return TFM_RPC_CONFLICT_CALLBACK;
     }
 
     rpc_ops.handle_req = ops_ptr->handle_req;
     rpc_ops.reply = ops_ptr->reply;
+    rpc_ops.get_caller_data = ops_ptr->get_caller_data;
 
     return TFM_RPC_SUCCESS;
 }
@@ -91,6 +102,7 @@ void tfm_rpc_unregister_ops(void)
 {
     rpc_ops.handle_req = default_handle_req;
     rpc_ops.reply = default_mailbox_reply;
+    rpc_ops.get_caller_data = default_get_caller_data;
 }
 
 void tfm_rpc_client_call_handler(void)
@@ -102,3 +114,10 @@ void tfm_rpc_client_call_reply(const void *owner, int32_t ret)
 {
     rpc_ops.reply(owner, ret);
 }
+
+void tfm_rpc_set_caller_data(struct tfm_msg_body_t *msg, int32_t client_id)
+{
+    TFM_CORE_ASSERT(msg != NULL);
+
+    msg->caller_data = rpc_ops.get_caller_data(client_id);
+}
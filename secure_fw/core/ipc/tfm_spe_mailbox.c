@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -17,6 +17,9 @@
 
 static struct secure_mailbox_queue_t spe_mailbox_queue;
 
+/* Index of the SPE mailbox queue slot whose message is being dispatched */
+static uint8_t cur_proc_slot_idx = NUM_MAILBOX_QUEUE_SLOT;
+
 static int32_t tfm_mailbox_dispatch(uint32_t call_type,
                                     const struct psa_client_params_t *params,
                                     int32_t client_id, uint32_t *psa_ret)
@@ -62,27 +65,41 @@ static int32_t tfm_mailbox_dispatch(uint32_t call_type,
 __STATIC_INLINE void set_spe_queue_empty_status(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        spe_mailbox_queue.empty_slots |= (1 << idx);
+        spe_mailbox_queue.empty_slots |= MAILBOX_QUEUE_SLOT_MASK(idx);
     }
 }
 
 __STATIC_INLINE void clear_spe_queue_empty_status(uint8_t idx)
 {
     if (idx < NUM_MAILBOX_QUEUE_SLOT) {
-        spe_mailbox_queue.empty_slots &= ~(1 << idx);
+        spe_mailbox_queue.empty_slots &= ~MAILBOX_QUEUE_SLOT_MASK(idx);
     }
 }
 
 __STATIC_INLINE bool get_spe_queue_empty_status(uint8_t idx)
 {
     if ((idx < NUM_MAILBOX_QUEUE_SLOT) &&
-        (spe_mailbox_queue.empty_slots & (1 << idx))) {
+        (spe_mailbox_queue.empty_slots & MAILBOX_QUEUE_SLOT_MASK(idx))) {
         return true;
     }
 
     return false;
 }
 
+static uint8_t acquire_spe_empty_slot(void)
+{
+    uint8_t idx;
+
+    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
+        if (get_spe_queue_empty_status(idx)) {
+            clear_spe_queue_empty_status(idx);
+            break;
+        }
+    }
+
+    return idx;
+}
+
 __STATIC_INLINE mailbox_queue_status_t get_nspe_queue_pend_status(
                                     const struct ns_mailbox_queue_t *ns_queue)
 {
@@ -118,7 +135,8 @@ __STATIC_INLINE int32_t get_spe_mailbox_msg_handle(uint8_t idx,
 __STATIC_INLINE int32_t get_spe_mailbox_msg_idx(mailbox_msg_handle_t handle,
                                                 uint8_t *idx)
 {
-    if ((handle == MAILBOX_MSG_NULL_HANDLE) || !idx) {
+    if ((handle <= MAILBOX_MSG_NULL_HANDLE) ||
+        (handle > NUM_MAILBOX_QUEUE_SLOT) || !idx) {
         return MAILBOX_INVAL_PARAMS;
     }
 
@@ -179,17 +197,208 @@ __STATIC_INLINE int32_t check_mailbox_msg(const struct mailbox_msg_t *msg)
     return MAILBOX_SUCCESS;
 }
 
-int32_t tfm_mailbox_handle_msg(void)
+/*
+ * Dispatches the mailbox message in an NSPE mailbox queue slot.
+ * Sets replied to true if the result has already been written to the NSPE
+ * mailbox queue slot, and NSPE should be told about it.
+ * Returns MAILBOX_QUEUE_FULL if no SPE mailbox queue slot is available to
+ * handle the message.
+ */
+static int32_t mailbox_handle_slot(uint8_t ns_idx, bool *replied)
 {
     uint8_t idx;
     int32_t result;
     uint32_t psa_ret = PSA_ERROR_GENERIC_ERROR;
-    mailbox_queue_status_t mask_bits, pend_slots, reply_slots = 0;
     struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
     struct mailbox_msg_t *msg_ptr;
 
+    *replied = false;
+
+    /*
+     * An NSPE mailbox queue slot is only reused after its reply has been
+     * fetched, so an empty SPE mailbox queue slot is normally available.
+     */
+    idx = acquire_spe_empty_slot();
+    if (idx >= NUM_MAILBOX_QUEUE_SLOT) {
+        return MAILBOX_QUEUE_FULL;
+    }
+
+    spe_mailbox_queue.queue[idx].ns_slot_idx = ns_idx;
+
+    msg_ptr = &spe_mailbox_queue.queue[idx].msg;
+    tfm_core_util_memcpy(msg_ptr, &ns_queue->queue[ns_idx].msg,
+                         sizeof(*msg_ptr));
+
+    if (check_mailbox_msg(msg_ptr) != MAILBOX_SUCCESS) {
+        mailbox_clean_queue_slot(idx);
+        return MAILBOX_SUCCESS;
+    }
+
+    /*
+     * The SPE mailbox message handle is recorded in the PSA message
+     * created by SPM, and passed back to identify the slot on reply.
+     */
+    get_spe_mailbox_msg_handle(idx, &spe_mailbox_queue.queue[idx].msg_handle);
+
+    cur_proc_slot_idx = idx;
+    result = tfm_mailbox_dispatch(msg_ptr->call_type, &msg_ptr->params,
+                                  msg_ptr->client_id, &psa_ret);
+    cur_proc_slot_idx = NUM_MAILBOX_QUEUE_SLOT;
+    if (result != MAILBOX_SUCCESS) {
+        mailbox_clean_queue_slot(idx);
+        return MAILBOX_SUCCESS;
+    }
+
+    if ((msg_ptr->call_type == MAILBOX_PSA_FRAMEWORK_VERSION) ||
+        (msg_ptr->call_type == MAILBOX_PSA_VERSION)) {
+        /*
+         * Directly write the result to NSPE for psa_framework_version() and
+         * psa_version().
+         */
+        *replied = true;
+
+        mailbox_direct_reply(idx, psa_ret);
+    } else if ((msg_ptr->call_type == MAILBOX_PSA_CONNECT) ||
+               (msg_ptr->call_type == MAILBOX_PSA_CALL)) {
+        /*
+         * If it failed to deliver psa_connect() or psa_call() request to
+         * TF-M IPC SPM, the failure result should be returned immediately.
+         */
+        if (psa_ret != PSA_SUCCESS) {
+            *replied = true;
+            mailbox_direct_reply(idx, psa_ret);
+        }
+    } else if ((msg_ptr->call_type == MAILBOX_PSA_CLOSE) &&
+               (msg_ptr->params.psa_close_params.handle == PSA_NULL_HANDLE)) {
+        /*
+         * psa_close() with the null handle completes without creating a
+         * PSA message, so no reply will come from SPM.
+         */
+        *replied = true;
+        mailbox_direct_reply(idx, PSA_SUCCESS);
+    }
+    /*
+     * Skip checking psa_call() since it neither returns immediately nor
+     * has return value.
+     */
+
+    return MAILBOX_SUCCESS;
+}
+
+#ifdef TFM_MAILBOX_RING
+__STATIC_INLINE uint32_t mailbox_ring_next(uint32_t pos)
+{
+    return (pos + 1) % MAILBOX_RING_SIZE;
+}
+
+/*
+ * Puts an NSPE mailbox queue slot, whose result has been written, into the
+ * reply ring. SPE is the single producer of the reply ring.
+ * Returns true if NSPE had already consumed all the previous replies, in which
+ * case NSPE must be notified of the new reply.
+ */
+static bool mailbox_push_reply(uint8_t ns_idx)
+{
+    struct mailbox_ring_t *ring = &spe_mailbox_queue.ns_queue->reply_ring;
+    uint32_t head = spe_mailbox_queue.reply_head;
+
+    ring->entries[head] = ns_idx;
+
+    /* Make the result and the entry visible before the head covering them */
+    __DMB();
+    spe_mailbox_queue.reply_head = mailbox_ring_next(head);
+    ring->head = spe_mailbox_queue.reply_head;
+
+    /* Publish the head before checking whether NSPE is still consuming */
+    __DMB();
+
+    return ring->tail == head;
+}
+
+int32_t tfm_mailbox_handle_msg(void)
+{
+    uint8_t ns_idx;
+    uint32_t head;
+    uint32_t tail = spe_mailbox_queue.req_tail;
+    bool replied;
+    struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
+    struct mailbox_ring_t *ring;
+
+    TFM_CORE_ASSERT(ns_queue != NULL);
+
+    spe_mailbox_queue.retry_pending = false;
+
+    ring = &ns_queue->req_ring;
+
+    /* Check if NSPE mailbox did assert a PSA client call request */
+    head = ring->head;
+    if (head == tail) {
+        return MAILBOX_NO_PEND_EVENT;
+    }
+
+    /* Consume the request ring until it is empty */
+    while (head != tail) {
+        /* The head is written by NSPE and must be checked */
+        if (head >= MAILBOX_RING_SIZE) {
+            return MAILBOX_INVAL_PARAMS;
+        }
+
+        while (tail != head) {
+            /* Read the entry only after the head which covers it */
+            __DMB();
+            ns_idx = ring->entries[tail];
+
+            if (ns_idx < NUM_MAILBOX_QUEUE_SLOT) {
+                /*
+                 * Leave this request and the following ones in the ring if
+                 * no SPE mailbox queue slot is available. They are handled
+                 * again once a slot is freed.
+                 */
+                if (mailbox_handle_slot(ns_idx, &replied) ==
+                    MAILBOX_QUEUE_FULL) {
+                    spe_mailbox_queue.retry_pending = true;
+                    break;
+                }
+
+                if (replied && mailbox_push_reply(ns_idx)) {
+                    spe_mailbox_queue.notify_pending = true;
+                }
+            }
+
+            tail = mailbox_ring_next(tail);
+        }
+
+        /* Release the handled entries to NSPE */
+        spe_mailbox_queue.req_tail = tail;
+        __DMB();
+        ring->tail = tail;
+
+        if (spe_mailbox_queue.retry_pending) {
+            break;
+        }
+
+        /*
+         * Publish the tail before checking the head again, so that a request
+         * added meanwhile is either handled here or notified by NSPE.
+         */
+        __DMB();
+        head = ring->head;
+    }
+
+    return MAILBOX_SUCCESS;
+}
+#else /* TFM_MAILBOX_RING */
+int32_t tfm_mailbox_handle_msg(void)
+{
+    uint8_t ns_idx;
+    bool replied;
+    mailbox_queue_status_t mask_bits, pend_slots, reply_slots = 0;
+    struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
+
     TFM_CORE_ASSERT(ns_queue != NULL);
 
+    spe_mailbox_queue.retry_pending = false;
+
     tfm_mailbox_hal_enter_critical();
 
     /* Check if NSPE mailbox did assert a PSA client call request */
@@ -202,72 +411,32 @@ int32_t tfm_mailbox_handle_msg(void)
 
     tfm_mailbox_hal_exit_critical();
 
-    for (idx = 0; idx < NUM_MAILBOX_QUEUE_SLOT; idx++) {
-        mask_bits = (1 << idx);
+    for (ns_idx = 0; ns_idx < NUM_MAILBOX_QUEUE_SLOT; ns_idx++) {
+        mask_bits = MAILBOX_QUEUE_SLOT_MASK(ns_idx);
         /* Check if current NSPE mailbox queue slot is pending for handling */
         if (!(pend_slots & mask_bits)) {
             continue;
         }
 
         /*
-         * TODO
-         * The operations are simplified here. Use the SPE mailbox queue
-         * slot with the same idx as that of the NSPE mailbox queue slot.
-         * A more general implementation should dynamically search and
-         * select an empty SPE mailbox queue slot.
+         * Leave the request pending in NSPE mailbox queue if no SPE mailbox
+         * queue slot is available. It is handled again once a slot is freed.
          */
-        clear_spe_queue_empty_status(idx);
-        spe_mailbox_queue.queue[idx].ns_slot_idx = idx;
-
-        msg_ptr = &spe_mailbox_queue.queue[idx].msg;
-        tfm_core_util_memcpy(msg_ptr, &ns_queue->queue[idx].msg,
-                             sizeof(*msg_ptr));
-
-        if (check_mailbox_msg(msg_ptr) != MAILBOX_SUCCESS) {
-            mailbox_clean_queue_slot(idx);
+        if (mailbox_handle_slot(ns_idx, &replied) != MAILBOX_SUCCESS) {
+            pend_slots &= ~mask_bits;
+            spe_mailbox_queue.retry_pending = true;
             continue;
         }
 
-        /*
-         * Although SPE mailbox message handle is set, it is not used currently
-         * since multiple ongoing NSPE PSA client calls are not supported yet.
-         */
-        get_spe_mailbox_msg_handle(idx,
-                                   &spe_mailbox_queue.queue[idx].msg_handle);
-
-        result = tfm_mailbox_dispatch(msg_ptr->call_type, &msg_ptr->params,
-                                      msg_ptr->client_id, &psa_ret);
-        if (result != MAILBOX_SUCCESS) {
-            mailbox_clean_queue_slot(idx);
-            continue;
-        }
-
-        if ((msg_ptr->call_type == MAILBOX_PSA_FRAMEWORK_VERSION) ||
-            (msg_ptr->call_type == MAILBOX_PSA_VERSION)) {
-            /*
-             * Directly write the result to NSPE for psa_framework_version() and
-             * psa_version().
-             */
-            reply_slots |= (1 << idx);
-
-            mailbox_direct_reply(idx, psa_ret);
-        } else if ((msg_ptr->call_type == MAILBOX_PSA_CONNECT) ||
-                   (msg_ptr->call_type == MAILBOX_PSA_CALL)) {
-            /*
-             * If it failed to deliver psa_connect() or psa_call() request to
-             * TF-M IPC SPM, the failure result should be returned immediately.
-             */
-            if (psa_ret != PSA_SUCCESS) {
-                reply_slots |= (1 << idx);
-                mailbox_direct_reply(idx, psa_ret);
-            }
+        if (replied) {
+            reply_slots |= mask_bits;
         }
-        /*
-         * Skip checking psa_call() since it neither returns immediately nor
-         * has return value.
-         */
     }
 
+    /* Publish the replies returned meanwhile in the same critical section */
+    reply_slots |= spe_mailbox_queue.reply_slots;
+    spe_mailbox_queue.reply_slots = 0;
+
     tfm_mailbox_hal_enter_critical();
 
     /* Clean the NSPE mailbox pending status. */
@@ -279,57 +448,95 @@ int32_t tfm_mailbox_handle_msg(void)
     tfm_mailbox_hal_exit_critical();
 
     if (reply_slots) {
-        tfm_mailbox_hal_notify_peer();
+        spe_mailbox_queue.notify_pending = true;
     }
 
     return MAILBOX_SUCCESS;
 }
+#endif /* TFM_MAILBOX_RING */
 
 int32_t tfm_mailbox_reply_msg(mailbox_msg_handle_t handle, int32_t reply)
 {
-    uint8_t idx;
+    uint8_t idx, ns_idx;
     int32_t ret;
-    struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
 
-    TFM_CORE_ASSERT(ns_queue != NULL);
+    TFM_CORE_ASSERT(spe_mailbox_queue.ns_queue != NULL);
 
-    /*
-     * If handle == MAILBOX_MSG_NULL_HANDLE, reply to the mailbox message
-     * in the first slot.
-     * When multiple ongoing PSA client calls from NSPE are supported,
-     * additional check might be necessary to avoid spoofing the first slot.
-     */
-    if (handle == MAILBOX_MSG_NULL_HANDLE) {
-        idx = 0;
-    } else {
-        ret = get_spe_mailbox_msg_idx(handle, &idx);
-        if (ret != MAILBOX_SUCCESS) {
-            return ret;
-        }
+    ret = get_spe_mailbox_msg_idx(handle, &idx);
+    if (ret != MAILBOX_SUCCESS) {
+        return ret;
     }
 
     if (get_spe_queue_empty_status(idx)) {
         return MAILBOX_NO_PEND_EVENT;
     }
 
+    /* The SPE slot is cleaned by the reply. Fetch the NSPE slot first. */
+    ns_idx = spe_mailbox_queue.queue[idx].ns_slot_idx;
+
     mailbox_direct_reply(idx, (uint32_t)reply);
 
-    tfm_mailbox_hal_enter_critical();
+    /*
+     * A request left in NSPE mailbox queue, because no SPE mailbox queue slot
+     * was available, is handled in the next scheduling pass.
+     */
+    if (spe_mailbox_queue.retry_pending) {
+        tfm_thrd_activate_schedule();
+    }
 
-    /* Set the NSPE mailbox replied status */
-    set_nspe_queue_replied_status(ns_queue, (1 << idx));
+#ifdef TFM_MAILBOX_RING
+    /* NSPE keeps consuming the reply ring until it is empty */
+    if (!mailbox_push_reply(ns_idx)) {
+        return MAILBOX_SUCCESS;
+    }
 
-    tfm_mailbox_hal_exit_critical();
+    spe_mailbox_queue.notify_pending = true;
+#else
+    /* Publish the reply together with the others replied meanwhile */
+    spe_mailbox_queue.reply_slots |= MAILBOX_QUEUE_SLOT_MASK(ns_idx);
+#endif
 
-    tfm_mailbox_hal_notify_peer();
+    /*
+     * Several psa_reply() can complete before the scheduler runs. NSPE is
+     * notified of all of them at once in mailbox_handle_req().
+     */
+    tfm_thrd_activate_schedule();
 
     return MAILBOX_SUCCESS;
 }
 
+/* Publishes the pending replies and notifies NSPE once of all of them */
+static void mailbox_notify_replies(void)
+{
+#ifndef TFM_MAILBOX_RING
+    struct ns_mailbox_queue_t *ns_queue = spe_mailbox_queue.ns_queue;
+
+    if (spe_mailbox_queue.reply_slots) {
+        tfm_mailbox_hal_enter_critical();
+
+        /* Set the NSPE mailbox replied status */
+        set_nspe_queue_replied_status(ns_queue, spe_mailbox_queue.reply_slots);
+
+        tfm_mailbox_hal_exit_critical();
+
+        spe_mailbox_queue.reply_slots = 0;
+        spe_mailbox_queue.notify_pending = true;
+    }
+#endif
+
+    if (spe_mailbox_queue.notify_pending) {
+        spe_mailbox_queue.notify_pending = false;
+        tfm_mailbox_hal_notify_peer();
+    }
+}
+
 /* RPC handle_req() callback */
 static void mailbox_handle_req(void)
 {
     (void)tfm_mailbox_handle_msg();
+
+    /* Notify NSPE once of all the replies of this scheduling pass */
+    mailbox_notify_replies();
 }
 
 /* RPC reply() callback */
@@ -345,10 +552,24 @@ static void mailbox_reply(const void *owner, int32_t ret)
     (void)tfm_mailbox_reply_msg(handle, ret);
 }
 
+/* RPC get_caller_data() callback */
+static const void *mailbox_get_caller_data(int32_t client_id)
+{
+    (void)client_id;
+
+    /* Identify the mailbox message being dispatched by its handle */
+    if (cur_proc_slot_idx >= NUM_MAILBOX_QUEUE_SLOT) {
+        return NULL;
+    }
+
+    return &spe_mailbox_queue.queue[cur_proc_slot_idx].msg_handle;
+}
+
 /* Mailbox specific operations callback for TF-M RPC */
 static const struct tfm_rpc_ops_t mailbox_rpc_ops = {
-    .handle_req = mailbox_handle_req,
-    .reply      = mailbox_reply,
+    .handle_req      = mailbox_handle_req,
+    .reply           = mailbox_reply,
+    .get_caller_data = mailbox_get_caller_data,
 };
 
 int32_t tfm_mailbox_init(void)
@@ -357,8 +578,7 @@ int32_t tfm_mailbox_init(void)
 
     tfm_core_util_memset(&spe_mailbox_queue, 0, sizeof(spe_mailbox_queue));
 
-    spe_mailbox_queue.empty_slots =
-                    (mailbox_queue_status_t)((1 << NUM_MAILBOX_QUEUE_SLOT) - 1);
+    spe_mailbox_queue.empty_slots = MAILBOX_QUEUE_ALL_SLOTS_MASK;
 
     /* Register RPC callbacks */
     ret = tfm_rpc_register_ops(&mailbox_rpc_ops);
@@ -1,11 +1,12 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include "core/tfm_core_svc.h"
 #include "psa/client.h"
@@ -129,6 +130,142 @@ void tfm_svcall_psa_close(uint32_t *args, bool ns_caller)
     return tfm_psa_close(handle, ns_caller);
 }
 
+/* State of the batched psa_call submission in progress */
+static struct {
+    const struct tfm_psa_call_batch_req_t *reqs; /* NS request array */
+    psa_status_t *status;                        /* NS status array */
+    size_t num;                                  /* Number of requests */
+    size_t idx;                                  /* Request in progress */
+    uint32_t privileged;                         /* Caller privilege */
+    bool active;                                 /* Batch in progress */
+} call_batch;
+
+/**
+ * \brief Dispatch the current request of the batch, or finish the batch when
+ *        all requests have been processed.
+ *
+ * \param[in] args              Stacked context of the veneer. args[1] is set
+ *                              to non-zero if a request has been dispatched,
+ *                              to zero when the batch is complete.
+ *
+ * \retval PSA_SUCCESS          The batch is complete.
+ * \retval >=0                  Status of the dispatched request, see
+ *                              \ref tfm_psa_call.
+ */
+static psa_status_t tfm_svcall_psa_call_batch_dispatch(uint32_t *args)
+{
+    struct tfm_psa_call_batch_req_t req;
+
+    if (call_batch.idx >= call_batch.num) {
+        call_batch.active = false;
+        args[1] = 0;
+        return PSA_SUCCESS;
+    }
+
+    /* Take a copy so that the NSPE can not alter the request under check */
+    tfm_core_util_memcpy(&req, &call_batch.reqs[call_batch.idx], sizeof(req));
+
+    /* The request type must be zero or positive. */
+    if (req.type < 0) {
+        tfm_core_panic();
+    }
+
+    args[1] = 1;
+
+    return tfm_psa_call(req.handle, req.type, req.in_vec, req.in_len,
+                        req.out_vec, req.out_len, true,
+                        call_batch.privileged);
+}
+
+/**
+ * \brief SVC handler starting a batched psa_call submission.
+ *
+ * \param[in] args              Include all input arguments: reqs, num,
+ *                              status.
+ * \param[in] ns_caller         If 'true', call from non-secure client.
+ *
+ * \retval PSA_SUCCESS          The batch is empty.
+ * \retval >=0                  Status of the first request.
+ * \retval "Does not return"    The call is not from the NSPE, a batch is
+ *                              already in progress, or the request or status
+ *                              array is invalid.
+ */
+static psa_status_t tfm_svcall_psa_call_batch(uint32_t *args, bool ns_caller)
+{
+    struct spm_partition_desc_t *partition = NULL;
+    size_t num;
+
+    TFM_CORE_ASSERT(args != NULL);
+
+    if (!ns_caller || call_batch.active) {
+        tfm_core_panic();
+    }
+
+    partition = tfm_spm_get_running_partition();
+    if (!partition) {
+        tfm_core_panic();
+    }
+
+    num = (size_t)args[1];
+    if (num > SIZE_MAX / sizeof(struct tfm_psa_call_batch_req_t)) {
+        tfm_core_panic();
+    }
+
+    call_batch.privileged = tfm_spm_partition_get_privileged_mode(
+        partition->static_data->partition_flags);
+
+    /*
+     * It is a fatal error if the request array is not readable or the status
+     * array is not writable by the caller.
+     */
+    if (tfm_memory_check((const void *)args[0],
+        num * sizeof(struct tfm_psa_call_batch_req_t), ns_caller,
+        TFM_MEMORY_ACCESS_RO, call_batch.privileged) != IPC_SUCCESS) {
+        tfm_core_panic();
+    }
+
+    if (tfm_memory_check((void *)args[2], num * sizeof(psa_status_t),
+        ns_caller, TFM_MEMORY_ACCESS_RW,
+        call_batch.privileged) != IPC_SUCCESS) {
+        tfm_core_panic();
+    }
+
+    call_batch.reqs = (const struct tfm_psa_call_batch_req_t *)args[0];
+    call_batch.status = (psa_status_t *)args[2];
+    call_batch.num = num;
+    call_batch.idx = 0;
+    call_batch.active = true;
+
+    return tfm_svcall_psa_call_batch_dispatch(args);
+}
+
+/**
+ * \brief SVC handler recording the status of the current request of the batch
+ *        and dispatching the next one.
+ *
+ * \param[in] args              Include all input arguments: status of the
+ *                              request just completed.
+ * \param[in] ns_caller         If 'true', call from non-secure client.
+ *
+ * \retval PSA_SUCCESS          The batch is complete.
+ * \retval >=0                  Status of the next request.
+ * \retval "Does not return"    No batch is in progress.
+ */
+static psa_status_t tfm_svcall_psa_call_batch_next(uint32_t *args,
+                                                   bool ns_caller)
+{
+    TFM_CORE_ASSERT(args != NULL);
+
+    if (!ns_caller || !call_batch.active) {
+        tfm_core_panic();
+    }
+
+    call_batch.status[call_batch.idx] = (psa_status_t)args[0];
+    call_batch.idx++;
+
+    return tfm_svcall_psa_call_batch_dispatch(args);
+}
+
 /*********************** SVC handler for PSA Service APIs ********************/
 
 /**
@@ -568,6 +705,283 @@ static void tfm_svcall_psa_write(uint32_t *args)
     msg->outvec[outvec_idx].len += num_bytes;
 }
 
+#ifdef TFM_MM_IOVEC
+/**
+ * \brief Checks if a memory range overlaps one of the client vectors of a
+ *        message in the other direction.
+ *
+ * \param[in] msg               Message the range belongs to
+ * \param[in] base              Start of the memory range
+ * \param[in] len               Length of the memory range
+ * \param[in] is_invec          true if the range is in an input vector, false
+ *                              if it is in an output vector
+ *
+ * \retval true                 The range overlaps a non-empty vector
+ * \retval false                The range does not overlap any vector
+ */
+static bool tfm_spm_iovec_overlaps(const struct tfm_msg_body_t *msg,
+                                   const uint8_t *base, size_t len,
+                                   bool is_invec)
+{
+    const uint8_t *vec_base;
+    size_t vec_len;
+    uint32_t i;
+
+    for (i = 0; i < PSA_MAX_IOVEC; i++) {
+        if (is_invec) {
+            vec_base = (const uint8_t *)msg->outvec[i].base;
+            vec_len = msg->msg.out_size[i];
+        } else {
+            vec_base = (const uint8_t *)msg->invec[i].base;
+            vec_len = msg->msg.in_size[i];
+        }
+
+        if ((vec_len != 0) &&
+            !(vec_base + vec_len <= base || vec_base >= base + len)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * \brief SVC handler for \ref psa_map_invec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, invec_idx.
+ *
+ * \retval !NULL                Address of the remaining data in the client
+ *                              input vector.
+ * \retval NULL                 The input vector is empty, cannot be read by
+ *                              the Secure Partition directly or overlaps an
+ *                              output vector.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           invec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ */
+static const void *tfm_svcall_psa_map_invec(uint32_t *args)
+{
+    psa_handle_t msg_handle;
+    uint32_t invec_idx;
+    struct tfm_msg_body_t *msg = NULL;
+    uint32_t privileged;
+    struct spm_partition_desc_t *partition = NULL;
+
+    TFM_CORE_ASSERT(args != NULL);
+    msg_handle = (psa_handle_t)args[0];
+    invec_idx = args[1];
+
+    /* It is a fatal error if message handle is invalid */
+    msg = tfm_spm_get_msg_from_handle(msg_handle);
+    if (!msg) {
+        tfm_core_panic();
+    }
+
+    partition = msg->service->partition;
+    privileged = tfm_spm_partition_get_privileged_mode(
+        partition->static_data->partition_flags);
+
+    /*
+     * It is a fatal error if message handle does not refer to a request
+     * message
+     */
+    if (msg->msg.type < PSA_IPC_CALL) {
+        tfm_core_panic();
+    }
+
+    /*
+     * It is a fatal error if invec_idx is equal to or greater than
+     * PSA_MAX_IOVEC
+     */
+    if (invec_idx >= PSA_MAX_IOVEC) {
+        tfm_core_panic();
+    }
+
+    /* There was no remaining data in this input vector */
+    if (msg->msg.in_size[invec_idx] == 0) {
+        return NULL;
+    }
+
+    /*
+     * The client access has been checked by the client call already. The
+     * data can only be mapped if the Secure Partition is allowed to read it
+     * as well, otherwise the Secure Partition falls back to psa_read.
+     */
+    if (tfm_memory_check(msg->invec[invec_idx].base,
+        msg->msg.in_size[invec_idx], false, TFM_MEMORY_ACCESS_RO,
+        privileged) != IPC_SUCCESS) {
+        return NULL;
+    }
+
+    /*
+     * The Secure Partition could change its own input while processing it
+     * by writing an output vector which overlaps the input vector. Such an
+     * input vector can only be accessed with psa_read.
+     */
+    if (tfm_spm_iovec_overlaps(msg, msg->invec[invec_idx].base,
+        msg->msg.in_size[invec_idx], true)) {
+        return NULL;
+    }
+
+    return msg->invec[invec_idx].base;
+}
+
+/**
+ * \brief SVC handler for \ref psa_map_outvec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, outvec_idx.
+ *
+ * \retval !NULL                Address following the data already written to
+ *                              the client output vector.
+ * \retval NULL                 The output vector is full, cannot be written
+ *                              by the Secure Partition directly or overlaps
+ *                              an input vector.
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           outvec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ */
+static void *tfm_svcall_psa_map_outvec(uint32_t *args)
+{
+    psa_handle_t msg_handle;
+    uint32_t outvec_idx;
+    struct tfm_msg_body_t *msg = NULL;
+    uint32_t privileged;
+    struct spm_partition_desc_t *partition = NULL;
+    size_t remaining;
+
+    TFM_CORE_ASSERT(args != NULL);
+    msg_handle = (psa_handle_t)args[0];
+    outvec_idx = args[1];
+
+    /* It is a fatal error if message handle is invalid */
+    msg = tfm_spm_get_msg_from_handle(msg_handle);
+    if (!msg) {
+        tfm_core_panic();
+    }
+
+    partition = msg->service->partition;
+    privileged = tfm_spm_partition_get_privileged_mode(
+        partition->static_data->partition_flags);
+
+    /*
+     * It is a fatal error if message handle does not refer to a request
+     * message
+     */
+    if (msg->msg.type < PSA_IPC_CALL) {
+        tfm_core_panic();
+    }
+
+    /*
+     * It is a fatal error if outvec_idx is equal to or greater than
+     * PSA_MAX_IOVEC
+     */
+    if (outvec_idx >= PSA_MAX_IOVEC) {
+        tfm_core_panic();
+    }
+
+    remaining = msg->msg.out_size[outvec_idx] - msg->outvec[outvec_idx].len;
+    if (remaining == 0) {
+        return NULL;
+    }
+
+    /*
+     * The output vector can only be mapped if the Secure Partition is allowed
+     * to write it, otherwise the Secure Partition falls back to psa_write.
+     */
+    if (tfm_memory_check((uint8_t *)msg->outvec[outvec_idx].base +
+        msg->outvec[outvec_idx].len, remaining, false, TFM_MEMORY_ACCESS_RW,
+        privileged) != IPC_SUCCESS) {
+        return NULL;
+    }
+
+    /*
+     * The Secure Partition could change its own input while processing it
+     * by writing to an output vector which overlaps an input vector. Such an
+     * output vector can only be accessed with psa_write.
+     */
+    if (tfm_spm_iovec_overlaps(msg, (uint8_t *)msg->outvec[outvec_idx].base +
+        msg->outvec[outvec_idx].len, remaining, false)) {
+        return NULL;
+    }
+
+    return (uint8_t *)msg->outvec[outvec_idx].base +
+           msg->outvec[outvec_idx].len;
+}
+
+/**
+ * \brief SVC handler for \ref psa_unmap_outvec.
+ *
+ * \param[in] args              Include all input arguments:
+ *                              msg_handle, outvec_idx, len.
+ *
+ * \retval void                 Success
+ * \retval "Does not return"    The call is invalid, one or more of the
+ *                              following are true:
+ * \arg                           msg_handle is invalid.
+ * \arg                           msg_handle does not refer to a request
+ *                                message.
+ * \arg                           outvec_idx is equal to or greater than
+ *                                \ref PSA_MAX_IOVEC.
+ * \arg                           len is greater than the space remaining in
+ *                                the client output vector.
+ */
+static void tfm_svcall_psa_unmap_outvec(uint32_t *args)
+{
+    psa_handle_t msg_handle;
+    uint32_t outvec_idx;
+    size_t len;
+    struct tfm_msg_body_t *msg = NULL;
+
+    TFM_CORE_ASSERT(args != NULL);
+    msg_handle = (psa_handle_t)args[0];
+    outvec_idx = args[1];
+    len = (size_t)args[2];
+
+    /* It is a fatal error if message handle is invalid */
+    msg = tfm_spm_get_msg_from_handle(msg_handle);
+    if (!msg) {
+        tfm_core_panic();
+    }
+
+    /*
+     * It is a fatal error if message handle does not refer to a request
+     * message
+     */
+    if (msg->msg.type < PSA_IPC_CALL) {
+        tfm_core_panic();
+    }
+
+    /*
+     * It is a fatal error if outvec_idx is equal to or greater than
+     * PSA_MAX_IOVEC
+     */
+    if (outvec_idx >= PSA_MAX_IOVEC) {
+        tfm_core_panic();
+    }
+
+    /*
+     * It is a fatal error if the reported length goes past the end of the
+     * client output vector
+     */
+    if (len > msg->msg.out_size[outvec_idx] - msg->outvec[outvec_idx].len) {
+        tfm_core_panic();
+    }
+
+    /* Update the write number */
+    msg->outvec[outvec_idx].len += len;
+}
+#endif /* TFM_MM_IOVEC */
+
 static void update_caller_outvec_len(struct tfm_msg_body_t *msg)
 {
     int32_t i = 0;
@@ -686,7 +1100,7 @@ static void tfm_svcall_psa_reply(uint32_t *args)
     }
 
     if (is_tfm_rpc_msg(msg)) {
-        tfm_rpc_client_call_reply(NULL, ret);
+        tfm_rpc_client_call_reply(msg->caller_data, ret);
     } else {
         tfm_event_wake(&msg->ack_evnt, ret);
     }
@@ -1037,6 +1451,10 @@ int32_t SVC_Handler_IPC(tfm_svc_number_t svc_num, uint32_t *ctx, uint32_t lr)
     case TFM_SVC_PSA_CLOSE:
         tfm_svcall_psa_close(ctx, ns_caller);
         break;
+    case TFM_SVC_PSA_CALL_BATCH:
+        return tfm_svcall_psa_call_batch(ctx, ns_caller);
+    case TFM_SVC_PSA_CALL_BATCH_NEXT:
+        return tfm_svcall_psa_call_batch_next(ctx, ns_caller);
     case TFM_SVC_PSA_WAIT:
         return tfm_svcall_psa_wait(ctx);
     case TFM_SVC_PSA_GET:
@@ -1054,6 +1472,15 @@ int32_t SVC_Handler_IPC(tfm_svc_number_t svc_num, uint32_t *ctx, uint32_t lr)
     case TFM_SVC_PSA_REPLY:
         tfm_svcall_psa_reply(ctx);
         break;
+#ifdef TFM_MM_IOVEC
+    case TFM_SVC_PSA_MAP_INVEC:
+        return (int32_t)tfm_svcall_psa_map_invec(ctx);
+    case TFM_SVC_PSA_MAP_OUTVEC:
+        return (int32_t)tfm_svcall_psa_map_outvec(ctx);
+    case TFM_SVC_PSA_UNMAP_OUTVEC:
+        tfm_svcall_psa_unmap_outvec(ctx);
+        break;
+#endif
     case TFM_SVC_PSA_NOTIFY:
         tfm_svcall_psa_notify(ctx);
         break;
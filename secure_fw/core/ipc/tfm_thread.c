@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -13,33 +13,39 @@
 #include "spm_api.h"
 #include "tfm_core_utils.h"
 
+#if THRD_PRIOR_LEVELS > 32
+#error "The ready levels must fit in a 32-bit bitmap"
+#endif
+
 /* Force ZERO in case ZI(bss) clear is missing */
-static struct tfm_thrd_ctx *p_thrd_head = NULL;
-static struct tfm_thrd_ctx *p_runn_head = NULL;
 static struct tfm_thrd_ctx *p_curr_thrd = NULL;
 
+/*
+ * Ready queues, one per priority level, and the bitmap of the levels which
+ * have a running thread. Level 'n' is held in bit (31 - n), so the highest
+ * priority ready level is given by a count of leading zeros.
+ */
+static struct tfm_list_node_t ready_queue[THRD_PRIOR_LEVELS];
+static uint32_t ready_bitmap = 0;
+
 /* Define Macro to fetch global to support future expansion (PERCPU e.g.) */
-#define LIST_HEAD   p_thrd_head
-#define RUNN_HEAD   p_runn_head
 #define CURR_THRD   p_curr_thrd
 
-static struct tfm_thrd_ctx *find_next_running_thread(struct tfm_thrd_ctx *pth)
-{
-    while (pth && pth->status != THRD_STAT_RUNNING) {
-        pth = pth->next;
-    }
-
-    return pth;
-}
+#define READY_LEVEL_BIT(level)  (1UL << (31 - (level)))
 
 /* To get next running thread for scheduler */
 struct tfm_thrd_ctx *tfm_thrd_next_thread(void)
 {
-    /*
-     * First RUNNING thread has highest priority since threads are sorted with
-     * priority.
-     */
-    return find_next_running_thread(RUNN_HEAD);
+    struct tfm_list_node_t *node;
+
+    if (ready_bitmap == 0) {
+        return NULL;
+    }
+
+    /* First thread of the highest priority ready level */
+    node = tfm_list_first_node(&ready_queue[__CLZ(ready_bitmap)]);
+
+    return TFM_GET_CONTAINER_PTR(node, struct tfm_thrd_ctx, ready_node);
 }
 
 /* To get current thread for caller */
@@ -48,36 +54,29 @@ struct tfm_thrd_ctx *tfm_thrd_curr_thread()
     return CURR_THRD;
 }
 
-/* Insert a new thread into list by descending priority (Highest at head) */
-static void insert_by_prior(struct tfm_thrd_ctx **head,
-                            struct tfm_thrd_ctx *node)
+/* Append a thread to the ready queue of its priority level */
+static void ready_queue_insert(struct tfm_thrd_ctx *pth)
 {
-    if (*head == NULL || (node->prior <= (*head)->prior)) {
-        node->next = *head;
-        *head = node;
-    } else {
-        struct tfm_thrd_ctx *iter = *head;
-
-        while (iter->next && (node->prior > iter->next->prior)) {
-            iter = iter->next;
-        }
-        node->next = iter->next;
-        iter->next = node;
+    uint32_t level = (pth->prior & THRD_PRIOR_MASK) >> THRD_PRIOR_LEVEL_SHIFT;
+
+    /* The ready queues are set up on first use, with ZI(bss) cleared */
+    if (ready_queue[level].next == NULL) {
+        tfm_list_init(&ready_queue[level]);
     }
+
+    pth->ready_level = level;
+    tfm_list_add_tail(&ready_queue[level], &pth->ready_node);
+    ready_bitmap |= READY_LEVEL_BIT(level);
 }
 
-/*
- * Set first running thread as head to reduce enumerate
- * depth while searching for a first running thread.
- */
-static void update_running_head(struct tfm_thrd_ctx **runn,
-                                struct tfm_thrd_ctx *node)
+/* Remove a thread from the ready queue it was appended to */
+static void ready_queue_remove(struct tfm_thrd_ctx *pth)
 {
-    if ((node->status == THRD_STAT_RUNNING) &&
-        (*runn == NULL || (node->prior < (*runn)->prior))) {
-        *runn = node;
-    } else {
-        *runn = LIST_HEAD;
+    uint32_t level = pth->ready_level;
+
+    tfm_list_del_node(&pth->ready_node);
+    if (tfm_list_is_empty(&ready_queue[level])) {
+        ready_bitmap &= ~READY_LEVEL_BIT(level);
     }
 }
 
@@ -144,10 +143,7 @@ uint32_t tfm_thrd_start(struct tfm_thrd_ctx *pth)
                                 pth->param, (uintptr_t)pth->pfn,
                                 pth->sp_btm, pth->sp_top);
 
-    /* Insert a new thread with priority */
-    insert_by_prior(&LIST_HEAD, pth);
-
-    /* Mark it as RUNNING after insertion */
+    /* Mark it as RUNNING, which inserts it into its ready queue */
     tfm_thrd_set_status(pth, THRD_STAT_RUNNING);
 
     return THRD_SUCCESS;
@@ -157,8 +153,14 @@ void tfm_thrd_set_status(struct tfm_thrd_ctx *pth, uint32_t new_status)
 {
     TFM_CORE_ASSERT(pth != NULL && new_status < THRD_STAT_INVALID);
 
+    if (pth->status != THRD_STAT_RUNNING && new_status == THRD_STAT_RUNNING) {
+        ready_queue_insert(pth);
+    } else if (pth->status == THRD_STAT_RUNNING &&
+               new_status != THRD_STAT_RUNNING) {
+        ready_queue_remove(pth);
+    }
+
     pth->status = new_status;
-    update_running_head(&RUNN_HEAD, pth);
 }
 
 /* Scheduling won't happen immediately but after the exception returns */
@@ -189,7 +191,7 @@ void tfm_thrd_start_scheduler(struct tfm_thrd_ctx *pth)
 /* Remove current thread out of the schedulable list */
 void tfm_svcall_thrd_exit(void)
 {
-    CURR_THRD->status = THRD_STAT_DETACH;
+    tfm_thrd_set_status(CURR_THRD, THRD_STAT_DETACH);
     tfm_arch_trigger_pendsv();
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -43,6 +43,13 @@ typedef enum {
     TFM_SVC_PSA_NOTIFY,
     TFM_SVC_PSA_CLEAR,
     TFM_SVC_PSA_PANIC,
+#ifdef TFM_MM_IOVEC
+    TFM_SVC_PSA_MAP_INVEC,
+    TFM_SVC_PSA_MAP_OUTVEC,
+    TFM_SVC_PSA_UNMAP_OUTVEC,
+#endif
+    TFM_SVC_PSA_CALL_BATCH,
+    TFM_SVC_PSA_CALL_BATCH_NEXT,
 #endif
     TFM_SVC_PLATFORM_BASE = 50 /* leave room for additional Core handlers */
 } tfm_svc_number_t;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -67,3 +67,27 @@ void tfm_psa_close_veneer(psa_handle_t handle)
                    "BXNS LR          \n"
                     : : "I" (TFM_SVC_PSA_CLOSE));
 }
+
+/*
+ * The batch is walked inside the secure world without touching the stack, so
+ * every request is validated as a fresh NS call. The handlers leave a non-zero
+ * value in r1 while requests remain; r0 holds the status of the request just
+ * completed, which TFM_SVC_PSA_CALL_BATCH_NEXT records before dispatching the
+ * next one.
+ */
+__tfm_psa_secure_gateway_attributes__
+psa_status_t tfm_psa_call_batch_veneer(
+                                   const struct tfm_psa_call_batch_req_t *reqs,
+                                   size_t num,
+                                   psa_status_t *status)
+{
+    __ASM volatile("SVC %0           \n"
+                   "1:               \n"
+                   "CBZ R1, 2f       \n"
+                   "SVC %1           \n"
+                   "B 1b             \n"
+                   "2:               \n"
+                   "BXNS LR          \n"
+                    : : "I" (TFM_SVC_PSA_CALL_BATCH),
+                        "I" (TFM_SVC_PSA_CALL_BATCH_NEXT));
+}
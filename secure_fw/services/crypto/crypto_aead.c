@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -63,7 +63,7 @@ psa_status_t tfm_crypto_aead_encrypt(psa_invec in_vec[],
     /* Initialise ciphertext_length to zero */
     out_vec[0].len = 0;
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status == PSA_SUCCESS) {
 
         status = psa_aead_encrypt(key_handle, alg, nonce, nonce_length,
@@ -115,7 +115,7 @@ psa_status_t tfm_crypto_aead_decrypt(psa_invec in_vec[],
     /* Initialise plaintext_length to zero */
     out_vec[0].len = 0;
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status == PSA_SUCCESS) {
 
         status = psa_aead_decrypt(key_handle, alg, nonce, nonce_length,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -13,6 +13,10 @@
 #include "tfm_crypto_api.h"
 #include "tfm_crypto_defs.h"
 #include "tfm_memory_utils.h"
+#include "cmsis_compiler.h"
+#include "tfm_internal_defines.h"
+#include "tfm_list.h"
+#include "tfm_pools.h"
 
 /**
  * \def TFM_CRYPTO_CONC_OPER_NUM
@@ -25,57 +29,185 @@
 #define TFM_CRYPTO_CONC_OPER_NUM (8)
 #endif
 
+/*
+ * The default pool sizes below keep the SRAM taken by the contexts under the
+ * TFM_CRYPTO_CONC_OPER_NUM contexts, each sized for the largest type, which
+ * a single shared pool would need. Hash contexts are the smallest and the
+ * most used, so every operation can be a hash, while the larger cipher, MAC
+ * and generator contexts only get a few slots.
+ */
+
+/**
+ * \def TFM_CRYPTO_CIPHER_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        cipher operations, i.e. the number of contexts in the cipher pool
+ */
+#ifndef TFM_CRYPTO_CIPHER_OPER_NUM
+#define TFM_CRYPTO_CIPHER_OPER_NUM (2)
+#endif
+
+/**
+ * \def TFM_CRYPTO_MAC_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        MAC operations, i.e. the number of contexts in the MAC pool
+ */
+#ifndef TFM_CRYPTO_MAC_OPER_NUM
+#define TFM_CRYPTO_MAC_OPER_NUM (2)
+#endif
+
+/**
+ * \def TFM_CRYPTO_HASH_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        hash operations, i.e. the number of contexts in the hash pool
+ */
+#ifndef TFM_CRYPTO_HASH_OPER_NUM
+#define TFM_CRYPTO_HASH_OPER_NUM (TFM_CRYPTO_CONC_OPER_NUM)
+#endif
+
+/**
+ * \def TFM_CRYPTO_GENERATOR_OPER_NUM
+ *
+ * \brief This is the default value for the maximum number of concurrent
+ *        generator operations, i.e. the number of contexts in the generator
+ *        pool
+ */
+#ifndef TFM_CRYPTO_GENERATOR_OPER_NUM
+#define TFM_CRYPTO_GENERATOR_OPER_NUM (1)
+#endif
+
+/**
+ * \def TFM_CRYPTO_OPER_HANDLE_INDEX_BITS
+ *
+ * \brief Number of bits of an operation handle which hold the index of the
+ *        operation context, plus one. The remaining bits hold the generation
+ *        of the context, which is incremented each time the context is
+ *        released, so that stale handles are rejected
+ */
+#define TFM_CRYPTO_OPER_HANDLE_INDEX_BITS (16u)
+#define TFM_CRYPTO_OPER_HANDLE_INDEX_MASK \
+    ((1u << TFM_CRYPTO_OPER_HANDLE_INDEX_BITS) - 1u)
+#define TFM_CRYPTO_OPER_HANDLE_GEN_MASK \
+    (0xFFFFFFFFu >> TFM_CRYPTO_OPER_HANDLE_INDEX_BITS)
+
+#if (TFM_CRYPTO_CONC_OPER_NUM >= TFM_CRYPTO_OPER_HANDLE_INDEX_MASK)
+#error "TFM_CRYPTO_CONC_OPER_NUM is too large to be encoded in a handle"
+#endif
+
+/**
+ * \brief Value of the free list links which marks the end of the list
+ */
+#define TFM_CRYPTO_OPER_FREE_LIST_END (TFM_CRYPTO_CONC_OPER_NUM)
+
 struct tfm_crypto_operation_s {
     uint32_t in_use;                /*!< Indicates if the operation is in use */
     int32_t owner;                  /*!< Indicates an ID of the owner of
                                      *   the context
                                      */
     enum tfm_crypto_operation_type type; /*!< Type of the operation */
-    union {
-        psa_cipher_operation_t cipher;    /*!< Cipher operation context */
-        psa_mac_operation_t mac;          /*!< MAC operation context */
-        psa_hash_operation_t hash;        /*!< Hash operation context */
-        psa_crypto_generator_t generator; /*!< Generator operation context */
-    } operation;
+    uint32_t generation;            /*!< Generation of the context, encoded
+                                     *   in the handle
+                                     */
+    uint32_t next_free;             /*!< Index of the next context in the
+                                     *   free list
+                                     */
+    void *ctx;                      /*!< Backend context, allocated from the
+                                     *   pool of the operation type
+                                     */
 };
 
+/*
+ * Each operation type has its own pool of backend contexts, so that each
+ * context is only as large as the type needs and the number of contexts
+ * can be tuned per type.
+ */
+#ifndef TFM_CRYPTO_CIPHER_MODULE_DISABLED
+TFM_POOL_DECLARE(cipher_pool, sizeof(psa_cipher_operation_t),
+                 TFM_CRYPTO_CIPHER_OPER_NUM);
+#endif
+#ifndef TFM_CRYPTO_MAC_MODULE_DISABLED
+TFM_POOL_DECLARE(mac_pool, sizeof(psa_mac_operation_t),
+                 TFM_CRYPTO_MAC_OPER_NUM);
+#endif
+#ifndef TFM_CRYPTO_HASH_MODULE_DISABLED
+TFM_POOL_DECLARE(hash_pool, sizeof(psa_hash_operation_t),
+                 TFM_CRYPTO_HASH_OPER_NUM);
+#endif
+#ifndef TFM_CRYPTO_GENERATOR_MODULE_DISABLED
+TFM_POOL_DECLARE(generator_pool, sizeof(psa_crypto_generator_t),
+                 TFM_CRYPTO_GENERATOR_OPER_NUM);
+#endif
+
 static struct tfm_crypto_operation_s operation[TFM_CRYPTO_CONC_OPER_NUM] ={{0}};
 
 /*
- * \brief Function used to clear the memory associated to a backend context
+ * \brief Index of the first context in the free list
+ */
+static uint32_t free_head = TFM_CRYPTO_OPER_FREE_LIST_END;
+
+/*
+ * \brief Function used to get the index in the database of the backend
+ *        contexts which corresponds to a handle
  *
- * \param[in] index Numerical index in the database of the backend contexts
+ * \param[in] handle Handle of the context
+ * \param[in] owner  ID of the partition requesting the context
  *
- * \return None
+ * \return The index of the context if the handle refers to a context in use,
+ *         owned by the requesting partition, TFM_CRYPTO_CONC_OPER_NUM
+ *         otherwise
  *
  */
-static void memset_operation_context(uint32_t index)
+static uint32_t handle_to_index(uint32_t handle, int32_t owner)
 {
-    uint32_t mem_size;
+    uint32_t index = (handle & TFM_CRYPTO_OPER_HANDLE_INDEX_MASK) - 1;
+    uint32_t generation = handle >> TFM_CRYPTO_OPER_HANDLE_INDEX_BITS;
 
-    uint8_t *mem_ptr = (uint8_t *) &(operation[index].operation);
+    /* An invalid handle underflows to an out of range index */
+    if ((index >= TFM_CRYPTO_CONC_OPER_NUM) ||
+        (operation[index].in_use != TFM_CRYPTO_IN_USE) ||
+        (operation[index].generation != generation) ||
+        (operation[index].owner != owner)) {
+        return TFM_CRYPTO_CONC_OPER_NUM;
+    }
+
+    return index;
+}
 
-    switch(operation[index].type) {
+/*
+ * \brief Function used to get the pool of backend contexts of an operation
+ *        type
+ *
+ * \param[in] type Type of the operation
+ *
+ * \return The pool of the operation type, NULL if the type is not supported
+ *
+ */
+static struct tfm_pool_instance_t *get_operation_pool(
+                                        enum tfm_crypto_operation_type type)
+{
+    switch(type) {
+#ifndef TFM_CRYPTO_CIPHER_MODULE_DISABLED
     case TFM_CRYPTO_CIPHER_OPERATION:
-        mem_size = sizeof(psa_cipher_operation_t);
-        break;
+        return cipher_pool;
+#endif
+#ifndef TFM_CRYPTO_MAC_MODULE_DISABLED
     case TFM_CRYPTO_MAC_OPERATION:
-        mem_size = sizeof(psa_mac_operation_t);
-        break;
+        return mac_pool;
+#endif
+#ifndef TFM_CRYPTO_HASH_MODULE_DISABLED
     case TFM_CRYPTO_HASH_OPERATION:
-        mem_size = sizeof(psa_hash_operation_t);
-        break;
+        return hash_pool;
+#endif
+#ifndef TFM_CRYPTO_GENERATOR_MODULE_DISABLED
     case TFM_CRYPTO_GENERATOR_OPERATION:
-        mem_size = sizeof(psa_crypto_generator_t);
-        break;
+        return generator_pool;
+#endif
     case TFM_CRYPTO_OPERATION_NONE:
     default:
-        mem_size = 0;
-        break;
+        return NULL;
     }
-
-    /* Clear the contents of the backend context */
-    (void)tfm_memset(mem_ptr, 0, mem_size);
 }
 
 /*!
@@ -86,8 +218,47 @@ static void memset_operation_context(uint32_t index)
 /*!@{*/
 psa_status_t tfm_crypto_init_alloc(void)
 {
+    uint32_t i;
+
     /* Clear the contents of the local contexts */
     (void)tfm_memset(operation, 0, sizeof(operation));
+
+    /* Initialise the pools of backend contexts */
+#ifndef TFM_CRYPTO_CIPHER_MODULE_DISABLED
+    if (tfm_pool_init(cipher_pool, POOL_BUFFER_SIZE(cipher_pool),
+                      sizeof(psa_cipher_operation_t),
+                      TFM_CRYPTO_CIPHER_OPER_NUM) != IPC_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+#endif
+#ifndef TFM_CRYPTO_MAC_MODULE_DISABLED
+    if (tfm_pool_init(mac_pool, POOL_BUFFER_SIZE(mac_pool),
+                      sizeof(psa_mac_operation_t),
+                      TFM_CRYPTO_MAC_OPER_NUM) != IPC_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+#endif
+#ifndef TFM_CRYPTO_HASH_MODULE_DISABLED
+    if (tfm_pool_init(hash_pool, POOL_BUFFER_SIZE(hash_pool),
+                      sizeof(psa_hash_operation_t),
+                      TFM_CRYPTO_HASH_OPER_NUM) != IPC_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+#endif
+#ifndef TFM_CRYPTO_GENERATOR_MODULE_DISABLED
+    if (tfm_pool_init(generator_pool, POOL_BUFFER_SIZE(generator_pool),
+                      sizeof(psa_crypto_generator_t),
+                      TFM_CRYPTO_GENERATOR_OPER_NUM) != IPC_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+#endif
+
+    /* Chain all the contexts in the free list */
+    for (i = 0; i < TFM_CRYPTO_CONC_OPER_NUM; i++) {
+        operation[i].next_free = i + 1;
+    }
+    free_head = 0;
+
     return PSA_SUCCESS;
 }
 
@@ -97,6 +268,8 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
 {
     uint32_t i = 0;
     int32_t partition_id = 0;
+    struct tfm_pool_instance_t *pool;
+    void *op_ctx;
     psa_status_t status;
 
     status = tfm_crypto_get_caller_id(&partition_id);
@@ -115,23 +288,36 @@ psa_status_t tfm_crypto_operation_alloc(enum tfm_crypto_operation_type type,
     }
     *ctx = NULL;
 
-    for (i=0; i<TFM_CRYPTO_CONC_OPER_NUM; i++) {
-        if (operation[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            operation[i].in_use = TFM_CRYPTO_IN_USE;
-            operation[i].owner = partition_id;
-            operation[i].type = type;
-            *handle = i + 1;
-            *ctx = (void *) &(operation[i].operation);
-            return PSA_SUCCESS;
-        }
+    pool = get_operation_pool(type);
+    if (pool == NULL) {
+        return PSA_ERROR_NOT_SUPPORTED;
+    }
+
+    if (free_head == TFM_CRYPTO_OPER_FREE_LIST_END) {
+        return PSA_ERROR_NOT_PERMITTED;
     }
 
-    return PSA_ERROR_NOT_PERMITTED;
+    op_ctx = tfm_pool_alloc(pool);
+    if (op_ctx == NULL) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+    i = free_head;
+    free_head = operation[i].next_free;
+
+    operation[i].in_use = TFM_CRYPTO_IN_USE;
+    operation[i].owner = partition_id;
+    operation[i].type = type;
+    operation[i].ctx = op_ctx;
+    *handle = (operation[i].generation << TFM_CRYPTO_OPER_HANDLE_INDEX_BITS) |
+              (i + 1);
+    *ctx = op_ctx;
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_release(uint32_t *handle)
 {
-    uint32_t h_val = *handle;
+    uint32_t index;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -140,26 +326,37 @@ psa_status_t tfm_crypto_operation_release(uint32_t *handle)
         return status;
     }
 
-    if ( (h_val != TFM_CRYPTO_INVALID_HANDLE) &&
-         (h_val <= TFM_CRYPTO_CONC_OPER_NUM) &&
-         (operation[h_val - 1].in_use == TFM_CRYPTO_IN_USE) &&
-         (operation[h_val - 1].owner == partition_id)) {
-
-        memset_operation_context(h_val - 1);
-        operation[h_val - 1].in_use = TFM_CRYPTO_NOT_IN_USE;
-        operation[h_val - 1].type = TFM_CRYPTO_OPERATION_NONE;
-        operation[h_val - 1].owner = 0;
-        *handle = TFM_CRYPTO_INVALID_HANDLE;
-        return PSA_SUCCESS;
+    index = handle_to_index(*handle, partition_id);
+    if (index == TFM_CRYPTO_CONC_OPER_NUM) {
+        return PSA_ERROR_INVALID_ARGUMENT;
     }
 
-    return PSA_ERROR_INVALID_ARGUMENT;
+    /* Clear the contents of the backend context and return it to its pool */
+    (void)tfm_memset(operation[index].ctx, 0,
+                     get_operation_pool(operation[index].type)->chunksz);
+    tfm_pool_free(operation[index].ctx);
+
+    operation[index].ctx = NULL;
+    operation[index].in_use = TFM_CRYPTO_NOT_IN_USE;
+    operation[index].type = TFM_CRYPTO_OPERATION_NONE;
+    operation[index].owner = 0;
+
+    /* Invalidate any outstanding copy of the handle */
+    operation[index].generation = (operation[index].generation + 1) &
+                                  TFM_CRYPTO_OPER_HANDLE_GEN_MASK;
+
+    operation[index].next_free = free_head;
+    free_head = index;
+
+    *handle = TFM_CRYPTO_INVALID_HANDLE;
+    return PSA_SUCCESS;
 }
 
 psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
                                          uint32_t handle,
                                          void **ctx)
 {
+    uint32_t index;
     int32_t partition_id = 0;
     psa_status_t status;
 
@@ -168,16 +365,13 @@ psa_status_t tfm_crypto_operation_lookup(enum tfm_crypto_operation_type type,
         return status;
     }
 
-    if ( (handle != TFM_CRYPTO_INVALID_HANDLE) &&
-         (handle <= TFM_CRYPTO_CONC_OPER_NUM) &&
-         (operation[handle - 1].in_use == TFM_CRYPTO_IN_USE) &&
-         (operation[handle - 1].type == type) &&
-         (operation[handle - 1].owner == partition_id)) {
-
-        *ctx = (void *) &(operation[handle - 1].operation);
-        return PSA_SUCCESS;
+    index = handle_to_index(handle, partition_id);
+    if ((index == TFM_CRYPTO_CONC_OPER_NUM) ||
+        (operation[index].type != type)) {
+        return PSA_ERROR_BAD_STATE;
     }
 
-    return PSA_ERROR_BAD_STATE;
+    *ctx = operation[index].ctx;
+    return PSA_SUCCESS;
 }
 /*!@}*/
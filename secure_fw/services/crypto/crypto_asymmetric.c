@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -47,7 +47,7 @@ psa_status_t tfm_crypto_asymmetric_sign(psa_invec in_vec[],
     size_t hash_length = in_vec[1].len;
     uint8_t *signature = out_vec[0].base;
     size_t signature_size = out_vec[0].len;
-    psa_status_t status = tfm_crypto_check_handle_owner(handle, NULL);
+    psa_status_t status = tfm_crypto_get_engine_key_handle(handle, &handle);
 
     if (status != PSA_SUCCESS) {
         return status;
@@ -81,7 +81,7 @@ psa_status_t tfm_crypto_asymmetric_verify(psa_invec in_vec[],
     size_t hash_length = in_vec[1].len;
     const uint8_t *signature = in_vec[2].base;
     size_t signature_length = in_vec[2].len;
-    psa_status_t status = tfm_crypto_check_handle_owner(handle, NULL);
+    psa_status_t status = tfm_crypto_get_engine_key_handle(handle, &handle);
 
     if (status != PSA_SUCCESS) {
         return status;
@@ -127,7 +127,7 @@ psa_status_t tfm_crypto_asymmetric_encrypt(psa_invec in_vec[],
         salt_length = in_vec[2].len;
     }
 
-    status = tfm_crypto_check_handle_owner(handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(handle, &handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -180,7 +180,7 @@ psa_status_t tfm_crypto_asymmetric_decrypt(psa_invec in_vec[],
         salt_length = in_vec[2].len;
     }
 
-    status = tfm_crypto_check_handle_owner(handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(handle, &handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
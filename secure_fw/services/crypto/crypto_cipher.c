@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -146,7 +146,7 @@ psa_status_t tfm_crypto_cipher_encrypt_setup(psa_invec in_vec[],
     psa_key_handle_t key_handle = iov->key_handle;
     psa_algorithm_t alg = iov->alg;
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -197,7 +197,7 @@ psa_status_t tfm_crypto_cipher_decrypt_setup(psa_invec in_vec[],
     psa_key_handle_t key_handle = iov->key_handle;
     psa_algorithm_t alg = iov->alg;
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
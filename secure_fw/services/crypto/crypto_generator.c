@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -229,7 +229,7 @@ psa_status_t tfm_crypto_generator_import_key(psa_invec in_vec[],
     size_t bits = *(size_t *)(in_vec[1].base);
     psa_crypto_generator_t *generator = NULL;
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -336,7 +336,7 @@ psa_status_t tfm_crypto_key_derivation(psa_invec in_vec[],
         label_length = in_vec[2].len;
     }
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -402,7 +402,7 @@ psa_status_t tfm_crypto_key_agreement(psa_invec in_vec[],
     size_t peer_key_length = in_vec[1].len;
     psa_crypto_generator_t *generator = NULL;
 
-    status = tfm_crypto_check_handle_owner(private_key, NULL);
+    status = tfm_crypto_get_engine_key_handle(private_key, &private_key);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -474,7 +474,7 @@ psa_status_t tfm_crypto_generate_key(psa_invec in_vec[],
     size_t extra_size = 0;
     psa_status_t status;
 
-    status = tfm_crypto_check_handle_owner(key_handle, NULL);
+    status = tfm_crypto_get_engine_key_handle(key_handle, &key_handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -1,10 +1,12 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
  */
 
+#include <stdbool.h>
+
 #include "tfm_mbedcrypto_include.h"
 
 #include "tfm_crypto_api.h"
@@ -58,6 +60,27 @@ LIST_TFM_CRYPTO_UNIFORM_SIGNATURE_API
 #define TFM_CRYPTO_IOVEC_BUFFER_SIZE (5120)
 #endif
 
+/**
+ * \brief Default size of the chunks used to stream the input of hash, MAC and
+ *        cipher update requests which do not fit in the internal scratch
+ */
+#ifndef TFM_CRYPTO_IOVEC_CHUNK_SIZE
+#define TFM_CRYPTO_IOVEC_CHUNK_SIZE (TFM_CRYPTO_IOVEC_BUFFER_SIZE / 4)
+#endif
+
+/**
+ * \brief Size of the output window used when streaming a cipher update. The
+ *        output of a chunk can include a block buffered from a previous chunk.
+ */
+#define TFM_CRYPTO_IOVEC_CHUNK_OUT_SIZE \
+    (TFM_CRYPTO_IOVEC_CHUNK_SIZE + PSA_MAX_BLOCK_CIPHER_BLOCK_SIZE)
+
+#if (ALIGN(TFM_CRYPTO_IOVEC_CHUNK_SIZE, TFM_CRYPTO_IOVEC_ALIGNMENT) + \
+     ALIGN(TFM_CRYPTO_IOVEC_CHUNK_OUT_SIZE, TFM_CRYPTO_IOVEC_ALIGNMENT) + \
+     TFM_CRYPTO_IOVEC_ALIGNMENT) > TFM_CRYPTO_IOVEC_BUFFER_SIZE
+#error "TFM_CRYPTO_IOVEC_CHUNK_SIZE is too big for TFM_CRYPTO_IOVEC_BUFFER_SIZE"
+#endif
+
 /**
  * \brief Internal scratch used for IOVec allocations
  *
@@ -101,13 +124,192 @@ static psa_status_t tfm_crypto_alloc_scratch(size_t requested_size, void **buf)
 
 static psa_status_t tfm_crypto_clear_scratch(void)
 {
+    /* Allocations grow upwards from the start of the scratch, so alloc_index
+     * is the high-water mark of the data written since the last clear. The
+     * space past it is still clear and does not need to be wiped again.
+     */
+    (void)tfm_memset(scratch.buf, 0, scratch.alloc_index);
     scratch.alloc_index = 0;
     scratch.owner = 0;
-    (void)tfm_memset(scratch.buf, 0, sizeof(scratch.buf));
 
     return PSA_SUCCESS;
 }
 
+#ifdef TFM_MM_IOVEC
+/**
+ * \brief Checks if the input of a request can be read in place from the client
+ *        memory
+ *
+ * \details A mapped input vector stays in client memory, so the client can
+ *          change it while it is processed. Only the data of hash and MAC
+ *          updates is mapped, as it is read once and its only effect is on
+ *          the digest or MAC returned to the same client. The output of all
+ *          requests goes through the internal scratch, so that the client
+ *          never sees the intermediate results of an operation, such as the
+ *          plaintext of an AEAD decryption which fails verification.
+ *
+ * \param[in] sfn_id  Secure function ID of the request
+ *
+ * \return true if the input can be mapped, false otherwise
+ */
+static bool tfm_crypto_can_map_input(const uint32_t sfn_id)
+{
+    return (sfn_id == TFM_CRYPTO_HASH_UPDATE_SID) ||
+           (sfn_id == TFM_CRYPTO_MAC_UPDATE_SID);
+}
+#endif /* TFM_MM_IOVEC */
+
+/**
+ * \brief Checks if a request has to be streamed through the internal scratch
+ *        in chunks, because its IOVecs do not fit in it at once
+ *
+ * \details Only hash, MAC and cipher updates can be split, as processing their
+ *          input in several calls gives the same result as in a single one.
+ *
+ * \param[in] msg     Request message
+ * \param[in] sfn_id  Secure function ID of the request
+ * \param[in] in_len  Number of input vectors in the request
+ * \param[in] out_len Number of output vectors in the request
+ *
+ * \return true if the request has to be streamed, false otherwise
+ */
+static bool tfm_crypto_needs_chunking(const psa_msg_t *msg,
+                                      const uint32_t sfn_id,
+                                      size_t in_len,
+                                      size_t out_len)
+{
+    size_t i, required = 0;
+
+    if ((sfn_id != TFM_CRYPTO_HASH_UPDATE_SID) &&
+        (sfn_id != TFM_CRYPTO_MAC_UPDATE_SID) &&
+        (sfn_id != TFM_CRYPTO_CIPHER_UPDATE_SID)) {
+        return false;
+    }
+
+    /* The data to stream is always in the second input vector */
+    if (in_len != 2) {
+        return false;
+    }
+
+    for (i = 1; i < in_len; i++) {
+        required += ALIGN(msg->in_size[i], TFM_CRYPTO_IOVEC_ALIGNMENT);
+    }
+    for (i = 0; i < out_len; i++) {
+        required += ALIGN(msg->out_size[i], TFM_CRYPTO_IOVEC_ALIGNMENT);
+    }
+
+    if (required <= sizeof(scratch.buf)) {
+        return false;
+    }
+
+#ifdef TFM_MM_IOVEC
+    /* A mapped input does not need the scratch, mapping has no side effect */
+    if (tfm_crypto_can_map_input(sfn_id) &&
+        (psa_map_invec(msg->handle, 1) != NULL)) {
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+/**
+ * \brief Calls a hash, MAC or cipher update function once for each chunk of
+ *        the input, reading the input into and writing the output from a
+ *        window of the internal scratch
+ *
+ * \param[in] msg     Request message
+ * \param[in] iov     IOV read when parsing the request
+ * \param[in] sfn_id  Secure function ID of the request
+ * \param[in] out_len Number of output vectors in the request
+ *
+ * \note If a chunk fails, the output of the previous chunks has already been
+ *       written to the client. The content of the output vector is undefined
+ *       when an error is returned.
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+static psa_status_t tfm_crypto_call_sfn_chunked(psa_msg_t *msg,
+                                              struct tfm_crypto_pack_iovec *iov,
+                                              const uint32_t sfn_id,
+                                              size_t out_len)
+{
+    psa_status_t status = PSA_SUCCESS;
+    psa_invec in_vec[2] = { {0} };
+    psa_outvec out_vec[2] = { {0} };
+    void *handle_buf = NULL, *in_buf = NULL, *out_buf = NULL;
+    size_t remaining = msg->in_size[1];
+    size_t out_written = 0, chunk_size;
+
+    if (out_len > 2) {
+        return PSA_ERROR_CONNECTION_REFUSED;
+    }
+
+    /* The first output vector holds the operation handle */
+    status = tfm_crypto_alloc_scratch(msg->out_size[0], &handle_buf);
+    if (status == PSA_SUCCESS) {
+        status = tfm_crypto_alloc_scratch(TFM_CRYPTO_IOVEC_CHUNK_SIZE,
+                                          &in_buf);
+    }
+    if ((status == PSA_SUCCESS) && (out_len == 2)) {
+        status = tfm_crypto_alloc_scratch(TFM_CRYPTO_IOVEC_CHUNK_OUT_SIZE,
+                                          &out_buf);
+    }
+    if (status != PSA_SUCCESS) {
+        (void)tfm_crypto_clear_scratch();
+        return status;
+    }
+
+    /* Set the owner of the data in the scratch */
+    (void)tfm_crypto_set_scratch_owner(msg->client_id);
+
+    in_vec[0].base = iov;
+    in_vec[0].len = sizeof(struct tfm_crypto_pack_iovec);
+
+    while (remaining > 0) {
+        chunk_size = (remaining < TFM_CRYPTO_IOVEC_CHUNK_SIZE) ?
+                     remaining : TFM_CRYPTO_IOVEC_CHUNK_SIZE;
+
+        /* Read the next chunk, psa_read keeps track of the client offset */
+        in_vec[1].base = in_buf;
+        in_vec[1].len = psa_read(msg->handle, 1, in_buf, chunk_size);
+
+        out_vec[0].base = handle_buf;
+        out_vec[0].len = msg->out_size[0];
+        if (out_len == 2) {
+            out_vec[1].base = out_buf;
+            out_vec[1].len = msg->out_size[1] - out_written;
+            if (out_vec[1].len > TFM_CRYPTO_IOVEC_CHUNK_OUT_SIZE) {
+                out_vec[1].len = TFM_CRYPTO_IOVEC_CHUNK_OUT_SIZE;
+            }
+        }
+
+        status = sfid_func_table[sfn_id](in_vec, 2, out_vec, out_len);
+
+        /* The operation has been released on error, stop here */
+        if (status != PSA_SUCCESS) {
+            break;
+        }
+
+        if (out_len == 2) {
+            /* psa_write appends to what has been written already */
+            psa_write(msg->handle, 1, out_vec[1].base, out_vec[1].len);
+            out_written += out_vec[1].len;
+        }
+
+        remaining -= in_vec[1].len;
+    }
+
+    psa_write(msg->handle, 0, out_vec[0].base, out_vec[0].len);
+
+    /* Clear the allocated internal scratch before returning */
+    if (tfm_crypto_clear_scratch() != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    return status;
+}
+
 static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
                                         struct tfm_crypto_pack_iovec *iov,
                                         const uint32_t sfn_id)
@@ -127,12 +329,33 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
     if (in_len < 1) {
         return PSA_ERROR_GENERIC_ERROR;
     }
+
+    /* Check the number of out_vec filled */
+    while ((out_len > 0) && (msg->out_size[out_len - 1] == 0)) {
+        out_len--;
+    }
+
+    /* Stream the requests which would not fit in the scratch otherwise */
+    if (tfm_crypto_needs_chunking(msg, sfn_id, in_len, out_len)) {
+        return tfm_crypto_call_sfn_chunked(msg, iov, sfn_id, out_len);
+    }
+
     /* Initialise the first iovec with the IOV read when parsing */
     in_vec[0].base = iov;
     in_vec[0].len = sizeof(struct tfm_crypto_pack_iovec);
 
     /* Alloc/read from the second element as the first is read when parsing */
     for (i = 1; i < in_len; i++) {
+#ifdef TFM_MM_IOVEC
+        /* Access the client memory directly if the SPM allows it */
+        if (tfm_crypto_can_map_input(sfn_id)) {
+            in_vec[i].base = psa_map_invec(msg->handle, i);
+            if (in_vec[i].base != NULL) {
+                in_vec[i].len = msg->in_size[i];
+                continue;
+            }
+        }
+#endif
         /* Allocate necessary space in the internal scratch */
         status = tfm_crypto_alloc_scratch(msg->in_size[i], &alloc_buf_ptr);
         if (status != PSA_SUCCESS) {
@@ -146,11 +369,6 @@ static psa_status_t tfm_crypto_call_sfn(psa_msg_t *msg,
         in_vec[i].len = msg->in_size[i];
     }
 
-    /* Check the number of out_vec filled */
-    while ((out_len > 0) && (msg->out_size[out_len - 1] == 0)) {
-        out_len--;
-    }
-
     for (i = 0; i < out_len; i++) {
         /* Allocate necessary space for the output in the internal scratch */
         status = tfm_crypto_alloc_scratch(msg->out_size[i], &alloc_buf_ptr);
@@ -301,8 +519,16 @@ static psa_status_t tfm_crypto_engine_init(void)
 
 static psa_status_t tfm_crypto_module_init(void)
 {
+    psa_status_t status;
+
     /* Init the Alloc module */
-    return tfm_crypto_init_alloc();
+    status = tfm_crypto_init_alloc();
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    /* Init the Key module */
+    return tfm_crypto_init_key();
 }
 
 psa_status_t tfm_crypto_get_caller_id(int32_t *id)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -22,16 +22,94 @@
 #ifndef TFM_CRYPTO_MAX_KEY_HANDLES
 #define TFM_CRYPTO_MAX_KEY_HANDLES (16)
 #endif
+
+/**
+ * \brief Number of bits of a key handle returned to the clients which hold the
+ *        index of the entry in the handle owner table, plus one. The remaining
+ *        bits hold the generation of the entry, which is incremented each time
+ *        the entry is released, so that stale handles are rejected.
+ */
+#define TFM_CRYPTO_KEY_HANDLE_INDEX_BITS (10u)
+#define TFM_CRYPTO_KEY_HANDLE_INDEX_MASK \
+    ((1u << TFM_CRYPTO_KEY_HANDLE_INDEX_BITS) - 1u)
+#define TFM_CRYPTO_KEY_HANDLE_GEN_MASK \
+    ((1u << ((8u * sizeof(psa_key_handle_t)) - \
+             TFM_CRYPTO_KEY_HANDLE_INDEX_BITS)) - 1u)
+
+#if (TFM_CRYPTO_MAX_KEY_HANDLES >= TFM_CRYPTO_KEY_HANDLE_INDEX_MASK)
+#error "TFM_CRYPTO_MAX_KEY_HANDLES is too large to be encoded in a key handle"
+#endif
+
+/**
+ * \brief Value of the free list links which marks the end of the list
+ */
+#define TFM_CRYPTO_KEY_FREE_LIST_END (TFM_CRYPTO_MAX_KEY_HANDLES)
+
 struct tfm_crypto_handle_owner_s {
     int32_t owner;           /*!< Owner of the allocated handle */
-    psa_key_handle_t handle; /*!< Allocated handle */
+    psa_key_handle_t handle; /*!< Allocated handle in the crypto engine */
     uint8_t in_use;          /*!< Flag to indicate if this in use */
+    uint16_t generation;     /*!< Generation of the entry, encoded in the
+                              *   handle returned to the client
+                              */
+    uint16_t next_free;      /*!< Index of the next entry in the free list */
 };
 
 #ifndef TFM_CRYPTO_KEY_MODULE_DISABLED
 static struct tfm_crypto_handle_owner_s
                                  handle_owner[TFM_CRYPTO_MAX_KEY_HANDLES] = {0};
-#endif
+
+/**
+ * \brief Index of the first entry in the free list
+ */
+static uint32_t free_head = TFM_CRYPTO_KEY_FREE_LIST_END;
+
+/**
+ * \brief Takes the first entry from the free list and assigns it to a key
+ *
+ * \note The caller must check that the free list is not empty.
+ *
+ * \param[in] owner         Owner of the key
+ * \param[in] engine_handle Handle to the key in the crypto engine
+ *
+ * \return The key handle to be returned to the client
+ */
+static psa_key_handle_t tfm_crypto_handle_owner_acquire(
+                                                int32_t owner,
+                                                psa_key_handle_t engine_handle)
+{
+    uint32_t i = free_head;
+
+    free_head = handle_owner[i].next_free;
+
+    handle_owner[i].owner = owner;
+    handle_owner[i].handle = engine_handle;
+    handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+
+    return (psa_key_handle_t)(
+          ((uint32_t)handle_owner[i].generation << TFM_CRYPTO_KEY_HANDLE_INDEX_BITS)
+        | (i + 1));
+}
+
+/**
+ * \brief Releases an entry of the handle owner table to the free list
+ *
+ * \param[in] index Index of the entry to release
+ */
+static void tfm_crypto_handle_owner_release(uint32_t index)
+{
+    handle_owner[index].owner = 0;
+    handle_owner[index].handle = 0;
+    handle_owner[index].in_use = TFM_CRYPTO_NOT_IN_USE;
+
+    /* Invalidate any outstanding copy of the handle */
+    handle_owner[index].generation = (handle_owner[index].generation + 1) &
+                                     TFM_CRYPTO_KEY_HANDLE_GEN_MASK;
+
+    handle_owner[index].next_free = free_head;
+    free_head = index;
+}
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 
 /**
  * \brief Open a handle to the hardware unique key (HUK).
@@ -50,7 +128,7 @@ static psa_status_t tfm_crypto_open_huk(psa_key_lifetime_t lifetime,
 {
     psa_status_t status;
     int32_t partition_id;
-    uint32_t i;
+    psa_key_handle_t engine_handle;
     psa_key_policy_t huk_policy = PSA_KEY_POLICY_INIT;
 
     /* The HUK has a persistent lifetime */
@@ -58,13 +136,7 @@ static psa_status_t tfm_crypto_open_huk(psa_key_lifetime_t lifetime,
         return PSA_ERROR_INVALID_ARGUMENT;
     }
 
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            break;
-        }
-    }
-
-    if (i == TFM_CRYPTO_MAX_KEY_HANDLES) {
+    if (free_head == TFM_CRYPTO_KEY_FREE_LIST_END) {
         return PSA_ERROR_INSUFFICIENT_MEMORY;
     }
 
@@ -74,7 +146,7 @@ static psa_status_t tfm_crypto_open_huk(psa_key_lifetime_t lifetime,
     }
 
     /* Allocate a transient key to get a valid key handle */
-    status = psa_allocate_key(key_handle);
+    status = psa_allocate_key(&engine_handle);
     if (status != PSA_SUCCESS) {
         return status;
     }
@@ -82,18 +154,17 @@ static psa_status_t tfm_crypto_open_huk(psa_key_lifetime_t lifetime,
     /* The HUK can only be used to derive other keys */
     huk_policy.usage = PSA_KEY_USAGE_DERIVE;
     huk_policy.alg = TFM_CRYPTO_ALG_HUK_DERIVATION;
-    status = psa_set_key_policy(*key_handle, &huk_policy);
+    status = psa_set_key_policy(engine_handle, &huk_policy);
     if (status != PSA_SUCCESS) {
         return status;
     }
 
     /* Import zero data to the HUK handle to prevent further modification */
-    status = psa_import_key(*key_handle, PSA_KEY_TYPE_RAW_DATA, NULL, 0);
+    status = psa_import_key(engine_handle, PSA_KEY_TYPE_RAW_DATA, NULL, 0);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[i].owner = partition_id;
-        handle_owner[i].handle = *key_handle;
-        handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+        *key_handle = tfm_crypto_handle_owner_acquire(partition_id,
+                                                      engine_handle);
     }
 
     return status;
@@ -106,6 +177,21 @@ static psa_status_t tfm_crypto_open_huk(psa_key_lifetime_t lifetime,
  */
 
 /*!@{*/
+psa_status_t tfm_crypto_init_key(void)
+{
+#ifndef TFM_CRYPTO_KEY_MODULE_DISABLED
+    uint32_t i;
+
+    /* Chain all the entries in the free list */
+    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
+        handle_owner[i].next_free = i + 1;
+    }
+    free_head = 0;
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+
+    return PSA_SUCCESS;
+}
+
 psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
                                            uint32_t *index)
 {
@@ -113,7 +199,8 @@ psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
     return PSA_ERROR_NOT_SUPPORTED;
 #else
     int32_t partition_id = 0;
-    uint32_t i = 0;
+    uint32_t i = (handle & TFM_CRYPTO_KEY_HANDLE_INDEX_MASK) - 1;
+    uint32_t generation = (uint32_t)handle >> TFM_CRYPTO_KEY_HANDLE_INDEX_BITS;
     psa_status_t status;
 
     status = tfm_crypto_get_caller_id(&partition_id);
@@ -121,20 +208,39 @@ psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
         return status;
     }
 
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use && handle_owner[i].handle == handle) {
-            if (handle_owner[i].owner == partition_id) {
-                if (index != NULL) {
-                    *index = i;
-                }
-                return PSA_SUCCESS;
-            } else {
-                return PSA_ERROR_NOT_PERMITTED;
-            }
-        }
-    }
-
-    return PSA_ERROR_INVALID_HANDLE;
+    /* An invalid handle underflows to an out of range index */
+    if ((i >= TFM_CRYPTO_MAX_KEY_HANDLES) ||
+        (handle_owner[i].in_use != TFM_CRYPTO_IN_USE) ||
+        (handle_owner[i].generation != generation)) {
+        return PSA_ERROR_INVALID_HANDLE;
+    }
+
+    if (handle_owner[i].owner != partition_id) {
+        return PSA_ERROR_NOT_PERMITTED;
+    }
+
+    if (index != NULL) {
+        *index = i;
+    }
+
+    return PSA_SUCCESS;
+#endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
+}
+
+psa_status_t tfm_crypto_get_engine_key_handle(psa_key_handle_t handle,
+                                              psa_key_handle_t *engine_handle)
+{
+#ifdef TFM_CRYPTO_KEY_MODULE_DISABLED
+    return PSA_ERROR_NOT_SUPPORTED;
+#else
+    uint32_t index;
+    psa_status_t status = tfm_crypto_check_handle_owner(handle, &index);
+
+    if (status == PSA_SUCCESS) {
+        *engine_handle = handle_owner[index].handle;
+    }
+
+    return status;
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
 }
 
@@ -156,19 +262,11 @@ psa_status_t tfm_crypto_allocate_key(psa_invec in_vec[],
     }
 
     psa_key_handle_t *key_handle = out_vec[0].base;
-    uint32_t i = 0;
+    psa_key_handle_t engine_handle;
     int32_t partition_id = 0;
-    bool empty_found = false;
     psa_status_t status;
 
-    for (i = 0; i < TFM_CRYPTO_MAX_KEY_HANDLES; i++) {
-        if (handle_owner[i].in_use == TFM_CRYPTO_NOT_IN_USE) {
-            empty_found = true;
-            break;
-        }
-    }
-
-    if (!empty_found) {
+    if (free_head == TFM_CRYPTO_KEY_FREE_LIST_END) {
         return PSA_ERROR_INSUFFICIENT_MEMORY;
     }
 
@@ -177,12 +275,11 @@ psa_status_t tfm_crypto_allocate_key(psa_invec in_vec[],
         return status;
     }
 
-    status = psa_allocate_key(key_handle);
+    status = psa_allocate_key(&engine_handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[i].owner = partition_id;
-        handle_owner[i].handle = *key_handle;
-        handle_owner[i].in_use = TFM_CRYPTO_IN_USE;
+        *key_handle = tfm_crypto_handle_owner_acquire(partition_id,
+                                                      engine_handle);
     }
 
     return status;
@@ -250,12 +347,10 @@ psa_status_t tfm_crypto_close_key(psa_invec in_vec[],
         return status;
     }
 
-    status = psa_close_key(key);
+    status = psa_close_key(handle_owner[index].handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[index].owner = 0;
-        handle_owner[index].handle = 0;
-        handle_owner[index].in_use = TFM_CRYPTO_NOT_IN_USE;
+        tfm_crypto_handle_owner_release(index);
     }
 
     return status;
@@ -285,7 +380,7 @@ psa_status_t tfm_crypto_import_key(psa_invec in_vec[],
     psa_key_type_t type = iov->type;
     const uint8_t *data = in_vec[1].base;
     size_t data_length = in_vec[1].len;
-    psa_status_t status = tfm_crypto_check_handle_owner(key, NULL);
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
 
     if (status != PSA_SUCCESS) {
         return status;
@@ -322,12 +417,10 @@ psa_status_t tfm_crypto_destroy_key(psa_invec in_vec[],
         return status;
     }
 
-    status = psa_destroy_key(key);
+    status = psa_destroy_key(handle_owner[index].handle);
 
     if (status == PSA_SUCCESS) {
-        handle_owner[index].owner = 0;
-        handle_owner[index].handle = 0;
-        handle_owner[index].in_use = TFM_CRYPTO_NOT_IN_USE;
+        tfm_crypto_handle_owner_release(index);
     }
 
     return status;
@@ -356,6 +449,11 @@ psa_status_t tfm_crypto_get_key_information(psa_invec in_vec[],
     psa_key_handle_t key = iov->key_handle;
     psa_key_type_t *type = out_vec[0].base;
     size_t *bits = out_vec[1].base;
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
+
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
 
     return psa_get_key_information(key, type, bits);
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
@@ -381,6 +479,11 @@ psa_status_t tfm_crypto_export_key(psa_invec in_vec[],
     psa_key_handle_t key = iov->key_handle;
     uint8_t *data = out_vec[0].base;
     size_t data_size = out_vec[0].len;
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
+
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
 
     return psa_export_key(key, data, data_size, &(out_vec[0].len));
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
@@ -406,6 +509,11 @@ psa_status_t tfm_crypto_export_public_key(psa_invec in_vec[],
     psa_key_handle_t key = iov->key_handle;
     uint8_t *data = out_vec[0].base;
     size_t data_size = out_vec[0].len;
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
+
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
 
     return psa_export_public_key(key, data, data_size, &(out_vec[0].len));
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
@@ -435,6 +543,17 @@ psa_status_t tfm_crypto_copy_key(psa_invec in_vec[],
     psa_key_handle_t source_handle = iov->key_handle;
     psa_key_handle_t target_handle = *((psa_key_handle_t *)in_vec[1].base);
     const psa_key_policy_t *policy = in_vec[2].base;
+    psa_status_t status;
+
+    status = tfm_crypto_get_engine_key_handle(source_handle, &source_handle);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    status = tfm_crypto_get_engine_key_handle(target_handle, &target_handle);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
 
     return psa_copy_key(source_handle, target_handle, policy);
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
@@ -462,7 +581,7 @@ psa_status_t tfm_crypto_set_key_policy(psa_invec in_vec[],
 
     psa_key_handle_t key = iov->key_handle;
     const psa_key_policy_t *policy = in_vec[1].base;
-    psa_status_t status = tfm_crypto_check_handle_owner(key, NULL);
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
 
     if (status == PSA_SUCCESS) {
         return psa_set_key_policy(key, policy);
@@ -492,6 +611,11 @@ psa_status_t tfm_crypto_get_key_policy(psa_invec in_vec[],
 
     psa_key_handle_t key = iov->key_handle;
     psa_key_policy_t *policy = out_vec[0].base;
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
+
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
 
     return psa_get_key_policy(key, policy);
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
@@ -517,6 +641,11 @@ psa_status_t tfm_crypto_get_key_lifetime(psa_invec in_vec[],
 
     psa_key_handle_t key = iov->key_handle;
     psa_key_lifetime_t *lifetime = out_vec[0].base;
+    psa_status_t status = tfm_crypto_get_engine_key_handle(key, &key);
+
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
 
     return psa_get_key_lifetime(key, lifetime);
 #endif /* TFM_CRYPTO_KEY_MODULE_DISABLED */
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -60,6 +60,13 @@ psa_status_t tfm_crypto_init(void);
  */
 psa_status_t tfm_crypto_init_alloc(void);
 
+/**
+ * \brief Initialise the Key module
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_init_key(void);
+
 /**
  * \brief Returns the ID of the caller
  *
@@ -83,6 +90,20 @@ psa_status_t tfm_crypto_get_caller_id(int32_t *id);
  */
 psa_status_t tfm_crypto_check_handle_owner(psa_key_handle_t handle,
                                            uint32_t *index);
+
+/**
+ * \brief Checks that the requested handle belongs to the requesting
+ *        partition and returns the corresponding handle in the crypto
+ *        engine
+ *
+ * \param[in]  handle        Handle given as input
+ * \param[out] engine_handle Pointer to hold the handle to the key in the
+ *                           crypto engine. Valid only on PSA_SUCCESS.
+ *
+ * \return Return values as described in \ref psa_status_t
+ */
+psa_status_t tfm_crypto_get_engine_key_handle(psa_key_handle_t handle,
+                                              psa_key_handle_t *engine_handle);
 /**
  * \brief Allocate an operation context in the backend
  *
@@ -147,6 +147,19 @@ enum attest_token_err_t attest_token_start(struct attest_token_ctx *me,
 }
 
 
+/*
+ Public function. See attest_token.h
+ */
+void attest_token_start_claims(struct attest_token_ctx *me,
+                               const struct q_useful_buf *out_buf)
+{
+    me->opt_flags  = 0;
+    me->key_select = 0;
+
+    QCBOREncode_Init(&(me->cbor_enc_ctx), *out_buf);
+}
+
+
 /*
  Public function. See attest_token.h
  */
@@ -242,3 +255,23 @@ attest_token_finish(struct attest_token_ctx *me,
 Done:
         return return_value;
 }
+
+
+/*
+ Public function. See attest_token.h
+ */
+enum attest_token_err_t
+attest_token_finish_claims(struct attest_token_ctx *me,
+                           struct q_useful_buf_c *encoded)
+{
+    QCBORError qcbor_result;
+
+    qcbor_result = QCBOREncode_Finish(&(me->cbor_enc_ctx), encoded);
+    if (qcbor_result == QCBOR_ERR_BUFFER_TOO_SMALL) {
+        return ATTEST_TOKEN_ERR_TOO_SMALL;
+    } else if (qcbor_result != QCBOR_SUCCESS) {
+        return ATTEST_TOKEN_ERR_CBOR_FORMATTING;
+    }
+
+    return ATTEST_TOKEN_ERR_SUCCESS;
+}
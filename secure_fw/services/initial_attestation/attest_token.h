@@ -169,6 +169,28 @@ attest_token_start(struct attest_token_ctx *me,
                    const struct q_useful_buf *out_buffer);
 
 
+/**
+ * \brief Initialize a context to encode claims without a token around them.
+ *
+ * \param[in] me          The token creation context to be initialized.
+ * \param[out] out_buffer The output buffer to write the encoded claims into.
+ *
+ * No COSE headers are written and nothing is signed, so neither the
+ * attestation key nor the crypto functions are needed. This is used to
+ * encode claims in advance, which are later added to a token with
+ * attest_token_add_encoded(), and to calculate the size of a payload.
+ * The claims are added with the \c attest_token_add_xxx() methods or
+ * with the context from attest_token_borrow_cbor_cntxt(), and the
+ * encoding is completed with attest_token_finish_claims().
+ *
+ * If \c out_buffer->ptr is \c NULL and \c out_buffer_ptr->len is
+ * large, nothing is written, but the length of the encoded claims will
+ * be returned by attest_token_finish_claims().
+ */
+void attest_token_start_claims(struct attest_token_ctx *me,
+                               const struct q_useful_buf *out_buffer);
+
+
 
 /**
  * \brief Get a copy of the CBOR encoding context
@@ -251,6 +273,18 @@ enum attest_token_err_t
 attest_token_finish(struct attest_token_ctx *me,
                     struct q_useful_buf_c *completed_token);
 
+/**
+ * \brief Finish encoding claims started with attest_token_start_claims()
+ *
+ * \param[in] me        Token Creation Context.
+ * \param[out] encoded  Pointer and length of the encoded claims.
+ *
+ * \return one of the \ref attest_token_err_t errors.
+ */
+enum attest_token_err_t
+attest_token_finish_claims(struct attest_token_ctx *me,
+                           struct q_useful_buf_c *encoded);
+
 #ifdef __cplusplus
 }
 #endif
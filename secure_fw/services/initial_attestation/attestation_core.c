@@ -54,6 +54,40 @@ struct attest_boot_data {
 __attribute__ ((aligned(4)))
 static struct attest_boot_data boot_data;
 
+/*!
+ * \struct attest_claims_cache
+ *
+ * \brief Contains the claims which cannot change after boot
+ *
+ * \details The claims are collected when the first token or token size is
+ *          requested, because the instance ID needs the attestation key and
+ *          the Crypto service. Claims taken from the boot status point into
+ *          \ref boot_data, the others are copied into the buffers. The SW
+ *          components are stored as an encoded CBOR array, which is empty if
+ *          there is not any SW component in the boot status.
+ */
+struct attest_claims_cache {
+    uint32_t valid;
+    uint8_t boot_seed_buf[BOOT_SEED_SIZE];
+    uint8_t instance_id_buf[INSTANCE_ID_MAX_SIZE];
+    uint8_t implementation_id_buf[IMPLEMENTATION_ID_MAX_SIZE];
+    uint8_t sw_components_buf[MAX_BOOT_STATUS];
+    struct q_useful_buf_c boot_seed;
+    struct q_useful_buf_c instance_id;
+    struct q_useful_buf_c implementation_id;
+    struct q_useful_buf_c sw_components;
+    enum tfm_security_lifecycle_t security_lifecycle;
+    size_t cose_overhead; /* Size of the token without the wrapped payload */
+};
+
+/*!
+ * \var claims_cache
+ *
+ * \brief Cache of the claims which cannot change after boot, so that only the
+ *        challenge and the caller dependent claims are collected per request.
+ */
+static struct attest_claims_cache claims_cache;
+
 enum psa_attest_err_t attest_init(void)
 {
     enum psa_attest_err_t res;
@@ -438,21 +472,22 @@ attest_add_single_sw_component(struct attest_token_ctx *token_ctx,
 #endif /* INDIVIDUAL_SW_COMPONENTS */
 
 /*!
- * \brief Static function to add the claims of all SW components to the
- *        attestation token.
+ * \brief Static function to encode the claims of all SW components as a CBOR
+ *        array.
  *
- * \param[in]  token_ctx  Token encoding context
+ * \param[in]  token_ctx  Claims encoding context
+ * \param[out] cnt        Number of SW components found in the boot status.
+ *                        If it is zero then the array is not opened.
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
 static enum psa_attest_err_t
-attest_add_all_sw_components(struct attest_token_ctx *token_ctx)
+attest_encode_sw_components(struct attest_token_ctx *token_ctx, uint32_t *cnt)
 {
     uint16_t tlv_len;
     uint8_t *tlv_ptr;
     uint8_t  tlv_id;
     int32_t found;
-    uint32_t cnt = 0;
     uint8_t module;
     QCBOREncodeContext *cbor_encode_ctx = NULL;
 #ifdef INDIVIDUAL_SW_COMPONENTS
@@ -462,6 +497,7 @@ attest_add_all_sw_components(struct attest_token_ctx *token_ctx)
 #endif
 
     cbor_encode_ctx = attest_token_borrow_cbor_cntxt(token_ctx);
+    *cnt = 0;
 
     /* Starting from module 1, because module 0 contains general claims which
      * are not related to SW module(i.e: boot_seed, etc.)
@@ -480,11 +516,10 @@ attest_add_all_sw_components(struct attest_token_ctx *token_ctx)
         }
 
         if (found == 1) {
-            cnt++;
-            if (cnt == 1) {
+            (*cnt)++;
+            if (*cnt == 1) {
                 /* Open array which stores SW components claims */
-                QCBOREncode_OpenArrayInMapN(cbor_encode_ctx,
-                                            EAT_CBOR_ARM_LABEL_SW_COMPONENTS);
+                QCBOREncode_OpenArray(cbor_encode_ctx);
             }
 
 #ifdef INDIVIDUAL_SW_COMPONENTS
@@ -500,32 +535,60 @@ attest_add_all_sw_components(struct attest_token_ctx *token_ctx)
         }
     }
 
-    if (cnt != 0) {
+    if (*cnt != 0) {
         /* Close array which stores SW components claims*/
         QCBOREncode_CloseArray(cbor_encode_ctx);
-    } else {
-        /* If there is not any SW components' measurement in the boot status
-         * then include this claim to indicate that this state is intentional
-         */
-        attest_token_add_integer(token_ctx,
-                                 EAT_CBOR_ARM_LABEL_NO_SW_COMPONENTS,
-                                 (int64_t)NO_SW_COMPONENT_FIXED_VALUE);
     }
 
     return PSA_ATTEST_ERR_SUCCESS;
 }
 
 /*!
- * \brief Static function to add boot seed claim to attestation token.
+ * \brief Static function to encode the claims of all SW components into the
+ *        claims cache.
  *
- * \param[in]  token_ctx  Token encoding context
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t attest_load_sw_components(void)
+{
+    struct attest_token_ctx token_ctx;
+    struct q_useful_buf buf;
+    enum attest_token_err_t token_err;
+    enum psa_attest_err_t attest_err;
+    uint32_t cnt;
+
+    buf.ptr = claims_cache.sw_components_buf;
+    buf.len = sizeof(claims_cache.sw_components_buf);
+
+    attest_token_start_claims(&token_ctx, &buf);
+
+    attest_err = attest_encode_sw_components(&token_ctx, &cnt);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    if (cnt == 0) {
+        claims_cache.sw_components = NULL_Q_USEFUL_BUF_C;
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+
+    token_err = attest_token_finish_claims(&token_ctx,
+                                           &claims_cache.sw_components);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return PSA_ATTEST_ERR_CLAIM_UNAVAILABLE;
+    }
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to load the boot seed claim into the claims cache.
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
-static enum psa_attest_err_t
-attest_add_boot_seed_claim(struct attest_token_ctx *token_ctx)
+static enum psa_attest_err_t attest_load_boot_seed_claim(void)
 {
-    uint8_t boot_seed[BOOT_SEED_SIZE];
+    uint8_t *boot_seed = claims_cache.boot_seed_buf;
     enum tfm_plat_err_t res;
     struct q_useful_buf_c claim_value = {0};
     uint16_t tlv_len;
@@ -541,7 +604,7 @@ attest_add_boot_seed_claim(struct attest_token_ctx *token_ctx)
         /* If not found in boot status then use callback function to get it
          * from runtime SW
          */
-        res = tfm_plat_get_boot_seed(sizeof(boot_seed), boot_seed);
+        res = tfm_plat_get_boot_seed(BOOT_SEED_SIZE, boot_seed);
         if (res != TFM_PLAT_ERR_SUCCESS) {
             return PSA_ATTEST_ERR_CLAIM_UNAVAILABLE;
         }
@@ -549,17 +612,13 @@ attest_add_boot_seed_claim(struct attest_token_ctx *token_ctx)
         claim_value.len = BOOT_SEED_SIZE;
     }
 
-    attest_token_add_bstr(token_ctx,
-                          EAT_CBOR_ARM_LABEL_BOOT_SEED,
-                          &claim_value);
+    claims_cache.boot_seed = claim_value;
 
     return PSA_ATTEST_ERR_SUCCESS;
 }
 
 /*!
- * \brief Static function to add instance id claim to attestation token.
- *
- * \param[in]  token_ctx  Token encoding context
+ * \brief Static function to load the instance id claim into the claims cache.
  *
  * \note This mandatory claim represents the unique identifier of the instance.
  *       In the PSA definition it is a hash of the public attestation key of the
@@ -570,14 +629,12 @@ attest_add_boot_seed_claim(struct attest_token_ctx *token_ctx)
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
-static enum psa_attest_err_t
-attest_add_instance_id_claim(struct attest_token_ctx *token_ctx)
+static enum psa_attest_err_t attest_load_instance_id_claim(void)
 {
     psa_status_t crypto_res;
     enum psa_attest_err_t attest_res;
-    uint8_t instance_id[INSTANCE_ID_MAX_SIZE];
+    uint8_t *instance_id = claims_cache.instance_id_buf;
     size_t instance_id_len;
-    struct q_useful_buf_c claim_value;
     uint8_t *public_key;
     size_t key_len;
     psa_ecc_curve_t psa_curve;
@@ -612,40 +669,31 @@ attest_add_instance_id_claim(struct attest_token_ctx *token_ctx)
     instance_id[0] = 0x01;
     instance_id_len += 1;
 
-    claim_value.ptr = instance_id;
-    claim_value.len = instance_id_len;
-    attest_token_add_bstr(token_ctx,
-                          EAT_CBOR_ARM_LABEL_UEID,
-                          &claim_value);
+    claims_cache.instance_id.ptr = instance_id;
+    claims_cache.instance_id.len = instance_id_len;
 
     return PSA_ATTEST_ERR_SUCCESS;
 }
 
 /*!
- * \brief Static function to add implementation id claim to attestation token.
- *
- * \param[in]  token_ctx  Token encoding context
+ * \brief Static function to load the implementation id claim into the claims
+ *        cache.
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
-static enum psa_attest_err_t
-attest_add_implementation_id_claim(struct attest_token_ctx *token_ctx)
+static enum psa_attest_err_t attest_load_implementation_id_claim(void)
 {
-    uint8_t implementation_id[IMPLEMENTATION_ID_MAX_SIZE];
+    uint8_t *implementation_id = claims_cache.implementation_id_buf;
     enum tfm_plat_err_t res_plat;
-    uint32_t size = sizeof(implementation_id);
-    struct q_useful_buf_c claim_value;
+    uint32_t size = sizeof(claims_cache.implementation_id_buf);
 
     res_plat = tfm_plat_get_implementation_id(&size, implementation_id);
     if (res_plat != TFM_PLAT_ERR_SUCCESS) {
         return PSA_ATTEST_ERR_CLAIM_UNAVAILABLE;
     }
 
-    claim_value.ptr = implementation_id;
-    claim_value.len  = size;
-    attest_token_add_bstr(token_ctx,
-                          EAT_CBOR_ARM_LABEL_IMPLEMENTATION_ID,
-                          &claim_value);
+    claims_cache.implementation_id.ptr = implementation_id;
+    claims_cache.implementation_id.len = size;
 
     return PSA_ATTEST_ERR_SUCCESS;
 }
@@ -676,14 +724,12 @@ attest_add_caller_id_claim(struct attest_token_ctx *token_ctx)
 }
 
 /*!
- * \brief Static function to add security lifecycle claim to attestation token.
- *
- * \param[in]  token_ctx  Token encoding context
+ * \brief Static function to load the security lifecycle claim into the claims
+ *        cache.
  *
  * \return Returns error code as specified in \ref psa_attest_err_t
  */
-static enum psa_attest_err_t
-attest_add_security_lifecycle_claim(struct attest_token_ctx *token_ctx)
+static enum psa_attest_err_t attest_load_security_lifecycle_claim(void)
 {
     enum tfm_security_lifecycle_t security_lifecycle;
     uint32_t slc_value;
@@ -717,9 +763,7 @@ attest_add_security_lifecycle_claim(struct attest_token_ctx *token_ctx)
         return PSA_ATTEST_ERR_GENERAL;
     }
 
-    attest_token_add_integer(token_ctx,
-                             EAT_CBOR_ARM_LABEL_SECURITY_LIFECYCLE,
-                             (int64_t)security_lifecycle);
+    claims_cache.security_lifecycle = security_lifecycle;
 
     return PSA_ATTEST_ERR_SUCCESS;
 }
@@ -914,6 +958,222 @@ static void attest_get_option_flags(struct q_useful_buf_c *challenge,
 }
 #endif /* INCLUDE_TEST_CODE */
 
+/*!
+ * \brief Static function to add all claims to the attestation token.
+ *
+ * The claims which cannot change after boot are taken from the claims cache,
+ * which must be loaded before.
+ *
+ * \param[in]  token_ctx     Token encoding context
+ * \param[in]  challenge     Structure to carry the challenge value:
+ *                           pointer + challeng's length
+ * \param[in]  option_flags  Flags to select different custom options,
+ *                           for example \ref TOKEN_OPT_OMIT_CLAIMS.
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_add_claims(struct attest_token_ctx     *token_ctx,
+                  const struct q_useful_buf_c *challenge,
+                  uint32_t                     option_flags)
+{
+    enum psa_attest_err_t attest_err;
+
+    attest_err = attest_add_challenge_claim(token_ctx, challenge);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    if (option_flags & TOKEN_OPT_OMIT_CLAIMS) {
+        return PSA_ATTEST_ERR_SUCCESS;
+    }
+
+    /* Mandatory claims in IAT token */
+    attest_token_add_bstr(token_ctx,
+                          EAT_CBOR_ARM_LABEL_BOOT_SEED,
+                          &claims_cache.boot_seed);
+
+    attest_token_add_bstr(token_ctx,
+                          EAT_CBOR_ARM_LABEL_UEID,
+                          &claims_cache.instance_id);
+
+    attest_token_add_bstr(token_ctx,
+                          EAT_CBOR_ARM_LABEL_IMPLEMENTATION_ID,
+                          &claims_cache.implementation_id);
+
+    attest_err = attest_add_caller_id_claim(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_token_add_integer(token_ctx,
+                             EAT_CBOR_ARM_LABEL_SECURITY_LIFECYCLE,
+                             (int64_t)claims_cache.security_lifecycle);
+
+    if (claims_cache.sw_components.len != 0) {
+        attest_token_add_encoded(token_ctx,
+                                 EAT_CBOR_ARM_LABEL_SW_COMPONENTS,
+                                 &claims_cache.sw_components);
+    } else {
+        /* If there is not any SW components' measurement in the boot status
+         * then include this claim to indicate that this state is intentional
+         */
+        attest_token_add_integer(token_ctx,
+                                 EAT_CBOR_ARM_LABEL_NO_SW_COMPONENTS,
+                                 (int64_t)NO_SW_COMPONENT_FIXED_VALUE);
+    }
+
+#ifdef INCLUDE_OPTIONAL_CLAIMS
+    /* Optional claims in IAT token, remove them from release build */
+    attest_err = attest_add_verification_service(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_profile_definition(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_add_hw_version_claim(token_ctx);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+#endif /* INCLUDE_OPTIONAL_CLAIMS */
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to finish the size calculation of a token payload.
+ *
+ * \param[in]  token_ctx    Claims encoding context, which was started without
+ *                          an output buffer and whose payload map is open
+ * \param[out] wrapped_len  Size of the payload, once it is wrapped in a byte
+ *                          string as in the COSE_Sign1 structure
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_finish_payload_size(struct attest_token_ctx *token_ctx,
+                           size_t *wrapped_len)
+{
+    enum attest_token_err_t token_err;
+    struct q_useful_buf size_calc_buf = {NULL, INT32_MAX};
+    struct q_useful_buf_c payload;
+    struct q_useful_buf_c wrapped;
+
+    QCBOREncode_CloseMap(attest_token_borrow_cbor_cntxt(token_ctx));
+
+    token_err = attest_token_finish_claims(token_ctx, &payload);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping(token_err);
+    }
+
+    attest_token_start_claims(token_ctx, &size_calc_buf);
+    QCBOREncode_AddBytes(attest_token_borrow_cbor_cntxt(token_ctx), payload);
+
+    token_err = attest_token_finish_claims(token_ctx, &wrapped);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping(token_err);
+    }
+
+    *wrapped_len = wrapped.len;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to calculate the size of the token without its
+ *        payload and store it in the claims cache.
+ *
+ *  It encodes a token with an empty payload without an output buffer, so only
+ *  the COSE headers and the size of the signature are taken into account. The
+ *  attestation key must be registered.
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t attest_load_cose_overhead(void)
+{
+    enum psa_attest_err_t attest_err;
+    enum attest_token_err_t token_err;
+    struct attest_token_ctx token_ctx;
+    struct q_useful_buf size_calc_buf = {NULL, INT32_MAX};
+    struct q_useful_buf_c completed_token;
+    size_t empty_payload_len;
+
+    token_err = attest_token_start(&token_ctx,
+                                   0,                       /* option_flags */
+                                   0,                       /* key_select   */
+                                   T_COSE_ALGORITHM_ES256,  /* alg_select   */
+                                   &size_calc_buf);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping(token_err);
+    }
+
+    token_err = attest_token_finish(&token_ctx, &completed_token);
+    if (token_err != ATTEST_TOKEN_ERR_SUCCESS) {
+        return error_mapping(token_err);
+    }
+
+    attest_token_start_claims(&token_ctx, &size_calc_buf);
+    QCBOREncode_OpenMap(attest_token_borrow_cbor_cntxt(&token_ctx));
+
+    attest_err = attest_finish_payload_size(&token_ctx, &empty_payload_len);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    claims_cache.cose_overhead = completed_token.len - empty_payload_len;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+/*!
+ * \brief Static function to load the claims which cannot change after boot
+ *        into the claims cache. The attestation key must be registered.
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t attest_load_claims_cache(void)
+{
+    enum psa_attest_err_t attest_err;
+
+    attest_err = attest_load_boot_seed_claim();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_load_instance_id_claim();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_load_implementation_id_claim();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_load_security_lifecycle_claim();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_load_sw_components();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    attest_err = attest_load_cose_overhead();
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    claims_cache.valid = 1;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
 /*!
  * \brief Static function to create the initial attestation token
  *
@@ -942,6 +1202,13 @@ attest_create_token(struct q_useful_buf_c *challenge,
         goto error;
     }
 
+    if (!claims_cache.valid) {
+        attest_err = attest_load_claims_cache();
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            goto error;
+        }
+    }
+
 #ifdef INCLUDE_TEST_CODE /* Remove them from release build */
     attest_get_option_flags(challenge, &option_flags, &key_select);
 #endif
@@ -960,63 +1227,11 @@ attest_create_token(struct q_useful_buf_c *challenge,
         goto error;
     }
 
-    attest_err = attest_add_challenge_claim(&attest_token_ctx,
-                                            challenge);
+    attest_err = attest_add_claims(&attest_token_ctx, challenge, option_flags);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         goto error;
     }
 
-    if (!(option_flags & TOKEN_OPT_OMIT_CLAIMS)) {
-        /* Mandatory claims in IAT token */
-        attest_err = attest_add_boot_seed_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_instance_id_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_implementation_id_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_caller_id_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_security_lifecycle_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_all_sw_components(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-#ifdef INCLUDE_OPTIONAL_CLAIMS
-        /* Optional claims in IAT token, remove them from release build */
-        attest_err = attest_add_verification_service(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_profile_definition(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-
-        attest_err = attest_add_hw_version_claim(&attest_token_ctx);
-        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
-            goto error;
-        }
-#endif /* INCLUDE_OPTIONAL_CLAIMS */
-    }
-
     /* Finish up creating the token. This is where the actual signature
      * is generated. This finishes up the CBOR encoding too.
      */
@@ -1093,42 +1308,87 @@ error:
     return attest_err;
 }
 
-/* Initial implementation, just returns with hard coded value */
-enum psa_attest_err_t
-initial_attest_get_token_size(const psa_invec  *in_vec,  uint32_t num_invec,
-                                    psa_outvec *out_vec, uint32_t num_outvec)
+/*!
+ * \brief Static function to calculate the size of the initial attestation
+ *        token from the claims cache
+ *
+ *  Only the payload is encoded, without an output buffer, so neither the
+ *  attestation key nor the Crypto service is used once the claims cache is
+ *  loaded.
+ *
+ * \param[in]  challenge_size  Size of the challenge object in bytes
+ * \param[out] token_size      Size of the token, which would be created
+ *
+ * \return Returns error code as specified in \ref psa_attest_err_t
+ */
+static enum psa_attest_err_t
+attest_get_token_size(size_t challenge_size, uint32_t *token_size)
 {
-    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
-    uint32_t  challenge_size = *(uint32_t *)in_vec[0].base;
-    uint32_t *token_buf_size = (uint32_t *)out_vec[0].base;
+    enum psa_attest_err_t attest_err;
+    struct attest_token_ctx token_ctx;
+    struct q_useful_buf size_calc_buf = {NULL, INT32_MAX};
     struct q_useful_buf_c challenge;
-    struct q_useful_buf token;
-    struct q_useful_buf_c completed_token;
+    size_t payload_len;
+
+    if (!claims_cache.valid) {
+        attest_err = attest_register_initial_attestation_key();
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+
+        attest_err = attest_load_claims_cache();
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            (void)attest_unregister_initial_attestation_key();
+            return attest_err;
+        }
+
+        attest_err = attest_unregister_initial_attestation_key();
+        if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+            return attest_err;
+        }
+    }
 
     /* Only the size of the challenge is needed */
     challenge.ptr = NULL;
     challenge.len = challenge_size;
 
-    /* Special value to get the size of the token, but token is not created */
-    token.ptr = NULL;
-    token.len = INT32_MAX;
+    attest_token_start_claims(&token_ctx, &size_calc_buf);
+    QCBOREncode_OpenMap(attest_token_borrow_cbor_cntxt(&token_ctx));
 
-    if (out_vec[0].len < sizeof(uint32_t)) {
-        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
-        goto error;
+    attest_err = attest_add_claims(&token_ctx, &challenge, 0);
+    if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
     }
 
-    attest_err = attest_verify_challenge_size(challenge_size);
+    attest_err = attest_finish_payload_size(&token_ctx, &payload_len);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
+        return attest_err;
+    }
+
+    *token_size = claims_cache.cose_overhead + payload_len;
+
+    return PSA_ATTEST_ERR_SUCCESS;
+}
+
+enum psa_attest_err_t
+initial_attest_get_token_size(const psa_invec  *in_vec,  uint32_t num_invec,
+                                    psa_outvec *out_vec, uint32_t num_outvec)
+{
+    enum psa_attest_err_t attest_err = PSA_ATTEST_ERR_SUCCESS;
+    uint32_t  challenge_size = *(uint32_t *)in_vec[0].base;
+    uint32_t *token_buf_size = (uint32_t *)out_vec[0].base;
+
+    if (out_vec[0].len < sizeof(uint32_t)) {
+        attest_err = PSA_ATTEST_ERR_INVALID_INPUT;
         goto error;
     }
 
-    attest_err = attest_create_token(&challenge, &token, &completed_token);
+    attest_err = attest_verify_challenge_size(challenge_size);
     if (attest_err != PSA_ATTEST_ERR_SUCCESS) {
         goto error;
     }
 
-    *token_buf_size = completed_token.len;
+    attest_err = attest_get_token_size(challenge_size, token_buf_size);
 
 error:
     return attest_err;
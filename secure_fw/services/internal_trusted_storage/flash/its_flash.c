@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -10,6 +10,9 @@
 #include "Driver_Flash.h"
 #include "secure_fw/services/internal_trusted_storage/its_utils.h"
 #include "tfm_memory_utils.h"
+#ifdef ITS_FLASH_COPY_HAL
+#include "platform/include/tfm_plat_flash_copy.h"
+#endif
 
 #ifndef ITS_FLASH_AREA_ADDR
 #error "ITS_FLASH_AREA_ADDR must be defined in flash_layout.h file"
@@ -23,12 +26,25 @@
 extern ARM_DRIVER_FLASH ITS_FLASH_DEV_NAME;
 
 #define BLOCK_START_OFFSET  0
-#define MAX_BLOCK_DATA_COPY 256
+
+/* Size of the RAM buffer used to move data between two blocks. It can be
+ * overridden in flash_layout.h.
+ */
+#ifndef ITS_MAX_BLOCK_DATA_COPY
+#define ITS_MAX_BLOCK_DATA_COPY 256
+#endif
+
+#if (ITS_MAX_BLOCK_DATA_COPY % ITS_FLASH_PROGRAM_UNIT) != 0
+#error "ITS_MAX_BLOCK_DATA_COPY must be a multiple of ITS_FLASH_PROGRAM_UNIT"
+#endif
 
 #ifdef ITS_RAM_FS
 #define BLOCK_DATA_SIZE (ITS_BLOCK_SIZE * ITS_TOTAL_NUM_OF_BLOCKS)
 
 static uint8_t block_data[BLOCK_DATA_SIZE] = {0};
+#else
+/* The buffer is not allocated in the stack, as its size is configurable */
+static uint8_t block_data_copy[ITS_MAX_BLOCK_DATA_COPY];
 #endif
 
 /**
@@ -79,6 +95,17 @@ static psa_status_t flash_erase(uint32_t flash_addr)
 
     return PSA_SUCCESS;
 }
+
+static psa_status_t flash_copy(uint32_t dst_addr, uint32_t src_addr,
+                               size_t size)
+{
+    uint32_t dst_idx = dst_addr - ITS_FLASH_AREA_ADDR;
+    uint32_t src_idx = src_addr - ITS_FLASH_AREA_ADDR;
+
+    (void)tfm_memcpy(&block_data[dst_idx], &block_data[src_idx], size);
+
+    return PSA_SUCCESS;
+}
 #else /* ITS_RAM_FS */
 static psa_status_t flash_init(void)
 {
@@ -128,6 +155,54 @@ static psa_status_t flash_erase(uint32_t flash_addr)
 
     return PSA_SUCCESS;
 }
+
+static psa_status_t flash_copy(uint32_t dst_addr, uint32_t src_addr,
+                               size_t size)
+{
+    psa_status_t err;
+    size_t bytes_to_move;
+
+#ifdef ITS_FLASH_COPY_HAL
+    enum tfm_plat_err_t plat_err;
+
+    /* Let the platform copy the data, if it can */
+    plat_err = tfm_plat_flash_copy(&ITS_FLASH_DEV_NAME, dst_addr, src_addr,
+                                   size);
+    if (plat_err == TFM_PLAT_ERR_SUCCESS) {
+        return PSA_SUCCESS;
+    } else if (plat_err != TFM_PLAT_ERR_UNSUPPORTED) {
+        return PSA_ERROR_STORAGE_FAILURE;
+    }
+#endif
+
+    while (size > 0) {
+        /* Calculates the number of bytes to move */
+        bytes_to_move = ITS_UTILS_MIN(size, ITS_MAX_BLOCK_DATA_COPY);
+
+        /* Reads data from source block and store it in the in-memory copy of
+         * destination content.
+         */
+        err = flash_read(src_addr, bytes_to_move, block_data_copy);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        /* Writes in flash the in-memory block content after modification */
+        err = flash_write(dst_addr, bytes_to_move, block_data_copy);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        /* Updates pointers to the source and destination flash regions */
+        src_addr += bytes_to_move;
+        dst_addr += bytes_to_move;
+
+        /* Decrement remaining size to move */
+        size -= bytes_to_move;
+    };
+
+    return PSA_SUCCESS;
+}
 #endif /* ITS_RAM_FS */
 
 psa_status_t its_flash_init(void)
@@ -167,43 +242,14 @@ psa_status_t its_flash_block_to_block_move(uint32_t dst_block,
                                            size_t src_offset,
                                            size_t size)
 {
-    psa_status_t err;
-    uint8_t dst_block_data_copy[MAX_BLOCK_DATA_COPY];
     uint32_t dst_flash_addr;
     uint32_t src_flash_addr;
-    size_t bytes_to_move;
 
     /* Gets flash addresses defined by block ID and offset parameters */
     src_flash_addr = get_phys_address(src_block, src_offset);
     dst_flash_addr = get_phys_address(dst_block, dst_offset);
 
-    while (size > 0) {
-        /* Calculates the number of bytes to move */
-        bytes_to_move = ITS_UTILS_MIN(size, MAX_BLOCK_DATA_COPY);
-
-        /* Reads data from source block and store it in the in-memory copy of
-         * destination content.
-         */
-        err = flash_read(src_flash_addr, bytes_to_move, dst_block_data_copy);
-        if (err != PSA_SUCCESS) {
-            return err;
-        }
-
-        /* Writes in flash the in-memory block content after modification */
-        err = flash_write(dst_flash_addr, bytes_to_move, dst_block_data_copy);
-        if (err != PSA_SUCCESS) {
-            return err;
-        }
-
-        /* Updates pointers to the source and destination flash regions */
-        src_flash_addr += bytes_to_move;
-        dst_flash_addr += bytes_to_move;
-
-        /* Decrement remaining size to move */
-        size -= bytes_to_move;
-    };
-
-    return PSA_SUCCESS;
+    return flash_copy(dst_flash_addr, src_flash_addr, size);
 }
 
 psa_status_t its_flash_erase_block(uint32_t block_id)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -19,7 +19,8 @@ static psa_status_t its_flash_fs_file_write_aligned_data(
                                         const struct its_file_meta_t *file_meta,
                                         size_t offset,
                                         size_t size,
-                                        const uint8_t *data)
+                                        its_flash_fs_get_data_t get_data,
+                                        void *context)
 {
     size_t f_offset;
 
@@ -28,16 +29,372 @@ static psa_status_t its_flash_fs_file_write_aligned_data(
     if (GET_ALIGNED_FLASH_BYTES(offset) != offset) {
         return PSA_ERROR_INVALID_ARGUMENT;
     }
-
-    /* Set the size to be aligned with ITS_FLASH_PROGRAM_UNIT */
-    size = GET_ALIGNED_FLASH_BYTES(size);
 #endif /* (ITS_FLASH_PROGRAM_UNIT != 1) */
 
     /* Set offset inside the file where to start to write the content */
     f_offset = (file_meta->data_idx + offset);
 
+    /* The data block layer aligns the size with ITS_FLASH_PROGRAM_UNIT */
     return its_flash_fs_dblock_write_file(file_meta->lblock, f_offset,
-                                          size, data);
+                                          size, get_data, context);
+}
+
+/**
+ * \brief Checks if a file is stored in the given logical block.
+ *
+ * \param[in] file_meta  Pointer to file's metadata
+ * \param[in] lblock     Logical block number
+ *
+ * \return Returns 1 if the file is valid and stored in the logical block.
+ *         Otherwise, it returns 0.
+ */
+static uint32_t its_flash_fs_file_in_block(
+                                        const struct its_file_meta_t *file_meta,
+                                        uint32_t lblock)
+{
+    return ((file_meta->lblock == lblock) &&
+            (its_utils_validate_fid(file_meta->id) == PSA_SUCCESS));
+}
+
+/**
+ * \brief Gets the size used by the files stored in a logical block.
+ *
+ * \param[in]  lblock     Logical block number
+ * \param[in]  skip_idx   File metadata entry index to leave out of the count.
+ *                        ITS_MAX_NUM_FILES to count all the files.
+ * \param[out] used_size  Sum of the maximum sizes of the files
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_block_used_size(uint32_t lblock,
+                                                 uint32_t skip_idx,
+                                                 size_t *used_size)
+{
+    psa_status_t err;
+    struct its_file_meta_t file_meta;
+    uint32_t idx;
+
+    *used_size = 0;
+
+    for (idx = 0; idx < ITS_MAX_NUM_FILES; idx++) {
+        if (idx == skip_idx) {
+            continue;
+        }
+
+        err = its_flash_fs_mblock_read_file_meta(idx, &file_meta);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        if (its_flash_fs_file_in_block(&file_meta, lblock)) {
+            *used_size += file_meta.max_size;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Checks if the data area of a logical block has gaps which do not
+ *        belong to any file. Gaps are left when a file is rewritten in the
+ *        free space of its data block.
+ *
+ * \param[in]  lblock      Logical block number
+ * \param[in]  block_meta  Pointer to block meta of the logical block
+ * \param[out] has_gaps    Set to 1 if the data area has gaps, 0 otherwise
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_block_has_gaps(
+                                      uint32_t lblock,
+                                      const struct its_block_meta_t *block_meta,
+                                      uint32_t *has_gaps)
+{
+    psa_status_t err;
+    size_t used_size;
+
+    err = its_flash_fs_block_used_size(lblock, ITS_MAX_NUM_FILES, &used_size);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    *has_gaps = (used_size != (ITS_BLOCK_SIZE - block_meta->data_start
+                                                    - block_meta->free_size));
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Copies the files of a logical block, except the one referenced by
+ *        skip_idx, next to each other into the scratch data block, keeping
+ *        their order. The metadata of all files, except the one referenced by
+ *        skip_idx, is written into the scratch metadata block.
+ *
+ * \param[in]     lblock      Logical block number
+ * \param[in]     skip_idx    File metadata entry index to skip
+ * \param[in,out] block_meta  Pointer to block meta of the logical block. It
+ *                            is updated with the free size after the copy.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_repack_block(uint32_t lblock,
+                                          uint32_t skip_idx,
+                                          struct its_block_meta_t *block_meta)
+{
+    psa_status_t err;
+    struct its_file_meta_t file_meta;
+    struct its_file_meta_t other_meta;
+    size_t used_size = 0;
+    size_t data_idx;
+    uint32_t idx;
+    uint32_t i;
+
+    for (idx = 0; idx < ITS_MAX_NUM_FILES; idx++) {
+        if (idx == skip_idx) {
+            continue;
+        }
+
+        err = its_flash_fs_mblock_read_file_meta(idx, &file_meta);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        if (its_flash_fs_file_in_block(&file_meta, lblock)) {
+            /* The new position is after all the files placed before this one
+             * in the block.
+             */
+            data_idx = block_meta->data_start;
+            for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+                if ((i == skip_idx) || (i == idx)) {
+                    continue;
+                }
+
+                err = its_flash_fs_mblock_read_file_meta(i, &other_meta);
+                if (err != PSA_SUCCESS) {
+                    return err;
+                }
+
+                if (its_flash_fs_file_in_block(&other_meta, lblock) &&
+                    (other_meta.data_idx < file_meta.data_idx)) {
+                    data_idx += other_meta.max_size;
+                }
+            }
+
+            err = its_flash_fs_dblock_move_file_to_scratch(block_meta,
+                                                           &file_meta,
+                                                           data_idx);
+            if (err != PSA_SUCCESS) {
+                return PSA_ERROR_GENERIC_ERROR;
+            }
+
+            file_meta.data_idx = data_idx;
+            used_size += file_meta.max_size;
+        }
+
+        /* Update file metadata in to the scratch block */
+        err = its_flash_fs_mblock_update_scratch_file_meta(idx, &file_meta);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+
+    block_meta->free_size = (ITS_BLOCK_SIZE - block_meta->data_start
+                                                                  - used_size);
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Writes a new version of a file in the free space of its data block,
+ *        which avoids copying the data block into the scratch data block.
+ *        The space of the previous version becomes a gap in the data block.
+ *
+ * \param[in] idx         File metadata entry index
+ * \param[in] file_meta   Pointer to file's metadata
+ * \param[in] block_meta  Pointer to block meta of the file's data block
+ * \param[in] size        Size of the incoming buffer
+ * \param[in] offset      Offset in the file
+ * \param[in] get_data    Function to get the data to be written
+ * \param[in] context     Context given to get_data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_file_write_in_free_space(
+                                            uint32_t idx,
+                                            struct its_file_meta_t *file_meta,
+                                            struct its_block_meta_t *block_meta,
+                                            size_t size,
+                                            size_t offset,
+                                            its_flash_fs_get_data_t get_data,
+                                            void *context)
+{
+    size_t data_idx;
+    psa_status_t err;
+
+#if (ITS_FLASH_PROGRAM_UNIT != 1)
+    /* Check if offset is aligned with ITS_FLASH_PROGRAM_UNIT */
+    if (GET_ALIGNED_FLASH_BYTES(offset) != offset) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+#endif /* (ITS_FLASH_PROGRAM_UNIT != 1) */
+
+    /* The new version is placed at the start of the free space */
+    data_idx = ITS_BLOCK_SIZE - block_meta->free_size;
+
+    err = its_flash_fs_dblock_write_active(block_meta, (data_idx + offset),
+                                           size, get_data, context);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* Copy the content of the previous version which is not overwritten */
+    err = its_flash_fs_dblock_keep_file_data(block_meta->phy_id, data_idx,
+                                             block_meta, file_meta, offset,
+                                             size);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    file_meta->data_idx = data_idx;
+    if ((offset + size) > file_meta->cur_size) {
+        /* Update the file metadata */
+        file_meta->cur_size = (offset + size);
+    }
+
+    block_meta->free_size -= file_meta->max_size;
+
+    /* Update block metadata in scratch metadata block */
+    err = its_flash_fs_mblock_update_scratch_block_meta(file_meta->lblock,
+                                                        block_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* Update file metadata to reflect new attributes */
+    err = its_flash_fs_mblock_update_scratch_file_meta(idx, file_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* Copy rest of the file metadata entries */
+    err = its_flash_fs_mblock_cp_remaining_file_meta(idx);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* The file is not located in the logical block 0, so its data needs to be
+     * copied in the scratch metadata block.
+     */
+    err = its_flash_fs_mblock_migrate_lb0_data_to_scratch();
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* Update the metablock header, swap scratch and active blocks,
+     * erase scratch blocks.
+     */
+    return its_flash_fs_mblock_meta_update_finalize();
+}
+
+/**
+ * \brief Writes a new version of a file at the end of its data block, after
+ *        removing the gaps of the data block. The maximum size of the new
+ *        version can differ from the one of the previous version.
+ *
+ * \param[in] idx         File metadata entry index
+ * \param[in] file_meta   Pointer to file's metadata
+ * \param[in] block_meta  Pointer to block meta of the file's data block
+ * \param[in] size        Size of the incoming buffer
+ * \param[in] offset      Offset in the file
+ * \param[in] get_data    Function to get the data to be written
+ * \param[in] context     Context given to get_data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_file_write_repacked(
+                                            uint32_t idx,
+                                            struct its_file_meta_t *file_meta,
+                                            struct its_block_meta_t *block_meta,
+                                            size_t size,
+                                            size_t offset,
+                                            its_flash_fs_get_data_t get_data,
+                                            void *context)
+{
+    psa_status_t err;
+    uint32_t cur_phys_block;
+    uint32_t scratch_id;
+    size_t data_idx;
+
+    /* Copy the other files of the block without gaps */
+    err = its_flash_fs_repack_block(file_meta->lblock, idx, block_meta);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    /* The file is placed after the other files */
+    data_idx = ITS_BLOCK_SIZE - block_meta->free_size;
+    block_meta->free_size -= file_meta->max_size;
+
+    /* Copy the content of the previous version which is not overwritten */
+    scratch_id = its_flash_fs_mblock_cur_data_scratch_id(file_meta->lblock);
+    err = its_flash_fs_dblock_keep_file_data(scratch_id, data_idx, block_meta,
+                                             file_meta, offset, size);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    file_meta->data_idx = data_idx;
+
+    /* Write the content into scratch data block */
+    err = its_flash_fs_file_write_aligned_data(file_meta, offset, size,
+                                               get_data, context);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    if ((offset + size) > file_meta->cur_size) {
+        /* Update the file metadata */
+        file_meta->cur_size = (offset + size);
+    }
+
+    cur_phys_block = block_meta->phy_id;
+
+    /* Cur scratch block become the active datablock */
+    block_meta->phy_id = its_flash_fs_mblock_cur_data_scratch_id(
+                                                             file_meta->lblock);
+
+    /* Swap the scratch data block */
+    its_flash_fs_mblock_set_data_scratch(cur_phys_block, file_meta->lblock);
+
+    /* Update block metadata in scratch metadata block */
+    err = its_flash_fs_mblock_update_scratch_block_meta(file_meta->lblock,
+                                                        block_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* Update file metadata to reflect new attributes. The metadata of the
+     * other files has been written while repacking the block.
+     */
+    err = its_flash_fs_mblock_update_scratch_file_meta(idx, file_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    /* If the file is located in the logical block 0, its data block is the
+     * scratch metadata block, which already contains the repacked data.
+     */
+    if (file_meta->lblock != ITS_LOGICAL_DBLOCK0) {
+        err = its_flash_fs_mblock_migrate_lb0_data_to_scratch();
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+    }
+
+    /* Update the metablock header, swap scratch and active blocks,
+     * erase scratch blocks.
+     */
+    return its_flash_fs_mblock_meta_update_finalize();
 }
 
 psa_status_t its_flash_fs_prepare(void)
@@ -69,7 +426,8 @@ psa_status_t its_flash_fs_file_create(const uint8_t *fid,
                                       size_t max_size,
                                       size_t data_size,
                                       uint32_t flags,
-                                      const uint8_t *data)
+                                      its_flash_fs_get_data_t get_data,
+                                      void *context)
 {
     struct its_block_meta_t block_meta;
     uint32_t cur_phys_block;
@@ -98,7 +456,7 @@ psa_status_t its_flash_fs_file_create(const uint8_t *fid,
 
     /* Check if data needs to be stored in the new file */
     if (data_size != 0) {
-        if ((data_size > max_size) || (data == NULL)) {
+        if ((data_size > max_size) || (get_data == NULL)) {
             return PSA_ERROR_INVALID_ARGUMENT;
         }
 
@@ -106,7 +464,7 @@ psa_status_t its_flash_fs_file_create(const uint8_t *fid,
         err = its_flash_fs_file_write_aligned_data(&file_meta,
                                                    ITS_FLASH_FS_INIT_FILE,
                                                    data_size,
-                                                   data);
+                                                   get_data, context);
         if (err != PSA_SUCCESS) {
             return PSA_ERROR_GENERIC_ERROR;
         }
@@ -199,48 +557,94 @@ psa_status_t its_flash_fs_file_get_info(const uint8_t *fid,
     return PSA_SUCCESS;
 }
 
-psa_status_t its_flash_fs_file_write(const uint8_t *fid,
-                                     size_t size,
-                                     size_t offset,
-                                     const uint8_t *data)
+/**
+ * \brief Writes a new version of a file, with the given content, in a single
+ *        metadata update.
+ *
+ * \param[in] idx        File metadata entry index
+ * \param[in] file_meta  Pointer to the file's metadata of the new version
+ * \param[in] size       Size of the incoming buffer
+ * \param[in] offset     Offset in the file
+ * \param[in] get_data   Function to get the data to be written
+ * \param[in] context    Context given to get_data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_flash_fs_file_update(uint32_t idx,
+                                             struct its_file_meta_t *file_meta,
+                                             size_t size,
+                                             size_t offset,
+                                             its_flash_fs_get_data_t get_data,
+                                             void *context)
 {
     struct its_block_meta_t block_meta;
     uint32_t cur_phys_block;
+    uint32_t scratch_id;
     psa_status_t err;
-    uint32_t idx;
-    struct its_file_meta_t file_meta;
+    uint32_t has_gaps;
 
-    /* Get the file index */
-    err = its_flash_fs_mblock_get_file_idx(fid, &idx);
+    /* Read block metadata */
+    err = its_flash_fs_mblock_read_block_metadata(file_meta->lblock,
+                                                  &block_meta);
     if (err != PSA_SUCCESS) {
-        return PSA_ERROR_DOES_NOT_EXIST;
+        return PSA_ERROR_GENERIC_ERROR;
     }
 
-    /* Read file metadata */
-    err = its_flash_fs_mblock_read_file_meta(idx, &file_meta);
-    if (err != PSA_SUCCESS) {
-        return PSA_ERROR_DOES_NOT_EXIST;
+    /* The data of the logical block 0 is copied with any metadata change,
+     * so only the files in the other data blocks avoid a data block copy.
+     */
+    if (file_meta->lblock != ITS_LOGICAL_DBLOCK0) {
+        /* Write the new version in the free space of the data block, if it
+         * fits and has not been left programmed by an interrupted update.
+         */
+        if ((block_meta.free_size >= file_meta->max_size) &&
+            (its_flash_fs_dblock_check_erased(&block_meta,
+                                   (ITS_BLOCK_SIZE - block_meta.free_size),
+                                   file_meta->max_size) == PSA_SUCCESS)) {
+            return its_flash_fs_file_write_in_free_space(idx, file_meta,
+                                                         &block_meta, size,
+                                                         offset, get_data,
+                                                         context);
+        }
+
+        /* Otherwise, the data block is copied into the scratch data block,
+         * removing the gaps left by the previous writes, if any.
+         */
+        err = its_flash_fs_block_has_gaps(file_meta->lblock, &block_meta,
+                                          &has_gaps);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        if (has_gaps) {
+            return its_flash_fs_file_write_repacked(idx, file_meta,
+                                                    &block_meta, size,
+                                                    offset, get_data, context);
+        }
     }
 
-    /* Read block metadata */
-    err = its_flash_fs_mblock_read_block_metadata(file_meta.lblock,
-                                                  &block_meta);
+    /* Write the content into scratch data block */
+    err = its_flash_fs_file_write_aligned_data(file_meta, offset, size,
+                                               get_data, context);
     if (err != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
 
-    /* Write the content into scratch data block */
-    err = its_flash_fs_file_write_aligned_data(&file_meta, offset, size, data);
+    /* Copy the content of the previous version which is not overwritten */
+    scratch_id = its_flash_fs_mblock_cur_data_scratch_id(file_meta->lblock);
+    err = its_flash_fs_dblock_keep_file_data(scratch_id, file_meta->data_idx,
+                                             &block_meta, file_meta, offset,
+                                             size);
     if (err != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
 
-    if (size > file_meta.cur_size) {
+    if ((offset + size) > file_meta->cur_size) {
         /* Update the file metadata */
-        file_meta.cur_size = size;
+        file_meta->cur_size = (offset + size);
     }
 
-    err = its_flash_fs_dblock_cp_remaining_data(&block_meta, &file_meta);
+    err = its_flash_fs_dblock_cp_remaining_data(&block_meta, file_meta);
     if (err != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
@@ -249,20 +653,20 @@ psa_status_t its_flash_fs_file_write(const uint8_t *fid,
 
     /* Cur scratch block become the active datablock */
     block_meta.phy_id = its_flash_fs_mblock_cur_data_scratch_id(
-                                                              file_meta.lblock);
+                                                             file_meta->lblock);
 
     /* Swap the scratch data block */
-    its_flash_fs_mblock_set_data_scratch(cur_phys_block, file_meta.lblock);
+    its_flash_fs_mblock_set_data_scratch(cur_phys_block, file_meta->lblock);
 
     /* Update block metadata in scratch metadata block */
-    err = its_flash_fs_mblock_update_scratch_block_meta(file_meta.lblock,
+    err = its_flash_fs_mblock_update_scratch_block_meta(file_meta->lblock,
                                                         &block_meta);
     if (err != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
 
     /* Update file metadata to reflect new attributes */
-    err = its_flash_fs_mblock_update_scratch_file_meta(idx, &file_meta);
+    err = its_flash_fs_mblock_update_scratch_file_meta(idx, file_meta);
     if (err != PSA_SUCCESS) {
         return PSA_ERROR_GENERIC_ERROR;
     }
@@ -281,7 +685,7 @@ psa_status_t its_flash_fs_file_write(const uint8_t *fid,
      * file data is located in the logical block 0, that copy has been done
      * while processing the file data.
      */
-    if (file_meta.lblock != ITS_LOGICAL_DBLOCK0) {
+    if (file_meta->lblock != ITS_LOGICAL_DBLOCK0) {
         err = its_flash_fs_mblock_migrate_lb0_data_to_scratch();
         if (err != PSA_SUCCESS) {
             return PSA_ERROR_GENERIC_ERROR;
@@ -294,6 +698,132 @@ psa_status_t its_flash_fs_file_write(const uint8_t *fid,
     return its_flash_fs_mblock_meta_update_finalize();
 }
 
+psa_status_t its_flash_fs_file_write(const uint8_t *fid,
+                                     size_t size,
+                                     size_t offset,
+                                     its_flash_fs_get_data_t get_data,
+                                     void *context)
+{
+    psa_status_t err;
+    uint32_t idx;
+    struct its_file_meta_t file_meta;
+
+    /* Get the file index */
+    err = its_flash_fs_mblock_get_file_idx(fid, &idx);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    /* Read file metadata */
+    err = its_flash_fs_mblock_read_file_meta(idx, &file_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_DOES_NOT_EXIST;
+    }
+
+    /* Boundary check the incoming request */
+    err = its_utils_check_contained_in(file_meta.max_size, offset, size);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+#if (ITS_FLASH_PROGRAM_UNIT != 1)
+    /* The content after the written data is kept, so the end of the write
+     * must not fall inside a program unit which holds some of that content.
+     */
+    if (((offset + size) < file_meta.cur_size) &&
+        (GET_ALIGNED_FLASH_BYTES(offset + size) != (offset + size))) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+#endif /* (ITS_FLASH_PROGRAM_UNIT != 1) */
+
+    return its_flash_fs_file_update(idx, &file_meta, size, offset, get_data,
+                                    context);
+}
+
+psa_status_t its_flash_fs_file_replace(const uint8_t *fid,
+                                       size_t max_size,
+                                       size_t data_size,
+                                       uint32_t flags,
+                                       its_flash_fs_get_data_t get_data,
+                                       void *context)
+{
+    struct its_block_meta_t block_meta;
+    psa_status_t err;
+    uint32_t idx;
+    struct its_file_meta_t file_meta;
+    size_t used_size;
+
+    /* Get the file index */
+    err = its_flash_fs_mblock_get_file_idx(fid, &idx);
+    if (err != PSA_SUCCESS) {
+        /* There is no previous version to replace */
+        return its_flash_fs_file_create(fid, max_size, data_size, flags,
+                                        get_data, context);
+    }
+
+    /* Read file metadata */
+    err = its_flash_fs_mblock_read_file_meta(idx, &file_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    if ((data_size > max_size) || ((data_size != 0) && (get_data == NULL))) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
+#if (ITS_FLASH_PROGRAM_UNIT != 1)
+    /* Set the max_size to be aligned with ITS_FLASH_PROGRAM_UNIT */
+    max_size = GET_ALIGNED_FLASH_BYTES(max_size);
+#endif
+
+    /* The new version keeps the file metadata entry of the previous one, so
+     * the file is never absent from the filesystem.
+     */
+    file_meta.flags = flags;
+    file_meta.cur_size = 0;
+
+    if (max_size == file_meta.max_size) {
+        /* The new version takes the same space as the previous one */
+        return its_flash_fs_file_update(idx, &file_meta, data_size,
+                                        ITS_FLASH_FS_INIT_FILE, get_data,
+                                        context);
+    }
+
+    /* Read block metadata */
+    err = its_flash_fs_mblock_read_block_metadata(file_meta.lblock,
+                                                  &block_meta);
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    err = its_flash_fs_block_used_size(file_meta.lblock, idx, &used_size);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    if ((ITS_BLOCK_SIZE - block_meta.data_start - used_size) >= max_size) {
+        /* The new version fits in the data block once the previous version
+         * and the gaps are removed.
+         */
+        file_meta.max_size = max_size;
+        return its_flash_fs_file_write_repacked(idx, &file_meta, &block_meta,
+                                                data_size,
+                                                ITS_FLASH_FS_INIT_FILE,
+                                                get_data, context);
+    }
+
+    /* The new version has to be moved to another data block, which requires
+     * a change in two data blocks, so it is done in two metadata updates.
+     */
+    err = its_flash_fs_file_delete(fid);
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    return its_flash_fs_file_create(fid, max_size, data_size, flags, get_data,
+                                    context);
+}
+
 psa_status_t its_flash_fs_file_delete(const uint8_t *fid)
 {
     size_t del_file_data_idx;
@@ -305,6 +835,9 @@ psa_status_t its_flash_fs_file_delete(const uint8_t *fid)
     size_t nbr_bytes_to_move = 0;
     uint32_t idx;
     struct its_file_meta_t file_meta;
+    struct its_block_meta_t block_meta;
+    uint32_t cur_phys_block;
+    uint32_t has_gaps = 0;
 
     /* Get the file index */
     err = its_flash_fs_mblock_get_file_idx(fid, &del_file_idx);
@@ -326,6 +859,20 @@ psa_status_t its_flash_fs_file_delete(const uint8_t *fid)
     del_file_data_idx = file_meta.data_idx;
     del_file_max_size = file_meta.max_size;
 
+    if (del_file_lblock != ITS_LOGICAL_DBLOCK0) {
+        err = its_flash_fs_mblock_read_block_metadata(del_file_lblock,
+                                                      &block_meta);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        err = its_flash_fs_block_has_gaps(del_file_lblock, &block_meta,
+                                          &has_gaps);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+
     /* Remove file metadata */
     file_meta = (struct its_file_meta_t){0};
 
@@ -336,6 +883,43 @@ psa_status_t its_flash_fs_file_delete(const uint8_t *fid)
         return err;
     }
 
+    if (has_gaps) {
+        /* The data after the deleted file is not contiguous, so the remaining
+         * files are copied one by one, which removes the gaps as well.
+         */
+        err = its_flash_fs_repack_block(del_file_lblock, del_file_idx,
+                                        &block_meta);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        cur_phys_block = block_meta.phy_id;
+
+        /* Cur scratch block become the active datablock */
+        block_meta.phy_id = its_flash_fs_mblock_cur_data_scratch_id(
+                                                               del_file_lblock);
+
+        /* Swap the scratch data block */
+        its_flash_fs_mblock_set_data_scratch(cur_phys_block, del_file_lblock);
+
+        /* Update block metadata in scratch metadata block */
+        err = its_flash_fs_mblock_update_scratch_block_meta(del_file_lblock,
+                                                            &block_meta);
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        err = its_flash_fs_mblock_migrate_lb0_data_to_scratch();
+        if (err != PSA_SUCCESS) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+
+        /* Update the metablock header, swap scratch and active blocks,
+         * erase scratch blocks.
+         */
+        return its_flash_fs_mblock_meta_update_finalize();
+    }
+
     /* Read all file metadata */
     for (idx = 0; idx < ITS_MAX_NUM_FILES; idx++) {
         if (idx == del_file_idx) {
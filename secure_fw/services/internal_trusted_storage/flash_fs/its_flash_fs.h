@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -25,6 +25,19 @@
 extern "C" {
 #endif
 
+/**
+ * \brief Gets the next chunk of the data to be written in a file. The data
+ *        is requested in order, from the start of the data to its end.
+ *
+ * \param[in]  context  Context given with the function to the filesystem
+ * \param[out] buf      Buffer to store the chunk
+ * \param[in]  size     Size of the chunk
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+typedef psa_status_t (*its_flash_fs_get_data_t)(void *context, uint8_t *buf,
+                                                size_t size);
+
 /*!
  * \struct its_file_info_t
  *
@@ -71,9 +84,10 @@ psa_status_t its_flash_fs_file_exist(const uint8_t *fid);
  * \param[in] data_size  Size of the incoming buffer. This parameter is set to 0
  *                       when the file is empty after the creation.
  * \param[in] flags      Flags of the file
- * \param[in] data       Pointer to buffer containing the initial data.
+ * \param[in] get_data   Function to get the initial data in chunks.
  *                       This parameter is set to NULL when the file is empty
  *                       after the creation.
+ * \param[in] context    Context given to get_data
  *
  * \return Returns PSA_SUCCESS if the file has been created correctly. If the
  *         fid is in use, it returns PSA_ERROR_INVALID_ARGUMENT. Otherwise, it
@@ -83,7 +97,8 @@ psa_status_t its_flash_fs_file_create(const uint8_t *fid,
                                       size_t max_size,
                                       size_t data_size,
                                       uint32_t flags,
-                                      const uint8_t *data);
+                                      its_flash_fs_get_data_t get_data,
+                                      void *context);
 
 /**
  * \brief Gets the file information referenced by the file ID.
@@ -100,17 +115,46 @@ psa_status_t its_flash_fs_file_get_info(const uint8_t *fid,
 /**
  * \brief Writes data to an existing file.
  *
- * \param[in] fid     File ID
- * \param[in] size    Size of the incoming buffer
- * \param[in] offset  Offset in the file
- * \param[in] data    Pointer to buffer containing data to be written
+ * \param[in] fid       File ID
+ * \param[in] size      Size of the incoming data
+ * \param[in] offset    Offset in the file
+ * \param[in] get_data  Function to get the data to be written in chunks
+ * \param[in] context   Context given to get_data
  *
  * \return Returns error code as specified in \ref psa_status_t
  */
 psa_status_t its_flash_fs_file_write(const uint8_t *fid,
                                      size_t size,
                                      size_t offset,
-                                     const uint8_t *data);
+                                     its_flash_fs_get_data_t get_data,
+                                     void *context);
+
+/**
+ * \brief Replaces the content and flags of a file, or creates the file if it
+ *        does not exist.
+ *
+ * \details The new version is written in a single metadata update, so the
+ *          file is not absent from the filesystem at any point, unless it has
+ *          to be moved to another data block to fit its new size.
+ *
+ * \param[in] fid        File ID
+ * \param[in] max_size   Size of the file after the replacement
+ * \param[in] data_size  Size of the incoming buffer. This parameter is set to 0
+ *                       when the file is empty after the replacement.
+ * \param[in] flags      Flags of the file
+ * \param[in] get_data   Function to get the new data in chunks.
+ *                       This parameter is set to NULL when the file is empty
+ *                       after the replacement.
+ * \param[in] context    Context given to get_data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_file_replace(const uint8_t *fid,
+                                       size_t max_size,
+                                       size_t data_size,
+                                       uint32_t flags,
+                                       its_flash_fs_get_data_t get_data,
+                                       void *context);
 
 /**
  * \brief Reads data from an existing file.
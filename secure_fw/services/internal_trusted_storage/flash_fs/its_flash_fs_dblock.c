@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -7,8 +7,12 @@
 
 #include "its_flash_fs_dblock.h"
 
+#include "tfm_memory_utils.h"
 #include "secure_fw/services/internal_trusted_storage/flash/its_flash.h"
 
+/* Number of bytes read at a time to check that a region is erased */
+#define ITS_ERASED_CHECK_SIZE 32
+
 /**
  * \brief Converts logical data block number to physical number.
  *
@@ -29,6 +33,57 @@ static uint32_t its_dblock_lo_to_phy(uint32_t lblock)
     return block_meta.phy_id;
 }
 
+/**
+ * \brief Writes data in a block, getting it in chunks.
+ *
+ * \param[in] block_id  Physical block ID
+ * \param[in] offset    Offset in the block, aligned with ITS_FLASH_PROGRAM_UNIT
+ * \param[in] size      Size of the data
+ * \param[in] get_data  Function to get the data in chunks
+ * \param[in] context   Context given to get_data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_dblock_write_data(uint32_t block_id,
+                                          size_t offset,
+                                          size_t size,
+                                          its_flash_fs_get_data_t get_data,
+                                          void *context)
+{
+    uint8_t buf[GET_ALIGNED_FLASH_BYTES(ITS_BUF_SIZE)];
+    size_t bytes_to_write;
+    size_t aligned_bytes;
+    psa_status_t err;
+
+    while (size > 0) {
+        bytes_to_write = ITS_UTILS_MIN(size, sizeof(buf));
+
+        err = get_data(context, buf, bytes_to_write);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        /* Only the last chunk can be smaller than the buffer. Pad it up to a
+         * multiple of ITS_FLASH_PROGRAM_UNIT.
+         */
+        aligned_bytes = GET_ALIGNED_FLASH_BYTES(bytes_to_write);
+        if (aligned_bytes > bytes_to_write) {
+            (void)tfm_memset(&buf[bytes_to_write], ITS_DEFAULT_EMPTY_BUFF_VAL,
+                             (aligned_bytes - bytes_to_write));
+        }
+
+        err = its_flash_write(block_id, buf, offset, aligned_bytes);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        offset += aligned_bytes;
+        size -= bytes_to_write;
+    }
+
+    return PSA_SUCCESS;
+}
+
 psa_status_t its_flash_fs_dblock_compact_block(uint32_t lblock,
                                                size_t free_size,
                                                size_t src_offset,
@@ -50,6 +105,7 @@ psa_status_t its_flash_fs_dblock_compact_block(uint32_t lblock,
 
     /* Save scratch data block physical IDs */
     scratch_id = its_flash_fs_mblock_cur_data_scratch_id(lblock);
+    its_flash_fs_mblock_mark_scratch_used(lblock);
 
     /* Check if there are bytes to be compacted */
     if (size > 0) {
@@ -113,6 +169,7 @@ psa_status_t its_flash_fs_dblock_cp_data_to_scratch(uint32_t lblock,
 
     /* Get the scratch data block ID to write the data */
     scratch_id = its_flash_fs_mblock_cur_data_scratch_id(lblock);
+    its_flash_fs_mblock_mark_scratch_used(lblock);
 
     /* Data after updated content */
     return its_flash_block_to_block_move(scratch_id, offset,
@@ -141,13 +198,112 @@ psa_status_t its_flash_fs_dblock_read_file(struct its_file_meta_t *file_meta,
 psa_status_t its_flash_fs_dblock_write_file(uint32_t lblock,
                                             size_t offset,
                                             size_t size,
-                                            const uint8_t *data)
+                                            its_flash_fs_get_data_t get_data,
+                                            void *context)
 {
     uint32_t scratch_id;
 
     scratch_id = its_flash_fs_mblock_cur_data_scratch_id(lblock);
+    its_flash_fs_mblock_mark_scratch_used(lblock);
+
+    return its_dblock_write_data(scratch_id, offset, size, get_data, context);
+}
+
+psa_status_t its_flash_fs_dblock_check_erased(
+                                      const struct its_block_meta_t *block_meta,
+                                      size_t offset,
+                                      size_t size)
+{
+    uint8_t buf[ITS_ERASED_CHECK_SIZE];
+    size_t bytes_to_check;
+    psa_status_t err;
+    size_t i;
+
+    while (size > 0) {
+        bytes_to_check = ITS_UTILS_MIN(size, ITS_ERASED_CHECK_SIZE);
+
+        err = its_flash_read(block_meta->phy_id, buf, offset, bytes_to_check);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+
+        for (i = 0; i < bytes_to_check; i++) {
+            if (buf[i] != ITS_FLASH_DEFAULT_VAL) {
+                /* Left programmed by an update interrupted by a power
+                 * failure.
+                 */
+                return PSA_ERROR_STORAGE_FAILURE;
+            }
+        }
+
+        offset += bytes_to_check;
+        size -= bytes_to_check;
+    }
+
+    return PSA_SUCCESS;
+}
+
+psa_status_t its_flash_fs_dblock_write_active(
+                                      const struct its_block_meta_t *block_meta,
+                                      size_t offset,
+                                      size_t size,
+                                      its_flash_fs_get_data_t get_data,
+                                      void *context)
+{
+    return its_dblock_write_data(block_meta->phy_id, offset, size, get_data,
+                                 context);
+}
+
+psa_status_t its_flash_fs_dblock_move_file_to_scratch(
+                                      const struct its_block_meta_t *block_meta,
+                                      const struct its_file_meta_t *file_meta,
+                                      size_t dst_offset)
+{
+    uint32_t scratch_id;
+
+    scratch_id = its_flash_fs_mblock_cur_data_scratch_id(file_meta->lblock);
+    its_flash_fs_mblock_mark_scratch_used(file_meta->lblock);
+
+    return its_flash_block_to_block_move(scratch_id, dst_offset,
+                                         block_meta->phy_id,
+                                         file_meta->data_idx,
+                                         file_meta->max_size);
+}
+
+psa_status_t its_flash_fs_dblock_keep_file_data(
+                                      uint32_t dst_block,
+                                      size_t dst_idx,
+                                      const struct its_block_meta_t *block_meta,
+                                      const struct its_file_meta_t *file_meta,
+                                      size_t offset,
+                                      size_t size)
+{
+    size_t cur_size = GET_ALIGNED_FLASH_BYTES(file_meta->cur_size);
+    size_t end = offset + size;
+    psa_status_t err;
+
+    /* Content before the written data */
+    if ((offset > 0) && (cur_size > 0)) {
+        err = its_flash_block_to_block_move(dst_block, dst_idx,
+                                            block_meta->phy_id,
+                                            file_meta->data_idx,
+                                            ITS_UTILS_MIN(offset, cur_size));
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+
+    /* Content after the written data. The caller makes sure that the end of
+     * the write is aligned with ITS_FLASH_PROGRAM_UNIT in that case.
+     */
+    if (end < file_meta->cur_size) {
+        return its_flash_block_to_block_move(dst_block, (dst_idx + end),
+                                             block_meta->phy_id,
+                                             (file_meta->data_idx + end),
+                                             (cur_size - end));
+    }
 
-    return its_flash_write(scratch_id, data, offset, size);
+    return PSA_SUCCESS;
 }
 
 psa_status_t its_flash_fs_dblock_cp_remaining_data(
@@ -160,6 +316,7 @@ psa_status_t its_flash_fs_dblock_cp_remaining_data(
     size_t wrt_bytes;
 
     scratch_id = its_flash_fs_mblock_cur_data_scratch_id(file_meta->lblock);
+    its_flash_fs_mblock_mark_scratch_used(file_meta->lblock);
 
     if (file_meta->data_idx > block_meta->data_start) {
         /* Move data before the referenced file */
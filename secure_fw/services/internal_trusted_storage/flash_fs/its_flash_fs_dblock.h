@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -12,6 +12,7 @@
 #include <stdint.h>
 
 #include "psa/error.h"
+#include "its_flash_fs.h"
 #include "its_flash_fs_mblock.h"
 
 #ifdef __cplusplus
@@ -71,19 +72,92 @@ psa_status_t its_flash_fs_dblock_read_file(struct its_file_meta_t *file_meta,
  * \brief Writes scratch data block content with requested data
  *        and the rest of the data from the given logical block.
  *
- * \param[in] lblock      Current logical data block
- * \param[in] offset      Offset in the scratch data block where to start the
- *                        copy of the incoming data
- * \param[in] size        Size of the incoming data
- * \param[in] data        Pointer to data buffer to copy in the scratch data
- *                        block
+ * \param[in] lblock    Current logical data block
+ * \param[in] offset    Offset in the scratch data block where to start the
+ *                      copy of the incoming data
+ * \param[in] size      Size of the incoming data
+ * \param[in] get_data  Function to get the data to copy in the scratch data
+ *                      block in chunks
+ * \param[in] context   Context given to get_data
  *
  * \return Returns error code as specified in \ref psa_status_t
  */
 psa_status_t its_flash_fs_dblock_write_file(uint32_t lblock,
                                             size_t offset,
                                             size_t size,
-                                            const uint8_t *data);
+                                            its_flash_fs_get_data_t get_data,
+                                            void *context);
+
+/**
+ * \brief Checks that a region of the active data block is erased, so that it
+ *        can be programmed without a block swap.
+ *
+ * \param[in] block_meta  Pointer to block meta of the data block
+ * \param[in] offset      Offset in the data block
+ * \param[in] size        Size of the region
+ *
+ * \return Returns PSA_SUCCESS if the region is erased. Otherwise, it returns
+ *         error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_dblock_check_erased(
+                                      const struct its_block_meta_t *block_meta,
+                                      size_t offset,
+                                      size_t size);
+
+/**
+ * \brief Writes data in the active data block, in a region which is erased.
+ *
+ * \param[in] block_meta  Pointer to block meta of the data block
+ * \param[in] offset      Offset in the data block
+ * \param[in] size        Size of the incoming data
+ * \param[in] get_data    Function to get the data to write in the data block
+ *                        in chunks
+ * \param[in] context     Context given to get_data
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_dblock_write_active(
+                                      const struct its_block_meta_t *block_meta,
+                                      size_t offset,
+                                      size_t size,
+                                      its_flash_fs_get_data_t get_data,
+                                      void *context);
+
+/**
+ * \brief Copies the data of a file into the scratch data block, at the given
+ *        offset.
+ *
+ * \param[in] block_meta  Pointer to block meta of the file's data block
+ * \param[in] file_meta   Pointer to file's metadata
+ * \param[in] dst_offset  Offset in the scratch data block
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_dblock_move_file_to_scratch(
+                                      const struct its_block_meta_t *block_meta,
+                                      const struct its_file_meta_t *file_meta,
+                                      size_t dst_offset);
+
+/**
+ * \brief Copies the content of a file, which is not overwritten by a write
+ *        in the file, to a new location of the file.
+ *
+ * \param[in] dst_block   Physical ID of the data block of the new location
+ * \param[in] dst_idx     Data index of the new location
+ * \param[in] block_meta  Pointer to block meta of the file's data block
+ * \param[in] file_meta   Pointer to file's metadata, before the write
+ * \param[in] offset      Offset of the write in the file
+ * \param[in] size        Size of the write
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+psa_status_t its_flash_fs_dblock_keep_file_data(
+                                      uint32_t dst_block,
+                                      size_t dst_idx,
+                                      const struct its_block_meta_t *block_meta,
+                                      const struct its_file_meta_t *file_meta,
+                                      size_t offset,
+                                      size_t size);
 
 /**
  * \brief Writes logical block data, which is not related with the file
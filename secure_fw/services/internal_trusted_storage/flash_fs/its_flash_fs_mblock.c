@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -105,10 +105,71 @@ struct its_flash_fs_context_t {
                                                            */
     uint32_t active_metablock;           /*!< Active metadata block */
     uint32_t scratch_metablock;          /*!< Scratch meta block */
+    uint8_t scratch_dblock_used;         /*!< Indicates whether the data
+                                          *   section's scratch block may have
+                                          *   been written since it was last
+                                          *   erased
+                                          */
 };
 
 static struct its_flash_fs_context_t its_flash_fs_ctx;
 
+#ifdef ITS_METADATA_CACHE
+/*!
+ * \struct its_mblock_cache_t
+ *
+ * \brief Structure to store a RAM copy of the block and file metadata of a
+ *        metadata block.
+ */
+struct its_mblock_cache_t {
+    struct its_block_meta_t block_meta[ITS_NUM_ACTIVE_DBLOCKS]; /*!< Block
+                                                                 *   metadata
+                                                                 */
+    struct its_file_meta_t file_meta[ITS_MAX_NUM_FILES];        /*!< File
+                                                                 *   metadata
+                                                                 */
+};
+
+/* Metadata cache of each metadata block, indexed by physical block ID. The
+ * scratch metadata block cache is written through with the scratch metadata
+ * block, so that it is up to date when the metadata blocks are swapped.
+ */
+static struct its_mblock_cache_t its_mblock_cache[2];
+
+/* Number of bits of the file ID hash, so that the file index has at least
+ * twice as many slots as there are files.
+ */
+#if (ITS_MAX_NUM_FILES <= 8)
+#define ITS_FID_INDEX_BITS 4
+#elif (ITS_MAX_NUM_FILES <= 16)
+#define ITS_FID_INDEX_BITS 5
+#elif (ITS_MAX_NUM_FILES <= 32)
+#define ITS_FID_INDEX_BITS 6
+#elif (ITS_MAX_NUM_FILES <= 64)
+#define ITS_FID_INDEX_BITS 7
+#elif (ITS_MAX_NUM_FILES <= 128)
+#define ITS_FID_INDEX_BITS 8
+#elif (ITS_MAX_NUM_FILES <= 256)
+#define ITS_FID_INDEX_BITS 9
+#elif (ITS_MAX_NUM_FILES <= 512)
+#define ITS_FID_INDEX_BITS 10
+#else
+#error "ITS_MAX_NUM_FILES is too large for the file ID index"
+#endif
+
+/* Number of slots in the file ID index */
+#define ITS_FID_INDEX_SLOTS  (1U << ITS_FID_INDEX_BITS)
+#define ITS_FID_INDEX_MASK   (ITS_FID_INDEX_SLOTS - 1U)
+
+/* Value of an empty file ID index slot */
+#define ITS_FID_INDEX_EMPTY  0U
+
+/* Open addressing hash table of file metadata entry index + 1, keyed by the
+ * file ID, for the files of the active metadata block.
+ */
+static uint16_t its_fid_index[ITS_FID_INDEX_SLOTS];
+#endif /* ITS_METADATA_CACHE */
+
 #define ITS_BLOCK_META_HEADER_SIZE  sizeof(struct its_metadata_block_header_t)
 #define ITS_BLOCK_METADATA_SIZE     sizeof(struct its_block_meta_t)
 #define ITS_FILE_METADATA_SIZE      sizeof(struct its_file_meta_t)
@@ -185,6 +246,59 @@ static inline uint32_t its_mblock_cur_meta_active(void)
     return its_flash_fs_ctx.active_metablock;
 }
 
+#ifdef ITS_METADATA_CACHE
+/**
+ * \brief Gets the file ID index slot where the search for a file ID starts.
+ *
+ * \param[in] fid  ID of the file
+ *
+ * \return Returns the slot number
+ */
+static uint32_t its_fid_index_hash(const uint8_t *fid)
+{
+    uint32_t hash = 0x811C9DC5U;
+    uint32_t i;
+
+    for (i = 0; i < ITS_FILE_ID_SIZE; i++) {
+        hash = (hash ^ fid[i]) * 0x01000193U;
+    }
+
+    return (hash * 0x9E3779B1U) >> (32U - ITS_FID_INDEX_BITS);
+}
+
+/**
+ * \brief Rebuilds the file ID index from the cache of the active metadata
+ *        block.
+ */
+static void its_fid_index_rebuild(void)
+{
+    const struct its_mblock_cache_t *cache =
+                            &its_mblock_cache[its_flash_fs_ctx.active_metablock];
+    uint32_t slot;
+    uint32_t i;
+
+    (void)tfm_memset(its_fid_index, 0, sizeof(its_fid_index));
+
+    for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+        if (its_utils_validate_fid(cache->file_meta[i].id) != PSA_SUCCESS) {
+            /* Free entry */
+            continue;
+        }
+
+        /* The index has more slots than there are files, so an empty slot is
+         * always found.
+         */
+        slot = its_fid_index_hash(cache->file_meta[i].id);
+        while (its_fid_index[slot] != ITS_FID_INDEX_EMPTY) {
+            slot = (slot + 1U) & ITS_FID_INDEX_MASK;
+        }
+
+        its_fid_index[slot] = (uint16_t)(i + 1U);
+    }
+}
+
+#endif /* ITS_METADATA_CACHE */
+
 /**
  * \brief Swaps metablocks. Scratch becomes active and active becomes scratch.
  */
@@ -195,6 +309,11 @@ static void its_mblock_swap_metablocks(void)
     tmp_block = its_flash_fs_ctx.scratch_metablock;
     its_flash_fs_ctx.scratch_metablock = its_flash_fs_ctx.active_metablock;
     its_flash_fs_ctx.active_metablock = tmp_block;
+
+#ifdef ITS_METADATA_CACHE
+    /* The cache of the new active metadata block has been written through */
+    its_fid_index_rebuild();
+#endif
 }
 
 /**
@@ -354,6 +473,63 @@ static inline psa_status_t its_mblock_validate_block_meta(
 }
 #endif
 
+#ifdef ITS_METADATA_CACHE
+/**
+ * \brief Loads the block and file metadata of the active metadata block into
+ *        its cache.
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t its_mblock_cache_load(void)
+{
+    struct its_mblock_cache_t *cache =
+                            &its_mblock_cache[its_flash_fs_ctx.active_metablock];
+    psa_status_t err;
+#ifdef ITS_VALIDATE_METADATA_FROM_FLASH
+    uint32_t i;
+#endif
+
+    err = its_flash_read(its_flash_fs_ctx.active_metablock,
+                         (uint8_t *)cache->block_meta,
+                         its_mblock_block_meta_offset(ITS_LOGICAL_DBLOCK0),
+                         sizeof(cache->block_meta));
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+    err = its_flash_read(its_flash_fs_ctx.active_metablock,
+                         (uint8_t *)cache->file_meta,
+                         its_mblock_file_meta_offset(0),
+                         sizeof(cache->file_meta));
+    if (err != PSA_SUCCESS) {
+        return err;
+    }
+
+#ifdef ITS_VALIDATE_METADATA_FROM_FLASH
+    /* The metadata is only read from flash here, so it is validated once
+     * when the cache is filled instead of every time it is read from RAM.
+     */
+    for (i = 0; i < ITS_NUM_ACTIVE_DBLOCKS; i++) {
+        err = its_mblock_validate_block_meta(&cache->block_meta[i]);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+
+    for (i = 0; i < ITS_MAX_NUM_FILES; i++) {
+        err = its_mblock_validate_file_meta(&cache->file_meta[i]);
+        if (err != PSA_SUCCESS) {
+            return err;
+        }
+    }
+#endif
+
+    its_fid_index_rebuild();
+
+    return PSA_SUCCESS;
+}
+#endif /* ITS_METADATA_CACHE */
+
 /**
  * \brief Gets a free file metadata table entry.
  *
@@ -411,9 +587,16 @@ static psa_status_t its_mblock_erase_scratch_blocks(void)
      * that all data is stored in the metadata block.
      */
 #if (ITS_TOTAL_NUM_OF_BLOCKS > 2)
-    scratch_datablock = its_flash_fs_mblock_cur_data_scratch_id(
-                                                     (ITS_LOGICAL_DBLOCK0 + 1));
-    err = its_flash_erase_block(scratch_datablock);
+    /* An update which only programs erased space of the active data blocks
+     * leaves the scratch data block erased, so it is not erased again.
+     */
+    if (its_flash_fs_ctx.scratch_dblock_used) {
+        scratch_datablock = its_flash_fs_ctx.meta_block_header.scratch_dblock;
+        err = its_flash_erase_block(scratch_datablock);
+        if (err == PSA_SUCCESS) {
+            its_flash_fs_ctx.scratch_dblock_used = 0;
+        }
+    }
 #endif
 
     return err;
@@ -435,6 +618,11 @@ static psa_status_t its_mblock_update_scratch_block_meta(uint32_t lblock,
     size_t pos;
 
     meta_block = its_cur_meta_scratch_id();
+
+#ifdef ITS_METADATA_CACHE
+    its_mblock_cache[meta_block].block_meta[lblock] = *block_meta;
+#endif
+
     /* Calculate the position */
     pos = its_mblock_block_meta_offset(lblock);
     return its_flash_write(meta_block, (const uint8_t *)block_meta, pos,
@@ -500,9 +688,26 @@ static psa_status_t its_mblock_copy_remaining_block_meta(uint32_t lblock)
             if (err != PSA_SUCCESS) {
                 return err;
             }
+
+#ifdef ITS_METADATA_CACHE
+            (void)tfm_memcpy(
+                    &its_mblock_cache[scratch_block].block_meta[1],
+                    &its_mblock_cache[meta_block].block_meta[1],
+                    ((lblock - 1) * ITS_BLOCK_METADATA_SIZE));
+#endif
         }
     }
 
+#ifdef ITS_METADATA_CACHE
+    if ((lblock + 1) < ITS_NUM_ACTIVE_DBLOCKS) {
+        (void)tfm_memcpy(
+                &its_mblock_cache[scratch_block].block_meta[lblock + 1],
+                &its_mblock_cache[meta_block].block_meta[lblock + 1],
+                ((ITS_NUM_ACTIVE_DBLOCKS - (lblock + 1)) *
+                 ITS_BLOCK_METADATA_SIZE));
+    }
+#endif
+
     /* Move meta blocks data after updated content */
     pos = its_mblock_block_meta_offset(lblock+1);
 
@@ -737,6 +942,19 @@ psa_status_t its_flash_fs_mblock_cp_remaining_file_meta(uint32_t idx)
 
     scratch_block = its_cur_meta_scratch_id();
     meta_block = its_mblock_cur_meta_active();
+
+#ifdef ITS_METADATA_CACHE
+    (void)tfm_memcpy(its_mblock_cache[scratch_block].file_meta,
+                     its_mblock_cache[meta_block].file_meta,
+                     (idx * ITS_FILE_METADATA_SIZE));
+    if ((idx + 1) < ITS_MAX_NUM_FILES) {
+        (void)tfm_memcpy(&its_mblock_cache[scratch_block].file_meta[idx + 1],
+                         &its_mblock_cache[meta_block].file_meta[idx + 1],
+                         ((ITS_MAX_NUM_FILES - (idx + 1)) *
+                          ITS_FILE_METADATA_SIZE));
+    }
+#endif
+
     /* Calculate the position */
     pos = its_mblock_file_meta_offset(0);
     /* Copy rest of the block data from previous block */
@@ -772,8 +990,36 @@ uint32_t its_flash_fs_mblock_cur_data_scratch_id(uint32_t lblock)
     return its_flash_fs_ctx.meta_block_header.scratch_dblock;
 }
 
+void its_flash_fs_mblock_mark_scratch_used(uint32_t lblock)
+{
+    /* The scratch block of logical data block 0 is the scratch metadata
+     * block, which is always erased by the finalization.
+     */
+    if (lblock != ITS_LOGICAL_DBLOCK0) {
+        its_flash_fs_ctx.scratch_dblock_used = 1;
+    }
+}
+
 psa_status_t its_flash_fs_mblock_get_file_idx(const uint8_t *fid, uint32_t *idx)
 {
+#ifdef ITS_METADATA_CACHE
+    const struct its_mblock_cache_t *cache =
+                            &its_mblock_cache[its_flash_fs_ctx.active_metablock];
+    uint32_t slot = its_fid_index_hash(fid);
+    uint32_t i;
+
+    while (its_fid_index[slot] != ITS_FID_INDEX_EMPTY) {
+        i = its_fid_index[slot] - 1U;
+        if (!tfm_memcmp(cache->file_meta[i].id, fid, ITS_FILE_ID_SIZE)) {
+            /* Found */
+            *idx = i;
+            return PSA_SUCCESS;
+        }
+        slot = (slot + 1U) & ITS_FID_INDEX_MASK;
+    }
+
+    return PSA_ERROR_DOES_NOT_EXIST;
+#else
     psa_status_t err;
     uint32_t i;
     struct its_file_meta_t tmp_metadata;
@@ -793,6 +1039,7 @@ psa_status_t its_flash_fs_mblock_get_file_idx(const uint8_t *fid, uint32_t *idx)
     }
 
     return PSA_ERROR_DOES_NOT_EXIST;
+#endif /* ITS_METADATA_CACHE */
 }
 
 psa_status_t its_flash_fs_mblock_init(void)
@@ -815,6 +1062,16 @@ psa_status_t its_flash_fs_mblock_init(void)
         return PSA_ERROR_GENERIC_ERROR;
     }
 
+#ifdef ITS_METADATA_CACHE
+    err = its_mblock_cache_load();
+    if (err != PSA_SUCCESS) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+#endif
+
+    /* The scratch data block content is unknown after a reset */
+    its_flash_fs_ctx.scratch_dblock_used = 1;
+
     /* Erase the other scratch metadata block */
     return its_mblock_erase_scratch_blocks();
 }
@@ -868,14 +1125,21 @@ psa_status_t its_flash_fs_mblock_read_file_meta(uint32_t idx,
                                              struct its_file_meta_t *file_meta)
 {
     psa_status_t err;
+#ifdef ITS_METADATA_CACHE
+    *file_meta = its_mblock_cache[its_flash_fs_ctx.active_metablock]
+                                                             .file_meta[idx];
+    err = PSA_SUCCESS;
+#else
     size_t offset;
 
     offset = its_mblock_file_meta_offset(idx);
     err = its_flash_read(its_flash_fs_ctx.active_metablock,
                          (uint8_t *)file_meta, offset,
                          ITS_FILE_METADATA_SIZE);
+#endif /* ITS_METADATA_CACHE */
 
-#ifdef ITS_VALIDATE_METADATA_FROM_FLASH
+#if defined(ITS_VALIDATE_METADATA_FROM_FLASH) && !defined(ITS_METADATA_CACHE)
+    /* The cached metadata is validated when the cache is filled from flash */
     if (err == PSA_SUCCESS) {
         err = its_mblock_validate_file_meta(file_meta);
     }
@@ -889,14 +1153,22 @@ psa_status_t its_flash_fs_mblock_read_block_metadata(uint32_t lblock,
 {
     psa_status_t err;
     uint32_t metablock;
+#ifndef ITS_METADATA_CACHE
     size_t pos;
+#endif
 
     metablock = its_mblock_cur_meta_active();
+#ifdef ITS_METADATA_CACHE
+    *block_meta = its_mblock_cache[metablock].block_meta[lblock];
+    err = PSA_SUCCESS;
+#else
     pos = its_mblock_block_meta_offset(lblock);
     err = its_flash_read(metablock, (uint8_t *)block_meta,
                          pos, ITS_BLOCK_METADATA_SIZE);
+#endif /* ITS_METADATA_CACHE */
 
-#ifdef ITS_VALIDATE_METADATA_FROM_FLASH
+#if defined(ITS_VALIDATE_METADATA_FROM_FLASH) && !defined(ITS_METADATA_CACHE)
+    /* The cached metadata is validated when the cache is filled from flash */
     if (err == PSA_SUCCESS) {
         err = its_mblock_validate_block_meta(block_meta);
     }
@@ -956,6 +1228,7 @@ psa_status_t its_flash_fs_mblock_reset_metablock(void)
     its_flash_fs_ctx.meta_block_header.fs_version = ITS_SUPPORTED_VERSION;
     its_flash_fs_ctx.scratch_metablock = ITS_METADATA_BLOCK1;
     its_flash_fs_ctx.active_metablock = ITS_METADATA_BLOCK0;
+    its_flash_fs_ctx.scratch_dblock_used = 1;
 
     /* Fill the block metadata for logical datablock 0, which has the physical
      * id of the active metadata block. For this datablock, the space available
@@ -1026,6 +1299,10 @@ void its_flash_fs_mblock_set_data_scratch(uint32_t phy_id, uint32_t lblock)
 {
     if (lblock != ITS_LOGICAL_DBLOCK0) {
         its_flash_fs_ctx.meta_block_header.scratch_dblock = phy_id;
+        /* The previous data block, which becomes the scratch block, holds
+         * data.
+         */
+        its_flash_fs_ctx.scratch_dblock_used = 1;
     }
 }
 
@@ -1059,6 +1336,10 @@ psa_status_t its_flash_fs_mblock_update_scratch_file_meta(uint32_t idx,
 
     scratch_block = its_cur_meta_scratch_id();
 
+#ifdef ITS_METADATA_CACHE
+    its_mblock_cache[scratch_block].file_meta[idx] = *file_meta;
+#endif
+
     /* Calculate the position */
     pos = its_mblock_file_meta_offset(idx);
     return its_flash_write(scratch_block, (const uint8_t *)file_meta, pos,
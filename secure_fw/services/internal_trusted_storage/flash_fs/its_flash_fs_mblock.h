@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -107,6 +107,16 @@ psa_status_t its_flash_fs_mblock_cp_remaining_file_meta(uint32_t idx);
  */
 uint32_t its_flash_fs_mblock_cur_data_scratch_id(uint32_t lblock);
 
+/**
+ * \brief Marks the current scratch datablock as written, so that it is erased
+ *        by the next metadata update finalization.
+ *
+ * \note It must be called before writing into the scratch datablock.
+ *
+ * \param[in] lblock  Logical block number
+ */
+void its_flash_fs_mblock_mark_scratch_used(uint32_t lblock);
+
 /**
  * \brief Gets file metadata entry index.
  *
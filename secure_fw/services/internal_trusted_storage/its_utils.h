@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -21,6 +21,14 @@ extern "C" {
 #define ITS_FILE_ID_SIZE 12
 #define ITS_DEFAULT_EMPTY_BUFF_VAL 0
 
+/* Size of the buffers used to move the asset data between the client and the
+ * flash in chunks. The buffers are rounded up to a multiple of
+ * ITS_FLASH_PROGRAM_UNIT.
+ */
+#ifndef ITS_BUF_SIZE
+#define ITS_BUF_SIZE 64
+#endif
+
 /**
  * \brief Macro to check, at compilation time, if data fits in data buffer
  *
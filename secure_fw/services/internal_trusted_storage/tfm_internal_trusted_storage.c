@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -9,11 +9,15 @@
 #include "flash_fs/its_flash_fs.h"
 #include "tfm_memory_utils.h"
 #include "tfm_its_defs.h"
+#include "tfm_its_req_mngr.h"
 #include "its_utils.h"
 
 static uint8_t g_fid[ITS_FILE_ID_SIZE];
 static struct its_file_info_t g_file_info;
 
+/* Buffer to move the asset data from the flash to the client in chunks */
+static uint8_t its_buf[ITS_BUF_SIZE];
+
 /**
  * \brief Maps a pair of client id and uid to a file id.
  *
@@ -29,6 +33,24 @@ static void tfm_its_get_fid(int32_t client_id,
     tfm_memcpy(fid + sizeof(client_id), (const void *)&uid, sizeof(uid));
 }
 
+/**
+ * \brief Gets the next chunk of the asset data from the client.
+ *
+ * \param[in]  context  Context of the request
+ * \param[out] buf      Buffer to store the chunk
+ * \param[in]  size     Size of the chunk
+ *
+ * \return Returns error code as specified in \ref psa_status_t
+ */
+static psa_status_t tfm_its_read_data(void *context, uint8_t *buf, size_t size)
+{
+    if (its_req_mngr_read(context, buf, size) != size) {
+        return PSA_ERROR_PROGRAMMER_ERROR;
+    }
+
+    return PSA_SUCCESS;
+}
+
 psa_status_t tfm_its_init(void)
 {
     psa_status_t status;
@@ -66,8 +88,8 @@ psa_status_t tfm_its_init(void)
 psa_status_t tfm_its_set(int32_t client_id,
                          psa_storage_uid_t uid,
                          size_t data_length,
-                         const void *p_data,
-                         psa_storage_create_flags_t create_flags)
+                         psa_storage_create_flags_t create_flags,
+                         void *context)
 {
     psa_status_t status;
 
@@ -83,6 +105,11 @@ psa_status_t tfm_its_set(int32_t client_id,
         return PSA_ERROR_NOT_SUPPORTED;
     }
 
+    /* Boundary check the incoming request */
+    if (data_length > ITS_MAX_ASSET_SIZE) {
+        return PSA_ERROR_INVALID_ARGUMENT;
+    }
+
     /* Set file id */
     tfm_its_get_fid(client_id, uid, g_fid);
 
@@ -90,16 +117,18 @@ psa_status_t tfm_its_set(int32_t client_id,
     status = its_flash_fs_file_get_info(g_fid, &g_file_info);
     if (status == PSA_SUCCESS) {
         /* If the object exists and has the write once flag set, then it
-         * cannot be modified. Otherwise it needs to be removed.
+         * cannot be modified. Otherwise it is replaced in place.
          */
         if (g_file_info.flags & PSA_STORAGE_FLAG_WRITE_ONCE) {
             return PSA_ERROR_NOT_PERMITTED;
-        } else {
-            status = its_flash_fs_file_delete(g_fid);
-            if (status != PSA_SUCCESS) {
-                return status;
-            }
         }
+
+        return its_flash_fs_file_replace(g_fid,
+                                         data_length,
+                                         data_length,
+                                         (uint32_t)create_flags,
+                                         tfm_its_read_data,
+                                         context);
     } else if (status != PSA_ERROR_DOES_NOT_EXIST) {
         /* If the file does not exist, then do nothing.
          * If other error occurred, return it
@@ -112,17 +141,20 @@ psa_status_t tfm_its_set(int32_t client_id,
                                     data_length,
                                     data_length,
                                     (uint32_t)create_flags,
-                                    (const uint8_t *)p_data);
+                                    tfm_its_read_data,
+                                    context);
 }
 
 psa_status_t tfm_its_get(int32_t client_id,
                          psa_storage_uid_t uid,
                          size_t data_offset,
                          size_t data_size,
-                         void *p_data,
-                         size_t *p_data_length)
+                         size_t *p_data_length,
+                         void *context)
 {
     psa_status_t status;
+    size_t bytes_read = 0;
+    size_t bytes_to_read;
 
     /* Check that the UID is valid */
     if (uid == TFM_ITS_INVALID_UID) {
@@ -147,13 +179,24 @@ psa_status_t tfm_its_get(int32_t client_id,
     data_size = ITS_UTILS_MIN(data_size,
                               g_file_info.size_current - data_offset);
 
-    /* Read object data if any */
-    status = its_flash_fs_file_read(g_fid, data_size, data_offset, p_data);
-    if (status != PSA_SUCCESS) {
-        return status;
+    /* Read object data if any, in chunks */
+    while (bytes_read < data_size) {
+        bytes_to_read = ITS_UTILS_MIN((data_size - bytes_read),
+                                      sizeof(its_buf));
+
+        status = its_flash_fs_file_read(g_fid, bytes_to_read,
+                                        (data_offset + bytes_read), its_buf);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+
+        /* Write the chunk to the client */
+        its_req_mngr_write(context, its_buf, bytes_to_read);
+
+        bytes_read += bytes_to_read;
     }
 
-    /* Update the size of the data placed in p_data */
+    /* Update the size of the data written to the client */
     *p_data_length = data_size;
 
     return PSA_SUCCESS;
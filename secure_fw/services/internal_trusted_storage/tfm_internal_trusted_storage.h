@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -36,13 +36,15 @@ psa_status_t tfm_its_init(void);
 /**
  * \brief Create a new, or modify an existing, uid/value pair
  *
- * Stores data in the internal storage.
+ * Stores data in the internal storage. The data is read from the client in
+ * chunks, through \ref its_req_mngr_read.
  *
  * \param[in] client_id     Identifier of the asset's owner (client)
  * \param[in] uid           The identifier for the data
- * \param[in] data_length   The size in bytes of the data in `p_data`
- * \param[in] p_data        A buffer containing the data
+ * \param[in] data_length   The size in bytes of the data
  * \param[in] create_flags  The flags that the data will be stored with
+ * \param[in] context       Context of the request, given to
+ *                          \ref its_req_mngr_read
  *
  * \return A status indicating the success/failure of the operation
  *
@@ -61,36 +63,38 @@ psa_status_t tfm_its_init(void);
  * \retval PSA_ERROR_STORAGE_FAILURE       The operation failed because the
  *                                         physical storage has failed (Fatal
  *                                         error)
- * \retval PSA_ERROR_INVALID_ARGUMENT      The operation failed because one
- *                                         of the provided pointers (`p_data`)
- *                                         is invalid, for example is `NULL` or
- *                                         references memory the caller cannot
- *                                         access
+ * \retval PSA_ERROR_INVALID_ARGUMENT      The operation failed because
+ *                                         `data_length` is larger than
+ *                                         ITS_MAX_ASSET_SIZE
  */
 psa_status_t tfm_its_set(int32_t client_id,
                          psa_storage_uid_t uid,
                          size_t data_length,
-                         const void *p_data,
-                         psa_storage_create_flags_t create_flags);
+                         psa_storage_create_flags_t create_flags,
+                         void *context);
 
 /**
  * \brief Retrieve data associated with a provided UID
  *
  * Retrieves up to `data_size` bytes of the data associated with `uid`, starting
- * at `data_offset` bytes from the beginning of the data. Upon successful
- * completion, the data will be placed in the `p_data` buffer, which must be at
- * least `data_size` bytes in size. The length of the data returned will be in
- * `p_data_length`. If `data_size` is 0, the contents of `p_data_length` will
- * be set to zero.
+ * at `data_offset` bytes from the beginning of the data. The data is written
+ * to the client in chunks, through \ref its_req_mngr_write. The length of the
+ * data returned will be in `p_data_length`. If `data_size` is 0, the contents
+ * of `p_data_length` will be set to zero.
  *
  * \param[in]  client_id      Identifier of the asset's owner (client)
  * \param[in]  uid            The uid value
  * \param[in]  data_offset    The starting offset of the data requested
  * \param[in]  data_size      The amount of data requested
- * \param[out] p_data         On success, the buffer where the data will
- *                            be placed
  * \param[out] p_data_length  On success, this will contain size of the data
- *                            placed in `p_data`.
+ *                            written to the client.
+ * \param[in]  context        Context of the request, given to
+ *                            \ref its_req_mngr_write
+ *
+ * \note The data is checked chunk by chunk, and a chunk is written to the
+ *       client only once it has been read successfully. If an error is
+ *       returned, the chunks before the failing one may have been written, so
+ *       the content of the client buffer is undefined.
  *
  * \return A status indicating the success/failure of the operation
  *
@@ -101,21 +105,16 @@ psa_status_t tfm_its_set(int32_t client_id,
  * \retval PSA_ERROR_STORAGE_FAILURE   The operation failed because the
  *                                     physical storage has failed (Fatal
  *                                     error)
- * \retval PSA_ERROR_INVALID_ARGUMENT  The operation failed because one of the
- *                                     provided arguments (`p_data`,
- *                                     `p_data_length`) is invalid, for example
- *                                     is `NULL` or references memory the
- *                                     caller cannot access. In addition, this
- *                                     can also happen if `data_offset` is
- *                                     larger than the size of the data
- *                                     associated with `uid`.
+ * \retval PSA_ERROR_INVALID_ARGUMENT  The operation failed because
+ *                                     `data_offset` is larger than the size of
+ *                                     the data associated with `uid`.
  */
 psa_status_t tfm_its_get(int32_t client_id,
                          psa_storage_uid_t uid,
                          size_t data_offset,
                          size_t data_size,
-                         void *p_data,
-                         size_t *p_data_length);
+                         size_t *p_data_length,
+                         void *context);
 
 /**
  * \brief Retrieve the metadata about the provided uid
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -11,8 +11,6 @@
 
 #include "psa/storage_common.h"
 #include "tfm_internal_trusted_storage.h"
-#include "its_utils.h"
-#include "flash_layout.h"
 
 #ifdef TFM_PSA_API
 #include "psa/service.h"
@@ -24,8 +22,6 @@
 #include "tfm_api.h"
 #endif
 
-static uint8_t asset_data[GET_ALIGNED_FLASH_BYTES(ITS_MAX_ASSET_SIZE)] = {0};
-
 #ifndef TFM_PSA_API
 /**
  * \brief Indicates whether ITS has been initialised.
@@ -37,8 +33,8 @@ psa_status_t tfm_its_set_req(psa_invec *in_vec, size_t in_len,
 {
     psa_storage_uid_t uid;
     size_t data_length;
-    const void *p_data;
     psa_storage_create_flags_t create_flags;
+    const uint8_t *p_data;
     int32_t client_id;
 
     (void)out_vec;
@@ -63,12 +59,6 @@ psa_status_t tfm_its_set_req(psa_invec *in_vec, size_t in_len,
     p_data = in_vec[1].base;
     data_length = in_vec[1].len;
 
-    /* Boundary check the incoming request */
-    if (data_length > sizeof(asset_data)) {
-        return PSA_ERROR_INVALID_ARGUMENT;
-    }
-    tfm_memcpy(asset_data, p_data, data_length);
-
     create_flags = *(psa_storage_create_flags_t *)in_vec[2].base;
 
     /* Get the caller's client ID */
@@ -76,18 +66,18 @@ psa_status_t tfm_its_set_req(psa_invec *in_vec, size_t in_len,
         return PSA_ERROR_PROGRAMMER_ERROR;
     }
 
-    return tfm_its_set(client_id, uid, data_length, asset_data, create_flags);
+    /* The asset data is read from the client vector through p_data */
+    return tfm_its_set(client_id, uid, data_length, create_flags, &p_data);
 }
 
 psa_status_t tfm_its_get_req(psa_invec *in_vec, size_t in_len,
                              psa_outvec *out_vec, size_t out_len)
 {
-    psa_status_t status;
     psa_storage_uid_t uid;
     size_t data_offset;
     size_t data_size;
-    void *p_data;
     size_t *p_data_length;
+    uint8_t *p_data;
     int32_t client_id;
 
     if (!its_is_init) {
@@ -119,13 +109,9 @@ psa_status_t tfm_its_get_req(psa_invec *in_vec, size_t in_len,
         return PSA_ERROR_PROGRAMMER_ERROR;
     }
 
-    status =  tfm_its_get(client_id, uid, data_offset, data_size, asset_data,
-                          p_data_length);
-    if (status == PSA_SUCCESS) {
-        tfm_memcpy(p_data, asset_data, *p_data_length);
-    }
-
-    return status;
+    /* The asset data is written to the client vector through p_data */
+    return tfm_its_get(client_id, uid, data_offset, data_size, p_data_length,
+                       &p_data);
 }
 
 psa_status_t tfm_its_get_info_req(psa_invec *in_vec, size_t in_len,
@@ -194,6 +180,24 @@ psa_status_t tfm_its_remove_req(psa_invec *in_vec, size_t in_len,
     return tfm_its_remove(client_id, uid);
 }
 
+size_t its_req_mngr_read(void *context, uint8_t *buf, size_t num_bytes)
+{
+    const uint8_t **p_data = (const uint8_t **)context;
+
+    (void)tfm_memcpy(buf, *p_data, num_bytes);
+    *p_data += num_bytes;
+
+    return num_bytes;
+}
+
+void its_req_mngr_write(void *context, const uint8_t *buf, size_t num_bytes)
+{
+    uint8_t **p_data = (uint8_t **)context;
+
+    (void)tfm_memcpy(*p_data, buf, num_bytes);
+    *p_data += num_bytes;
+}
+
 #else /* !defined(TFM_PSA_API) */
 typedef psa_status_t (*its_func_t)(const psa_msg_t *msg);
 
@@ -202,6 +206,7 @@ static psa_status_t tfm_its_set_ipc(const psa_msg_t *msg)
     psa_storage_uid_t uid;
     size_t data_length;
     psa_storage_create_flags_t create_flags;
+    psa_handle_t handle = msg->handle;
     size_t num;
 
     if (msg->in_size[0] != sizeof(uid) ||
@@ -211,36 +216,31 @@ static psa_status_t tfm_its_set_ipc(const psa_msg_t *msg)
     }
 
     data_length = msg->in_size[1];
-    if (data_length > sizeof(asset_data)) {
-        return PSA_ERROR_INVALID_ARGUMENT;
-    }
 
     num = psa_read(msg->handle, 0, &uid, sizeof(uid));
     if (num != sizeof(uid)) {
         return PSA_ERROR_PROGRAMMER_ERROR;
     }
 
-    num = psa_read(msg->handle, 1, &asset_data, data_length);
-    if (num != data_length) {
-        return PSA_ERROR_PROGRAMMER_ERROR;
-    }
-
     num = psa_read(msg->handle, 2, &create_flags, sizeof(create_flags));
     if (num != sizeof(create_flags)) {
         return PSA_ERROR_PROGRAMMER_ERROR;
     }
 
-    return tfm_its_set(msg->client_id, uid, data_length, asset_data,
-                       create_flags);
+    /* The asset data is read by the ITS service in chunks, from the message
+     * referenced by handle.
+     */
+    return tfm_its_set(msg->client_id, uid, data_length, create_flags,
+                       &handle);
 }
 
 static psa_status_t tfm_its_get_ipc(const psa_msg_t *msg)
 {
-    psa_status_t status;
     psa_storage_uid_t uid;
     size_t data_offset;
     size_t data_size;
     size_t data_length;
+    psa_handle_t handle = msg->handle;
     size_t num;
 
     if (msg->in_size[0] != sizeof(uid) ||
@@ -261,13 +261,11 @@ static psa_status_t tfm_its_get_ipc(const psa_msg_t *msg)
 
     data_size = msg->out_size[0];
 
-    status = tfm_its_get(msg->client_id, uid, data_offset, data_size,
-                         asset_data, &data_length);
-    if (status == PSA_SUCCESS) {
-        psa_write(msg->handle, 0, asset_data, data_length);
-    }
-
-    return status;
+    /* The asset data is written by the ITS service in chunks, to the message
+     * referenced by handle.
+     */
+    return tfm_its_get(msg->client_id, uid, data_offset, data_size,
+                       &data_length, &handle);
 }
 
 static psa_status_t tfm_its_get_info_ipc(const psa_msg_t *msg)
@@ -349,6 +347,16 @@ static void its_signal_handle(psa_signal_t signal, its_func_t pfn)
         tfm_abort();
     }
 }
+
+size_t its_req_mngr_read(void *context, uint8_t *buf, size_t num_bytes)
+{
+    return psa_read(*(psa_handle_t *)context, 1, buf, num_bytes);
+}
+
+void its_req_mngr_write(void *context, const uint8_t *buf, size_t num_bytes)
+{
+    psa_write(*(psa_handle_t *)context, 0, buf, num_bytes);
+}
 #endif /* !defined(TFM_PSA_API) */
 
 psa_status_t tfm_its_req_mngr_init(void)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -9,6 +9,7 @@
 #define __TFM_ITS_REQ_MNGR_H__
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "psa/client.h"
 
@@ -80,6 +81,26 @@ psa_status_t tfm_its_get_info_req(psa_invec *in_vec, size_t in_len,
 psa_status_t tfm_its_remove_req(psa_invec *in_vec, size_t in_len,
                                 psa_outvec *out_vec, size_t out_len);
 
+/**
+ * \brief Reads the next chunk of the asset data of a set request.
+ *
+ * \param[in]  context    Context of the request, given to \ref tfm_its_set
+ * \param[out] buf        Buffer to store the data
+ * \param[in]  num_bytes  Number of bytes to read
+ *
+ * \return Number of bytes read
+ */
+size_t its_req_mngr_read(void *context, uint8_t *buf, size_t num_bytes);
+
+/**
+ * \brief Writes the next chunk of the asset data of a get request.
+ *
+ * \param[in] context    Context of the request, given to \ref tfm_its_get
+ * \param[in] buf        Buffer containing the data
+ * \param[in] num_bytes  Number of bytes to write
+ */
+void its_req_mngr_write(void *context, const uint8_t *buf, size_t num_bytes);
+
 #ifdef __cplusplus
 }
 #endif
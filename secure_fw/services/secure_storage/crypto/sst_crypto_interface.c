@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -24,6 +24,10 @@
 static const uint8_t sst_key_label[] = "storage_key";
 static psa_key_handle_t sst_key_handle;
 static uint8_t sst_crypto_iv_buf[SST_IV_LEN_BYTES];
+#ifdef SST_CACHE_STORAGE_KEY
+/* Indicates that the storage key is resident in the crypto service */
+static bool sst_key_resident = false;
+#endif
 
 psa_ps_status_t sst_crypto_init(void)
 {
@@ -33,7 +37,13 @@ psa_ps_status_t sst_crypto_init(void)
     return PSA_PS_SUCCESS;
 }
 
-psa_ps_status_t sst_crypto_setkey(void)
+/**
+ * \brief Derives the storage key from the HUK and imports it into a transient
+ *        key slot of the crypto service.
+ *
+ * \return Returns values as described in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_crypto_derivekey(void)
 {
     psa_status_t status;
     psa_key_handle_t huk_key_handle;
@@ -106,7 +116,12 @@ release_sst_key:
     return PSA_PS_ERROR_OPERATION_FAILED;
 }
 
-psa_ps_status_t sst_crypto_destroykey(void)
+/**
+ * \brief Destroys the transient storage key in the crypto service.
+ *
+ * \return Returns values as described in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_crypto_releasekey(void)
 {
     psa_status_t status;
 
@@ -119,6 +134,55 @@ psa_ps_status_t sst_crypto_destroykey(void)
     return PSA_PS_SUCCESS;
 }
 
+psa_ps_status_t sst_crypto_setkey(void)
+{
+#ifdef SST_CACHE_STORAGE_KEY
+    psa_ps_status_t err;
+
+    /* Reuse the storage key derived by a previous call */
+    if (sst_key_resident) {
+        return PSA_PS_SUCCESS;
+    }
+
+    err = sst_crypto_derivekey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    sst_key_resident = true;
+
+    return PSA_PS_SUCCESS;
+#else
+    return sst_crypto_derivekey();
+#endif
+}
+
+psa_ps_status_t sst_crypto_destroykey(void)
+{
+#ifdef SST_CACHE_STORAGE_KEY
+    /* The storage key stays resident until sst_crypto_invalidatekey() */
+    return PSA_PS_SUCCESS;
+#else
+    return sst_crypto_releasekey();
+#endif
+}
+
+psa_ps_status_t sst_crypto_invalidatekey(void)
+{
+#ifdef SST_CACHE_STORAGE_KEY
+    if (!sst_key_resident) {
+        return PSA_PS_SUCCESS;
+    }
+
+    /* Derive the storage key again on the next sst_crypto_setkey() call */
+    sst_key_resident = false;
+
+    return sst_crypto_releasekey();
+#else
+    return PSA_PS_SUCCESS;
+#endif
+}
+
 void sst_crypto_set_iv(const union sst_crypto_t *crypto)
 {
     (void)tfm_memcpy(sst_crypto_iv_buf, crypto->ref.iv, SST_IV_LEN_BYTES);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -42,6 +42,10 @@ psa_ps_status_t sst_crypto_init(void);
 /**
  * \brief Sets the key to use for crypto operations for the current client.
  *
+ * \note When SST_CACHE_STORAGE_KEY is defined, the key is only derived on
+ *       the first call and then kept resident until
+ *       \ref sst_crypto_invalidatekey is called.
+ *
  * \return Returns values as described in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_crypto_setkey(void);
@@ -49,10 +53,23 @@ psa_ps_status_t sst_crypto_setkey(void);
 /**
  * \brief Destroys the transient key used for crypto operations.
  *
+ * \note When SST_CACHE_STORAGE_KEY is defined, the resident key is kept and
+ *       this function has no effect.
+ *
  * \return Returns values as described in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_crypto_destroykey(void);
 
+/**
+ * \brief Destroys the resident key used for crypto operations, so that it is
+ *        derived again by the next call to \ref sst_crypto_setkey.
+ *
+ * \note Has no effect unless SST_CACHE_STORAGE_KEY is defined.
+ *
+ * \return Returns values as described in \ref psa_ps_status_t
+ */
+psa_ps_status_t sst_crypto_invalidatekey(void);
+
 /**
  * \brief Encrypts and tags the given plaintext data.
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -12,6 +12,9 @@
 #include "Driver_Flash.h"
 #include "tfm_memory_utils.h"
 #include "tfm_sst_defs.h"
+#ifdef SST_FLASH_COPY_HAL
+#include "platform/include/tfm_plat_flash_copy.h"
+#endif
 
 #ifndef SST_FLASH_AREA_ADDR
 #error "SST_FLASH_AREA_ADDR must be defined in flash_layout.h file"
@@ -25,12 +28,25 @@
 extern ARM_DRIVER_FLASH SST_FLASH_DEV_NAME;
 
 #define BLOCK_START_OFFSET  0
-#define MAX_BLOCK_DATA_COPY 256
+
+/* Size of the RAM buffer used to move data between two blocks. It can be
+ * overridden in flash_layout.h.
+ */
+#ifndef SST_MAX_BLOCK_DATA_COPY
+#define SST_MAX_BLOCK_DATA_COPY 256
+#endif
+
+#if (SST_MAX_BLOCK_DATA_COPY % SST_FLASH_PROGRAM_UNIT) != 0
+#error "SST_MAX_BLOCK_DATA_COPY must be a multiple of SST_FLASH_PROGRAM_UNIT"
+#endif
 
 #ifdef SST_RAM_FS
 #define BLOCK_DATA_SIZE (SST_BLOCK_SIZE * SST_TOTAL_NUM_OF_BLOCKS)
 
 static uint8_t block_data[BLOCK_DATA_SIZE] = {0};
+#else
+/* The buffer is not allocated in the stack, as its size is configurable */
+static uint8_t block_data_copy[SST_MAX_BLOCK_DATA_COPY];
 #endif
 
 /*
@@ -83,6 +99,17 @@ static psa_ps_status_t flash_erase(uint32_t flash_addr)
 
     return PSA_PS_SUCCESS;
 }
+
+static psa_ps_status_t flash_copy(uint32_t dst_addr, uint32_t src_addr,
+                                  uint32_t size)
+{
+    uint32_t dst_idx = dst_addr - SST_FLASH_AREA_ADDR;
+    uint32_t src_idx = src_addr - SST_FLASH_AREA_ADDR;
+
+    (void)tfm_memcpy(&block_data[dst_idx], &block_data[src_idx], size);
+
+    return PSA_PS_SUCCESS;
+}
 #else
 static psa_ps_status_t flash_init(void)
 {
@@ -133,6 +160,58 @@ static psa_ps_status_t flash_erase(uint32_t flash_addr)
 
     return PSA_PS_SUCCESS;
 }
+
+static psa_ps_status_t flash_copy(uint32_t dst_addr, uint32_t src_addr,
+                                  uint32_t size)
+{
+    psa_ps_status_t err;
+    uint32_t nbr_bytes_moved = 0;
+    uint32_t bytes_to_move;
+
+#ifdef SST_FLASH_COPY_HAL
+    enum tfm_plat_err_t plat_err;
+
+    /* Let the platform copy the data, if it can */
+    plat_err = tfm_plat_flash_copy(&SST_FLASH_DEV_NAME, dst_addr, src_addr,
+                                   size);
+    if (plat_err == TFM_PLAT_ERR_SUCCESS) {
+        return PSA_PS_SUCCESS;
+    } else if (plat_err != TFM_PLAT_ERR_UNSUPPORTED) {
+        return PSA_PS_ERROR_STORAGE_FAILURE;
+    }
+#endif
+
+    while (nbr_bytes_moved <  size) {
+        /* Calculates the number of bytes to move */
+        bytes_to_move = (size - nbr_bytes_moved);
+        if (bytes_to_move > SST_MAX_BLOCK_DATA_COPY) {
+           bytes_to_move = SST_MAX_BLOCK_DATA_COPY;
+        }
+
+        /* Reads data from source block and store it in the in-memory copy of
+         * destination content.
+         */
+        err = flash_read(src_addr, bytes_to_move, block_data_copy);
+        if (err != PSA_PS_SUCCESS) {
+            return err;
+        }
+
+        /* Writes in flash the in-memory block content after modification */
+        err = flash_write(dst_addr, bytes_to_move, block_data_copy);
+        if (err != PSA_PS_SUCCESS) {
+            return err;
+        }
+
+        /* Updates number of bytes moved */
+        nbr_bytes_moved += bytes_to_move;
+
+        /* Updates pointers to the source and destination flash regions */
+        src_addr += bytes_to_move;
+        dst_addr += bytes_to_move;
+    };
+
+    return PSA_PS_SUCCESS;
+}
 #endif /* SST_RAM_FS */
 
 psa_ps_status_t sst_flash_init(void)
@@ -172,47 +251,14 @@ psa_ps_status_t sst_flash_block_to_block_move(uint32_t dst_block,
                                               uint32_t src_offset,
                                               uint32_t size)
 {
-    psa_ps_status_t err;
-    uint8_t dst_block_data_copy[MAX_BLOCK_DATA_COPY];
     uint32_t dst_flash_addr;
     uint32_t src_flash_addr;
-    uint32_t nbr_bytes_moved = 0;
-    uint32_t bytes_to_move;
 
     /* Gets flash addresses defined by block ID and offset parameters */
     src_flash_addr = get_phys_address(src_block, src_offset);
     dst_flash_addr = get_phys_address(dst_block, dst_offset);
 
-    while (nbr_bytes_moved <  size) {
-        /* Calculates the number of bytes to move */
-        bytes_to_move = (size - nbr_bytes_moved);
-        if (bytes_to_move > MAX_BLOCK_DATA_COPY) {
-           bytes_to_move = MAX_BLOCK_DATA_COPY;
-        }
-
-        /* Reads data from source block and store it in the in-memory copy of
-         * destination content.
-         */
-        err = flash_read(src_flash_addr, bytes_to_move, dst_block_data_copy);
-        if (err != PSA_PS_SUCCESS) {
-            return err;
-        }
-
-        /* Writes in flash the in-memory block content after modification */
-        err = flash_write(dst_flash_addr, bytes_to_move, dst_block_data_copy);
-        if (err != PSA_PS_SUCCESS) {
-            return err;
-        }
-
-        /* Updates number of bytes moved */
-        nbr_bytes_moved += bytes_to_move;
-
-        /* Updates pointers to the source and destination flash regions */
-        src_flash_addr += bytes_to_move;
-        dst_flash_addr += bytes_to_move;
-    };
-
-    return PSA_PS_SUCCESS;
+    return flash_copy(dst_flash_addr, src_flash_addr, size);
 }
 
 psa_ps_status_t sst_flash_erase_block(uint32_t block_id)
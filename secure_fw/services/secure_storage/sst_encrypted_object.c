@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -11,7 +11,6 @@
 
 #include "crypto/sst_crypto_interface.h"
 #include "flash_fs/sst_flash_fs.h"
-#include "tfm_memory_utils.h"
 #include "sst_object_defs.h"
 #include "sst_utils.h"
 
@@ -19,22 +18,9 @@
 #define SST_ENCRYPT_SIZE(plaintext_size) \
     ((plaintext_size) + SST_OBJECT_HEADER_SIZE - sizeof(union sst_crypto_t))
 
-#define SST_CRYPTO_CLEAR_BUF_VALUE 0
 #define SST_OBJECT_START_POSITION  0
 #define SST_EMPTY_OBJECT_SIZE      0
 
-/* Buffer to store the maximum encrypted object */
-/* FIXME: Do partial encrypt/decrypt to reduce the size of internal buffer */
-#define SST_MAX_ENCRYPTED_OBJ_SIZE GET_ALIGNED_FLASH_BYTES( \
-                                     SST_ENCRYPT_SIZE(SST_MAX_OBJECT_DATA_SIZE))
-
-/* FIXME: add the tag length to the crypto buffer size to account for the tag
- * being appended to the ciphertext by the crypto layer.
- */
-#define SST_CRYPTO_BUF_LEN (SST_MAX_ENCRYPTED_OBJ_SIZE + SST_TAG_LEN_BYTES)
-
-static uint8_t sst_crypto_buf[SST_CRYPTO_BUF_LEN];
-
 /**
  * \brief Performs authenticated decryption on object data, with the header as
  *        the associated data.
@@ -42,9 +28,11 @@ static uint8_t sst_crypto_buf[SST_CRYPTO_BUF_LEN];
  * \param[in]  fid       File ID
  * \param[in]  cur_size  Size of the object data to decrypt
  * \param[in,out] obj    Pointer to the object structure to authenticate and
- *                       fill in with the decrypted data. The tag of the object
- *                       is the one stored in the object table for the given
- *                       File ID.
+ *                       decrypt in place. The tag of the object is the one
+ *                       stored in the object table for the given File ID.
+ *                       The object must be followed by SST_TAG_LEN_BYTES of
+ *                       writable memory, used by the crypto layer to append
+ *                       the tag to the ciphertext.
  *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
@@ -61,8 +49,6 @@ static psa_ps_status_t sst_object_auth_decrypt(uint32_t fid,
         return err;
     }
 
-    (void)tfm_memcpy(sst_crypto_buf, p_obj_data, cur_size);
-
     /* Use File ID as a part of the associated data to authenticate
      * the object in the FS. The tag will be stored in the object table and
      * not as a part of the object's data stored in the FS.
@@ -71,7 +57,7 @@ static psa_ps_status_t sst_object_auth_decrypt(uint32_t fid,
     err = sst_crypto_auth_and_decrypt(&obj->header.crypto,
                                       (const uint8_t *)&fid,
                                       sizeof(fid),
-                                      sst_crypto_buf,
+                                      p_obj_data,
                                       cur_size,
                                       p_obj_data,
                                       sizeof(*obj) - sizeof(obj->header.crypto),
@@ -90,8 +76,10 @@ static psa_ps_status_t sst_object_auth_decrypt(uint32_t fid,
  *
  * \param[in]  fid       File ID
  * \param[in]  cur_size  Size of the object data to encrypt
- * \param[out] obj       Pointer to the object structure to authenticate and
- *                       fill in with the encrypted data.
+ * \param[in,out] obj    Pointer to the object structure to authenticate and
+ *                       encrypt in place. The object must be followed by
+ *                       SST_TAG_LEN_BYTES of writable memory, used by the
+ *                       crypto layer to append the tag to the ciphertext.
  *
  * \return Returns error code as specified in \ref psa_ps_status_t
  */
@@ -122,16 +110,14 @@ static psa_ps_status_t sst_object_auth_encrypt(uint32_t fid,
                                      sizeof(fid),
                                      p_obj_data,
                                      cur_size,
-                                     sst_crypto_buf,
-                                     sizeof(sst_crypto_buf),
+                                     p_obj_data,
+                                     cur_size + SST_TAG_LEN_BYTES,
                                      &out_len);
     if (err != PSA_PS_SUCCESS || out_len != cur_size) {
         (void)sst_crypto_destroykey();
         return PSA_PS_ERROR_OPERATION_FAILED;
     }
 
-    (void)tfm_memcpy(p_obj_data, sst_crypto_buf, cur_size);
-
     return sst_crypto_destroykey();
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -22,6 +22,9 @@ extern "C" {
  * \param[in]  fid      File ID
  * \param[out] obj      Pointer to the object structure to fill in
  *
+ * Note: The object is decrypted in place, so obj must be followed by
+ *       SST_TAG_LEN_BYTES of writable memory.
+ *
  * \return Returns error code specified in \ref psa_ps_status_t
  */
 psa_ps_status_t sst_encrypted_object_read(uint32_t fid,
@@ -37,7 +40,8 @@ psa_ps_status_t sst_encrypted_object_read(uint32_t fid,
  * Note: The function will use obj to store the encrypted data before write it
  *       into the flash to reduce the memory requirements and the number of
  *       internal copies. So, this object will contain the encrypted object
- *       stored in the flash.
+ *       stored in the flash. obj must be followed by SST_TAG_LEN_BYTES of
+ *       writable memory to hold the tag appended by the crypto layer.
  *
  * \return Returns error code specified in \ref psa_ps_status_t
  */
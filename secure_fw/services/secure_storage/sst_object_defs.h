@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -69,6 +69,11 @@ struct sst_object_t {
  *        number of defined assets, the object table and 2 temporary objects to
  *        store the temporary object table and temporary updated object.
  */
+#ifdef SST_TABLE_JOURNAL
+/* One more object stores the object table journal */
+#define SST_MAX_NUM_OBJECTS (SST_NUM_ASSETS + 4)
+#else
 #define SST_MAX_NUM_OBJECTS (SST_NUM_ASSETS + 3)
+#endif
 
 #endif /* __SST_OBJECT_DEFS_H__ */
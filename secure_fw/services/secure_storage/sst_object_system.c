@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -13,6 +13,7 @@
 #include "flash_fs/sst_flash_fs.h"
 #include "tfm_memory_utils.h"
 #ifdef SST_ENCRYPTION
+#include "crypto/sst_crypto_interface.h"
 #include "sst_encrypted_object.h"
 #endif
 #include "sst_object_defs.h"
@@ -27,7 +28,16 @@
 #endif /* SST_ENCRYPTION */
 
 /* Allocate static variables to process objects */
-static struct sst_object_t g_sst_object;
+static struct {
+    struct sst_object_t object;
+#ifdef SST_ENCRYPTION
+    /* Room for the tag appended to the ciphertext, as the encrypted object
+     * layer encrypts and decrypts the object in place.
+     */
+    uint8_t tag[SST_TAG_LEN_BYTES];
+#endif
+} g_sst_object_buf;
+static struct sst_object_t *const g_sst_object = &g_sst_object_buf.object;
 static struct sst_obj_table_info_t g_obj_tbl_info;
 
 /**
@@ -100,7 +110,7 @@ static psa_ps_status_t sst_read_object(enum read_type_t type)
     /* Read object header */
     err = sst_flash_fs_file_read(g_obj_tbl_info.fid, SST_OBJECT_HEADER_SIZE,
                                  SST_OBJECT_START_POSITION,
-                                 (uint8_t *)&g_sst_object.header);
+                                 (uint8_t *)&g_sst_object->header);
     if (err != PSA_PS_SUCCESS) {
         return err;
     }
@@ -108,18 +118,18 @@ static psa_ps_status_t sst_read_object(enum read_type_t type)
     /* As SST encryption support is not enabled, check file ID and version to
      * detect inconsistency after read the object header from flash.
      */
-    if (g_sst_object.header.fid != g_obj_tbl_info.fid ||
-        g_sst_object.header.version != g_obj_tbl_info.version) {
+    if (g_sst_object->header.fid != g_obj_tbl_info.fid ||
+        g_sst_object->header.version != g_obj_tbl_info.version) {
         err = PSA_PS_ERROR_DATA_CORRUPT;
     }
 
     if (type == READ_ALL_OBJECT) {
         /* Read object data if any */
-        if (g_sst_object.header.info.current_size > 0) {
+        if (g_sst_object->header.info.current_size > 0) {
             err = sst_flash_fs_file_read(g_obj_tbl_info.fid,
-                                         g_sst_object.header.info.current_size,
+                                         g_sst_object->header.info.current_size,
                                          SST_OBJECT_HEADER_SIZE,
-                                         g_sst_object.data);
+                                         g_sst_object->data);
             if (err != PSA_PS_SUCCESS) {
                 return err;
             }
@@ -140,19 +150,19 @@ static psa_ps_status_t sst_read_object(enum read_type_t type)
 static psa_ps_status_t sst_write_object(uint32_t wrt_size)
 {
     psa_ps_status_t err;
-    uint32_t max_size = SST_OBJECT_SIZE(g_sst_object.header.info.max_size);
+    uint32_t max_size = SST_OBJECT_SIZE(g_sst_object->header.info.max_size);
 
     /* Add object identification and increase object version */
-    g_sst_object.header.fid = g_obj_tbl_info.fid;
-    g_sst_object.header.version++;
+    g_sst_object->header.fid = g_obj_tbl_info.fid;
+    g_sst_object->header.version++;
 
     /* Save object version to be stored in the object table */
-    g_obj_tbl_info.version = g_sst_object.header.version;
+    g_obj_tbl_info.version = g_sst_object->header.version;
 
     err = sst_flash_fs_file_create(g_obj_tbl_info.fid,
                                    GET_ALIGNED_FLASH_BYTES(max_size),
                                    GET_ALIGNED_FLASH_BYTES(wrt_size),
-                                   (const uint8_t *)&g_sst_object);
+                                   (const uint8_t *)g_sst_object);
     return err;
 }
 
@@ -167,15 +177,23 @@ psa_ps_status_t sst_system_prepare(void)
         return err;
     }
 
-    /* Reuse the allocated g_sst_object.data to store a temporary object table
+#ifdef SST_ENCRYPTION
+    /* Do not carry a storage key derived before over to the new system */
+    err = sst_crypto_invalidatekey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif
+
+    /* Reuse the allocated g_sst_object->data to store a temporary object table
      * data to be validate inside the function.
-     * The stored date will be cleaned up when the g_sst_object.data will
+     * The stored date will be cleaned up when the g_sst_object->data will
      * be used for the first time in the object system.
      */
-    err = sst_object_table_init(g_sst_object.data);
+    err = sst_object_table_init(g_sst_object->data);
 
 #ifdef SST_ENCRYPTION
-    g_obj_tbl_info.tag = g_sst_object.header.crypto.ref.tag;
+    g_obj_tbl_info.tag = g_sst_object->header.crypto.ref.tag;
 #endif
 
     return err;
@@ -196,7 +214,7 @@ psa_ps_status_t sst_object_read(psa_ps_uid_t uid, int32_t client_id,
 
     /* Read object */
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, g_sst_object);
 #else
     /* Read object header */
     err = sst_read_object(READ_ALL_OBJECT);
@@ -206,18 +224,18 @@ psa_ps_status_t sst_object_read(psa_ps_uid_t uid, int32_t client_id,
     }
 
     /* Boundary check the incoming request */
-    err = sst_utils_check_contained_in(g_sst_object.header.info.current_size,
+    err = sst_utils_check_contained_in(g_sst_object->header.info.current_size,
                                        offset, size);
     if (err != PSA_PS_SUCCESS) {
         goto clear_data_and_return;
     }
 
     /* Copy the decrypted object data to the output buffer */
-    sst_req_mngr_write_asset_data(g_sst_object.data + offset, size);
+    sst_req_mngr_write_asset_data(g_sst_object->data + offset, size);
 
 clear_data_and_return:
     /* Remove data stored in the object before leaving the function */
-    (void)tfm_memset(&g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
+    (void)tfm_memset(g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
                      SST_MAX_OBJECT_SIZE);
 
     return err;
@@ -247,7 +265,7 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
     if (err == PSA_PS_SUCCESS) {
 #ifdef SST_ENCRYPTION
         /* Read the object */
-        err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+        err = sst_encrypted_object_read(g_obj_tbl_info.fid, g_sst_object);
 #else
         /* Read the object header */
         err = sst_read_object(READ_HEADER_ONLY);
@@ -259,15 +277,15 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
         /* If the object exists and has the write once flag set, then it cannot
          * be modified.
          */
-        if (g_sst_object.header.info.create_flags
+        if (g_sst_object->header.info.create_flags
             & PSA_PS_FLAG_WRITE_ONCE) {
             err = PSA_PS_ERROR_WRITE_ONCE;
             goto clear_data_and_return;
         }
 
         /* Update the create flags and max object size */
-        g_sst_object.header.info.create_flags = create_flags;
-        g_sst_object.header.info.max_size = size;
+        g_sst_object->header.info.create_flags = create_flags;
+        g_sst_object->header.info.max_size = size;
 
         /* Save old file ID */
         old_fid = g_obj_tbl_info.fid;
@@ -276,19 +294,19 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
          * arguments and empty content. Requests 2 FIDs to prevent exhaustion.
          */
         fid_am_reserved = 2;
-        sst_init_empty_object(create_flags, size, &g_sst_object);
+        sst_init_empty_object(create_flags, size, g_sst_object);
     } else {
         goto clear_data_and_return;
     }
 
     /* Update the object data */
-    err = sst_req_mngr_read_asset_data(g_sst_object.data, size);
+    err = sst_req_mngr_read_asset_data(g_sst_object->data, size);
     if (err != PSA_PS_SUCCESS) {
         goto clear_data_and_return;
     }
 
     /* Update the current object size */
-    g_sst_object.header.info.current_size = size;
+    g_sst_object->header.info.current_size = size;
 
     /* Get new file ID */
     err = sst_object_table_get_free_fid(fid_am_reserved,
@@ -298,9 +316,9 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_write(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_write(g_obj_tbl_info.fid, g_sst_object);
 #else
-    wrt_size = SST_OBJECT_SIZE(g_sst_object.header.info.current_size);
+    wrt_size = SST_OBJECT_SIZE(g_sst_object->header.info.current_size);
 
     /* Write g_sst_object */
     err = sst_write_object(wrt_size);
@@ -332,7 +350,7 @@ psa_ps_status_t sst_object_create(psa_ps_uid_t uid, int32_t client_id,
 
 clear_data_and_return:
     /* Remove data stored in the object before leaving the function */
-    (void)tfm_memset(&g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
+    (void)tfm_memset(g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
                      SST_MAX_OBJECT_SIZE);
 
     return err;
@@ -358,7 +376,7 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
 
     /* Read the object */
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, g_sst_object);
 #else
     err = sst_read_object(READ_ALL_OBJECT);
 #endif
@@ -367,7 +385,7 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
     }
 
     /* If the object has the write once flag set, then it cannot be modified. */
-    if (g_sst_object.header.info.create_flags & PSA_PS_FLAG_WRITE_ONCE) {
+    if (g_sst_object->header.info.create_flags & PSA_PS_FLAG_WRITE_ONCE) {
         err = PSA_PS_ERROR_WRITE_ONCE;
         goto clear_data_and_return;
     }
@@ -375,27 +393,27 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
     /* Offset must not be larger than the object's current size to prevent gaps
      * being created in the object data.
      */
-    if (offset > g_sst_object.header.info.current_size) {
+    if (offset > g_sst_object->header.info.current_size) {
         err = PSA_PS_ERROR_OFFSET_INVALID;
         goto clear_data_and_return;
     }
 
     /* Boundary check the incoming request */
-    err = sst_utils_check_contained_in(g_sst_object.header.info.max_size,
+    err = sst_utils_check_contained_in(g_sst_object->header.info.max_size,
                                        offset, size);
     if (err != PSA_PS_SUCCESS) {
         goto clear_data_and_return;
     }
 
     /* Update the object data */
-    err = sst_req_mngr_read_asset_data(g_sst_object.data + offset, size);
+    err = sst_req_mngr_read_asset_data(g_sst_object->data + offset, size);
     if (err != PSA_PS_SUCCESS) {
         goto clear_data_and_return;
     }
 
     /* Update the current object size if necessary */
-    if ((offset + size) > g_sst_object.header.info.current_size) {
-        g_sst_object.header.info.current_size = offset + size;
+    if ((offset + size) > g_sst_object->header.info.current_size) {
+        g_sst_object->header.info.current_size = offset + size;
     }
 
     /* Save old file ID */
@@ -408,9 +426,9 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_write(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_write(g_obj_tbl_info.fid, g_sst_object);
 #else
-    wrt_size = SST_OBJECT_SIZE(g_sst_object.header.info.current_size);
+    wrt_size = SST_OBJECT_SIZE(g_sst_object->header.info.current_size);
 
     /* Write g_sst_object */
     err = sst_write_object(wrt_size);
@@ -437,7 +455,7 @@ psa_ps_status_t sst_object_write(psa_ps_uid_t uid, int32_t client_id,
 
 clear_data_and_return:
     /* Remove data stored in the object before leaving the function */
-    (void)tfm_memset(&g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
+    (void)tfm_memset(g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
                      SST_MAX_OBJECT_SIZE);
 
     return err;
@@ -457,7 +475,7 @@ psa_ps_status_t sst_object_get_info(psa_ps_uid_t uid, int32_t client_id,
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, g_sst_object);
 #else
     err = sst_read_object(READ_HEADER_ONLY);
 #endif
@@ -466,12 +484,12 @@ psa_ps_status_t sst_object_get_info(psa_ps_uid_t uid, int32_t client_id,
     }
 
     /* Copy SST object info to the PSA PS info struct */
-    info->size = g_sst_object.header.info.current_size;
-    info->flags = g_sst_object.header.info.create_flags;
+    info->size = g_sst_object->header.info.current_size;
+    info->flags = g_sst_object->header.info.create_flags;
 
 clear_data_and_return:
     /* Remove data stored in the object before leaving the function */
-    (void)tfm_memset(&g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
+    (void)tfm_memset(g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
                      SST_MAX_OBJECT_SIZE);
 
     return err;
@@ -490,7 +508,7 @@ psa_ps_status_t sst_object_delete(psa_ps_uid_t uid, int32_t client_id)
     }
 
 #ifdef SST_ENCRYPTION
-    err = sst_encrypted_object_read(g_obj_tbl_info.fid, &g_sst_object);
+    err = sst_encrypted_object_read(g_obj_tbl_info.fid, g_sst_object);
 #else
     err = sst_read_object(READ_HEADER_ONLY);
 #endif
@@ -499,7 +517,7 @@ psa_ps_status_t sst_object_delete(psa_ps_uid_t uid, int32_t client_id)
     }
 
     /* Check that the write once flag is not set */
-    if (g_sst_object.header.info.create_flags & PSA_PS_FLAG_WRITE_ONCE) {
+    if (g_sst_object->header.info.create_flags & PSA_PS_FLAG_WRITE_ONCE) {
         err = PSA_PS_ERROR_WRITE_ONCE;
         goto clear_data_and_return;
     }
@@ -517,7 +535,7 @@ psa_ps_status_t sst_object_delete(psa_ps_uid_t uid, int32_t client_id)
 
 clear_data_and_return:
     /* Remove data stored in the object before leaving the function */
-    (void)tfm_memset(&g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
+    (void)tfm_memset(g_sst_object, SST_DEFAULT_EMPTY_BUFF_VAL,
                      SST_MAX_OBJECT_SIZE);
 
     return err;
@@ -539,6 +557,13 @@ psa_ps_status_t sst_system_wipe_all(void)
         return err;
     }
 
+#ifdef SST_ENCRYPTION
+    err = sst_crypto_invalidatekey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif
+
     err = sst_flash_fs_prepare();
     if (err != PSA_PS_SUCCESS) {
         return err;
@@ -23,7 +23,11 @@
  *
  * \brief Current object system version.
  */
+#ifdef SST_TABLE_JOURNAL
+#define SST_OBJECT_SYSTEM_VERSION  0x02
+#else
 #define SST_OBJECT_SYSTEM_VERSION  0x01
+#endif
 
 /*!
  * \struct sst_obj_table_info_t
@@ -64,6 +68,12 @@ struct __attribute__((__aligned__(SST_FLASH_PROGRAM_UNIT))) sst_obj_table_t {
                                   */
 #endif /* SST_ROLLBACK_PROTECTION */
 
+#ifdef SST_TABLE_JOURNAL
+  uint32_t journal_seq;          /*!< Sequence number of the first journal
+                                  *   record to apply on top of this table.
+                                  */
+#endif /* SST_TABLE_JOURNAL */
+
   struct sst_obj_table_entry_t obj_db[SST_OBJ_TABLE_ENTRIES]; /*!< Table's
                                                                *   entries
                                                                */
@@ -114,6 +124,53 @@ struct __attribute__((__aligned__(SST_FLASH_PROGRAM_UNIT))) sst_obj_table_t {
 #define SST_OBJECT_FS_ID_TO_IDX(fid) ((fid - 1) - \
                                       SST_TABLE_FS_ID(SST_OBJ_TABLE_IDX_1))
 
+#ifdef SST_TABLE_JOURNAL
+#ifdef SST_ROLLBACK_PROTECTION
+#error "SST_TABLE_JOURNAL is not supported with SST_ROLLBACK_PROTECTION"
+#endif
+
+/* Maximum number of records in the object table journal. When the journal is
+ * full, the next change is committed by saving the whole table.
+ */
+#ifndef SST_TABLE_JOURNAL_RECORDS
+#define SST_TABLE_JOURNAL_RECORDS  8
+#endif
+
+/*!
+ * \def SST_TABLE_JOURNAL_FS_ID
+ *
+ * \brief File ID to be used in order to store the object table journal in the
+ *        file system. It is the file ID after the last object file ID.
+ */
+#define SST_TABLE_JOURNAL_FS_ID  SST_OBJECT_FS_ID(SST_OBJ_TABLE_ENTRIES)
+
+/* Sequence number of the first journal record of a new object table */
+#define SST_TABLE_JOURNAL_FIRST_SEQ  1U
+
+/*!
+ * \struct sst_obj_table_journal_rec_t
+ *
+ * \brief Object table journal record. It contains the new content of one
+ *        table entry.
+ */
+struct __attribute__((__aligned__(SST_FLASH_PROGRAM_UNIT)))
+sst_obj_table_journal_rec_t {
+#ifdef SST_ENCRYPTION
+    union sst_crypto_t crypto;          /*!< Crypto metadata of the record */
+#endif
+    uint32_t seq;                       /*!< Record sequence number */
+    uint32_t idx;                       /*!< Index of the table entry */
+    struct sst_obj_table_entry_t entry; /*!< New table entry content */
+};
+
+/* Object table journal record size */
+#define SST_TABLE_JOURNAL_REC_SIZE  sizeof(struct sst_obj_table_journal_rec_t)
+
+/* Object table journal file size */
+#define SST_TABLE_JOURNAL_SIZE  (SST_TABLE_JOURNAL_REC_SIZE * \
+                                 SST_TABLE_JOURNAL_RECORDS)
+#endif /* SST_TABLE_JOURNAL */
+
 /*!
  * \struct sst_obj_table_ctx_t
  *
@@ -123,11 +180,82 @@ struct sst_obj_table_ctx_t {
     struct sst_obj_table_t obj_table; /*!< Object tables */
     uint8_t active_table;             /*!< Active object table */
     uint8_t scratch_table;            /*!< Scratch object table */
+#ifdef SST_TABLE_JOURNAL
+    struct sst_obj_table_journal_rec_t journal[SST_TABLE_JOURNAL_RECORDS];
+                                      /*!< Content of the journal file */
+    uint32_t journal_len;             /*!< Number of journal records which
+                                       *   apply to the active table
+                                       */
+#endif /* SST_TABLE_JOURNAL */
 };
 
 /* Object table context */
 static struct sst_obj_table_ctx_t sst_obj_table_ctx;
 
+/* Number of bits of the object index hash, so that the index has at least
+ * twice as many slots as there are entries in the object table.
+ */
+#if (SST_OBJ_TABLE_ENTRIES <= 8)
+#define SST_OBJ_INDEX_BITS 4
+#elif (SST_OBJ_TABLE_ENTRIES <= 16)
+#define SST_OBJ_INDEX_BITS 5
+#elif (SST_OBJ_TABLE_ENTRIES <= 32)
+#define SST_OBJ_INDEX_BITS 6
+#elif (SST_OBJ_TABLE_ENTRIES <= 64)
+#define SST_OBJ_INDEX_BITS 7
+#elif (SST_OBJ_TABLE_ENTRIES <= 128)
+#define SST_OBJ_INDEX_BITS 8
+#elif (SST_OBJ_TABLE_ENTRIES <= 256)
+#define SST_OBJ_INDEX_BITS 9
+#elif (SST_OBJ_TABLE_ENTRIES <= 512)
+#define SST_OBJ_INDEX_BITS 10
+#elif (SST_OBJ_TABLE_ENTRIES <= 1024)
+#define SST_OBJ_INDEX_BITS 11
+#elif (SST_OBJ_TABLE_ENTRIES <= 2048)
+#define SST_OBJ_INDEX_BITS 12
+#else
+#error "SST_NUM_ASSETS is too large for the object table index"
+#endif
+
+/* Number of slots in the object index */
+#define SST_OBJ_INDEX_SLOTS   (1U << SST_OBJ_INDEX_BITS)
+#define SST_OBJ_INDEX_MASK    (SST_OBJ_INDEX_SLOTS - 1U)
+
+/* Value of an empty object index slot */
+#define SST_OBJ_INDEX_EMPTY   0U
+
+/* Number of words of the free entries bitmap */
+#define SST_OBJ_FREE_MAP_WORDS  ((SST_OBJ_TABLE_ENTRIES + 31U) / 32U)
+
+/* Bit of the free entries bitmap for a table entry. The first entry is the
+ * most significant bit of the first word, so that __CLZ gives the lowest free
+ * entry of a word.
+ */
+#define SST_OBJ_FREE_MAP_BIT(idx)  (0x80000000U >> ((idx) % 32U))
+
+/*!
+ * \struct sst_obj_index_t
+ *
+ * \brief RAM index of the object table. It is rebuilt from the active object
+ *        table and is never stored in the file system.
+ */
+struct sst_obj_index_t {
+    uint16_t slot[SST_OBJ_INDEX_SLOTS];             /*!< Open addressing hash
+                                                     *   table of entry
+                                                     *   index + 1, keyed by
+                                                     *   UID and client ID
+                                                     */
+    uint32_t free_map[SST_OBJ_FREE_MAP_WORDS];      /*!< Bitmap of the free
+                                                     *   table entries
+                                                     */
+    uint32_t free_num;                              /*!< Number of free table
+                                                     *   entries
+                                                     */
+};
+
+/* Object table index */
+static struct sst_obj_index_t sst_obj_index;
+
 /* Object table size */
 #define SST_OBJ_TABLE_SIZE            sizeof(struct sst_obj_table_t)
 
@@ -144,6 +272,14 @@ static struct sst_obj_table_ctx_t sst_obj_table_ctx;
 #define SST_CRYPTO_ASSOCIATED_DATA(crypto) ((uint8_t *)crypto + \
                                             SST_NON_AUTH_OBJ_TABLE_SIZE)
 
+#if defined(SST_TABLE_JOURNAL) && defined(SST_ENCRYPTION)
+/* The associated data of a journal record is the record minus the crypto
+ * data.
+ */
+#define SST_JOURNAL_REC_ASSOCIATED_DATA_LEN (SST_TABLE_JOURNAL_REC_SIZE - \
+                                             SST_NON_AUTH_OBJ_TABLE_SIZE)
+#endif
+
 #ifdef SST_ROLLBACK_PROTECTION
 #define SST_OBJ_TABLE_AUTH_DATA_SIZE (SST_OBJ_TABLE_SIZE - \
                                       SST_NON_AUTH_OBJ_TABLE_SIZE)
@@ -581,6 +717,250 @@ static psa_ps_status_t sst_object_table_save_table(
     return err;
 }
 
+#ifdef SST_TABLE_JOURNAL
+/**
+ * \brief Saves the whole object table in the persistent memory, including the
+ *        journaled changes, and removes the journal.
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_compact(void)
+{
+    psa_ps_status_t err;
+    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
+    uint32_t journal_seq = p_table->journal_seq;
+
+    /* The records in the journal file no longer apply to the new table */
+    p_table->journal_seq += sst_obj_table_ctx.journal_len;
+
+    err = sst_object_table_save_table(p_table);
+    if (err != PSA_PS_SUCCESS) {
+        p_table->journal_seq = journal_seq;
+        return err;
+    }
+
+    sst_obj_table_ctx.journal_len = 0;
+
+    /* A journal file left behind only contains records which are older than
+     * the table, and it is removed before the next journal is created, so an
+     * error here does not fail the commit.
+     */
+    (void)sst_flash_fs_file_delete(SST_TABLE_JOURNAL_FS_ID);
+
+    return PSA_PS_SUCCESS;
+}
+
+/**
+ * \brief Appends the content of the given table entries to the journal.
+ *
+ * \param[in] idx  Array of indexes of the changed table entries
+ * \param[in] num  Number of indexes in the array
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_journal_append(const uint32_t *idx,
+                                                       uint32_t num)
+{
+    psa_ps_status_t err;
+    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
+    struct sst_obj_table_journal_rec_t *rec;
+    uint32_t len = sst_obj_table_ctx.journal_len;
+    uint32_t i;
+
+#ifdef SST_ENCRYPTION
+    /* Set object table key */
+    err = sst_crypto_setkey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif /* SST_ENCRYPTION */
+
+    for (i = 0; i < num; i++) {
+        rec = &sst_obj_table_ctx.journal[len + i];
+
+        (void)tfm_memset(rec, SST_DEFAULT_EMPTY_BUFF_VAL,
+                         SST_TABLE_JOURNAL_REC_SIZE);
+
+        rec->seq = p_table->journal_seq + len + i;
+        rec->idx = idx[i];
+        (void)tfm_memcpy(&rec->entry, &p_table->obj_db[idx[i]],
+                         SST_OBJECTS_TABLE_ENTRY_SIZE);
+
+#ifdef SST_ENCRYPTION
+        /* Only the new record is authenticated */
+        sst_crypto_get_iv(&rec->crypto);
+
+        err = sst_crypto_generate_auth_tag(&rec->crypto,
+                                       SST_CRYPTO_ASSOCIATED_DATA(&rec->crypto),
+                                       SST_JOURNAL_REC_ASSOCIATED_DATA_LEN);
+        if (err != PSA_PS_SUCCESS) {
+            (void)sst_crypto_destroykey();
+            return err;
+        }
+#endif /* SST_ENCRYPTION */
+    }
+
+#ifdef SST_ENCRYPTION
+    err = sst_crypto_destroykey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif /* SST_ENCRYPTION */
+
+    /* The file system does not keep the file content around a partial write,
+     * so the file is always written from its start.
+     */
+    if (len == 0) {
+        /* A journal file left behind by a compaction only contains records
+         * which are older than the table, and it would make the creation
+         * fail, so it is removed first.
+         */
+        err = sst_flash_fs_file_delete(SST_TABLE_JOURNAL_FS_ID);
+        if ((err != PSA_PS_SUCCESS) && (err != PSA_PS_ERROR_UID_NOT_FOUND)) {
+            return err;
+        }
+
+        err = sst_flash_fs_file_create(SST_TABLE_JOURNAL_FS_ID,
+                                       SST_TABLE_JOURNAL_SIZE,
+                                       (len + num) * SST_TABLE_JOURNAL_REC_SIZE,
+                                   (const uint8_t *)sst_obj_table_ctx.journal);
+    } else {
+        err = sst_flash_fs_file_write(SST_TABLE_JOURNAL_FS_ID,
+                                      (len + num) * SST_TABLE_JOURNAL_REC_SIZE,
+                                      0,
+                                   (const uint8_t *)sst_obj_table_ctx.journal);
+    }
+
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    sst_obj_table_ctx.journal_len = len + num;
+
+    return PSA_PS_SUCCESS;
+}
+
+/**
+ * \brief Reads the journal from the persistent memory and applies its records
+ *        to the active object table.
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_journal_replay(void)
+{
+    psa_ps_status_t err;
+    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
+    struct sst_obj_table_journal_rec_t *rec;
+    struct sst_file_info_t info;
+    uint32_t num;
+    uint32_t i;
+
+    sst_obj_table_ctx.journal_len = 0;
+
+    err = sst_flash_fs_file_get_info(SST_TABLE_JOURNAL_FS_ID, &info);
+    if (err == PSA_PS_ERROR_UID_NOT_FOUND) {
+        return PSA_PS_SUCCESS;
+    } else if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+
+    num = info.size_current / SST_TABLE_JOURNAL_REC_SIZE;
+    if (num > SST_TABLE_JOURNAL_RECORDS) {
+        num = SST_TABLE_JOURNAL_RECORDS;
+    }
+
+    if (num != 0) {
+        err = sst_flash_fs_file_read(SST_TABLE_JOURNAL_FS_ID,
+                                     num * SST_TABLE_JOURNAL_REC_SIZE, 0,
+                                     (uint8_t *)sst_obj_table_ctx.journal);
+        if (err != PSA_PS_SUCCESS) {
+            return err;
+        }
+    }
+
+#ifdef SST_ENCRYPTION
+    /* Set object table key */
+    err = sst_crypto_setkey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif /* SST_ENCRYPTION */
+
+    for (i = 0; i < num; i++) {
+        rec = &sst_obj_table_ctx.journal[i];
+
+        /* Stop at the first record which does not follow on from the active
+         * table.
+         */
+        if ((rec->seq != (p_table->journal_seq + i))
+            || (rec->idx >= SST_OBJ_TABLE_ENTRIES)) {
+            break;
+        }
+
+#ifdef SST_ENCRYPTION
+        err = sst_crypto_authenticate(&rec->crypto,
+                                      SST_CRYPTO_ASSOCIATED_DATA(&rec->crypto),
+                                      SST_JOURNAL_REC_ASSOCIATED_DATA_LEN);
+        if (err != PSA_PS_SUCCESS) {
+            break;
+        }
+#endif /* SST_ENCRYPTION */
+
+        (void)tfm_memcpy(&p_table->obj_db[rec->idx], &rec->entry,
+                         SST_OBJECTS_TABLE_ENTRY_SIZE);
+    }
+
+#ifdef SST_ENCRYPTION
+    err = sst_crypto_destroykey();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif /* SST_ENCRYPTION */
+
+    sst_obj_table_ctx.journal_len = i;
+
+    if (i == 0) {
+        /* No record applies to the active table, so the journal file is
+         * removed to be created again by the next journaled commit.
+         */
+        return sst_flash_fs_file_delete(SST_TABLE_JOURNAL_FS_ID);
+    }
+
+    return PSA_PS_SUCCESS;
+}
+#endif /* SST_TABLE_JOURNAL */
+
+/**
+ * \brief Commits the changes of the given table entries in the persistent
+ *        memory.
+ *
+ * \param[in] idx  Array of indexes of the changed table entries
+ * \param[in] num  Number of indexes in the array
+ *
+ * \return Returns error code as specified in \ref psa_ps_status_t
+ */
+static psa_ps_status_t sst_object_table_commit(const uint32_t *idx,
+                                               uint32_t num)
+{
+#ifdef SST_TABLE_JOURNAL
+    if ((sst_obj_table_ctx.journal_len + num) <= SST_TABLE_JOURNAL_RECORDS) {
+        if (sst_object_table_journal_append(idx, num) == PSA_PS_SUCCESS) {
+            return PSA_PS_SUCCESS;
+        }
+    }
+
+    /* The journal is full or cannot be written, so the changes are committed
+     * with the whole table.
+     */
+    return sst_object_table_compact();
+#else
+    (void)idx;
+    (void)num;
+
+    return sst_object_table_save_table(&sst_obj_table_ctx.obj_table);
+#endif /* SST_TABLE_JOURNAL */
+}
+
 /**
  * \brief Checks the validity of the table version.
  *
@@ -718,6 +1098,123 @@ static psa_ps_status_t sst_set_active_object_table(
     return PSA_PS_SUCCESS;
 }
 
+/**
+ * \brief Gets the object index slot where the search for the given object UID
+ *        and client ID starts.
+ *
+ * \param[in] uid        Object UID
+ * \param[in] client_id  Client UID
+ *
+ * \return Returns the slot number
+ */
+static uint32_t sst_obj_index_hash(psa_ps_uid_t uid, int32_t client_id)
+{
+    uint32_t hash;
+
+    hash = ((uint32_t)uid ^ (uint32_t)(uid >> 32)) * 0x9E3779B1U;
+    hash = (hash ^ (uint32_t)client_id) * 0x85EBCA6BU;
+
+    return hash >> (32U - SST_OBJ_INDEX_BITS);
+}
+
+/**
+ * \brief Adds a table entry to the object index and marks it as used.
+ *
+ * \param[in] idx  Index of the entry in the object table
+ */
+static void sst_obj_index_add(uint32_t idx)
+{
+    const struct sst_obj_table_entry_t *entry =
+                                       &sst_obj_table_ctx.obj_table.obj_db[idx];
+    uint32_t slot = sst_obj_index_hash(entry->uid, entry->client_id);
+
+    /* The index has more slots than there are table entries, so an empty
+     * slot is always found.
+     */
+    while (sst_obj_index.slot[slot] != SST_OBJ_INDEX_EMPTY) {
+        slot = (slot + 1U) & SST_OBJ_INDEX_MASK;
+    }
+
+    sst_obj_index.slot[slot] = (uint16_t)(idx + 1U);
+
+    sst_obj_index.free_map[idx / 32U] &= ~SST_OBJ_FREE_MAP_BIT(idx);
+    sst_obj_index.free_num--;
+}
+
+/**
+ * \brief Removes a table entry from the object index and marks it as free.
+ *        The entry must still contain its UID and client ID.
+ *
+ * \param[in] idx  Index of the entry in the object table
+ */
+static void sst_obj_index_remove(uint32_t idx)
+{
+    const struct sst_obj_table_entry_t *entry =
+                                       &sst_obj_table_ctx.obj_table.obj_db[idx];
+    uint32_t slot = sst_obj_index_hash(entry->uid, entry->client_id);
+    uint32_t next;
+    uint32_t home;
+
+    while (sst_obj_index.slot[slot] != (uint16_t)(idx + 1U)) {
+        if (sst_obj_index.slot[slot] == SST_OBJ_INDEX_EMPTY) {
+            /* Not in the index */
+            return;
+        }
+        slot = (slot + 1U) & SST_OBJ_INDEX_MASK;
+    }
+
+    /* Shift back the following slots of the probe sequence, so that no
+     * lookup stops early at the slot being emptied.
+     */
+    next = slot;
+    for (;;) {
+        next = (next + 1U) & SST_OBJ_INDEX_MASK;
+        if (sst_obj_index.slot[next] == SST_OBJ_INDEX_EMPTY) {
+            break;
+        }
+
+        entry = &sst_obj_table_ctx.obj_table.obj_db[
+                                                 sst_obj_index.slot[next] - 1U];
+        home = sst_obj_index_hash(entry->uid, entry->client_id);
+
+        /* Move the slot back unless its home lies cyclically in
+         * (slot, next].
+         */
+        if (((next - home) & SST_OBJ_INDEX_MASK) >=
+            ((next - slot) & SST_OBJ_INDEX_MASK)) {
+            sst_obj_index.slot[slot] = sst_obj_index.slot[next];
+            slot = next;
+        }
+    }
+
+    sst_obj_index.slot[slot] = SST_OBJ_INDEX_EMPTY;
+
+    sst_obj_index.free_map[idx / 32U] |= SST_OBJ_FREE_MAP_BIT(idx);
+    sst_obj_index.free_num++;
+}
+
+/**
+ * \brief Rebuilds the object index from the content of the object table.
+ */
+static void sst_obj_index_rebuild(void)
+{
+    uint32_t i;
+
+    (void)tfm_memset(&sst_obj_index, 0, sizeof(sst_obj_index));
+
+    /* Mark all the entries free, then add the used ones */
+    for (i = 0; i < SST_OBJ_TABLE_ENTRIES; i++) {
+        sst_obj_index.free_map[i / 32U] |= SST_OBJ_FREE_MAP_BIT(i);
+    }
+    sst_obj_index.free_num = SST_OBJ_TABLE_ENTRIES;
+
+    for (i = 0; i < SST_OBJ_TABLE_ENTRIES; i++) {
+        if (sst_obj_table_ctx.obj_table.obj_db[i].uid != TFM_SST_INVALID_UID) {
+            sst_obj_index_add(i);
+        }
+    }
+}
+
 /**
  * \brief Gets table's entry index based on the given object UID and client ID.
  *
@@ -732,15 +1229,22 @@ static psa_ps_status_t sst_get_object_entry_idx(psa_ps_uid_t uid,
                                                 int32_t client_id,
                                                 uint32_t *idx)
 {
+    uint32_t slot = sst_obj_index_hash(uid, client_id);
     uint32_t i;
     struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
 
-    for (i = 0; i < SST_OBJ_TABLE_ENTRIES; i++) {
+    if (uid == TFM_SST_INVALID_UID) {
+        return PSA_PS_ERROR_UID_NOT_FOUND;
+    }
+
+    while (sst_obj_index.slot[slot] != SST_OBJ_INDEX_EMPTY) {
+        i = sst_obj_index.slot[slot] - 1U;
         if (p_table->obj_db[i].uid == uid
             && p_table->obj_db[i].client_id == client_id) {
             *idx = i;
             return PSA_PS_SUCCESS;
         }
+        slot = (slot + 1U) & SST_OBJ_INDEX_MASK;
     }
 
     return PSA_PS_ERROR_UID_NOT_FOUND;
@@ -765,26 +1269,31 @@ __STATIC_INLINE psa_ps_status_t sst_table_free_idx(uint32_t idx_num,
                                                    uint32_t *idx)
 {
     uint32_t i;
-    uint32_t last_free = 0;
-    struct sst_obj_table_t *p_table = &sst_obj_table_ctx.obj_table;
+    uint32_t word;
+    uint32_t bit;
 
     if (idx_num == 0) {
         return PSA_PS_ERROR_INVALID_ARGUMENT;
     }
 
-    for (i = 0; i < SST_OBJ_TABLE_ENTRIES && idx_num > 0; i++) {
-        if (p_table->obj_db[i].uid == TFM_SST_INVALID_UID) {
-            last_free = i;
-            idx_num--;
-        }
+    if (idx_num > sst_obj_index.free_num) {
+        return PSA_PS_ERROR_INSUFFICIENT_SPACE;
     }
 
-    if (idx_num != 0) {
-        return PSA_PS_ERROR_INSUFFICIENT_SPACE;
-    } else {
-        *idx = last_free;
-        return PSA_PS_SUCCESS;
+    /* Return the idx_num-th free index, in table order */
+    for (i = 0; i < SST_OBJ_FREE_MAP_WORDS; i++) {
+        word = sst_obj_index.free_map[i];
+        while (word != 0) {
+            bit = __CLZ(word);
+            if (--idx_num == 0) {
+                *idx = (i * 32U) + bit;
+                return PSA_PS_SUCCESS;
+            }
+            word &= ~(0x80000000U >> bit);
+        }
     }
+
+    return PSA_PS_ERROR_INSUFFICIENT_SPACE;
 }
 
 /**
@@ -795,6 +1304,10 @@ __STATIC_INLINE psa_ps_status_t sst_table_free_idx(uint32_t idx_num,
  */
 static void sst_table_delete_entry(uint32_t idx)
 {
+    if (sst_obj_table_ctx.obj_table.obj_db[idx].uid != TFM_SST_INVALID_UID) {
+        sst_obj_index_remove(idx);
+    }
+
     /* Initialise object table entry structure */
     (void)tfm_memset(&sst_obj_table_ctx.obj_table.obj_db[idx],
                      SST_DEFAULT_EMPTY_BUFF_VAL, SST_OBJECTS_TABLE_ENTRY_SIZE);
@@ -826,8 +1339,17 @@ psa_ps_status_t sst_object_table_create(void)
 
     p_table->version = SST_OBJECT_SYSTEM_VERSION;
 
+    sst_obj_index_rebuild();
+
+#ifdef SST_TABLE_JOURNAL
+    p_table->journal_seq = SST_TABLE_JOURNAL_FIRST_SEQ;
+
+    /* Save object table contents and remove any previous journal */
+    return sst_object_table_compact();
+#else
     /* Save object table contents */
     return sst_object_table_save_table(p_table);
+#endif
 }
 
 psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
@@ -887,6 +1409,17 @@ psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
         return err;
     }
 
+#ifdef SST_TABLE_JOURNAL
+    /* Apply the journaled changes on top of the active table */
+    err = sst_object_table_journal_replay();
+    if (err != PSA_PS_SUCCESS) {
+        return err;
+    }
+#endif
+
+    /* Index the entries of the active table */
+    sst_obj_index_rebuild();
+
     /* Remove the old object table file */
     err = sst_flash_fs_file_delete(SST_TABLE_FS_ID(
                                               sst_obj_table_ctx.scratch_table));
@@ -903,7 +1436,16 @@ psa_ps_status_t sst_object_table_init(uint8_t *obj_data)
 #endif /* SST_ROLLBACK_PROTECTION */
 
 #ifdef SST_ENCRYPTION
-    sst_crypto_set_iv(&sst_obj_table_ctx.obj_table.crypto);
+#ifdef SST_TABLE_JOURNAL
+    if (sst_obj_table_ctx.journal_len != 0) {
+        /* The last journal record has the most recent IV */
+        sst_crypto_set_iv(&sst_obj_table_ctx.journal[
+                                   sst_obj_table_ctx.journal_len - 1].crypto);
+    } else
+#endif
+    {
+        sst_crypto_set_iv(&sst_obj_table_ctx.obj_table.crypto);
+    }
 #endif
 
     return PSA_PS_SUCCESS;
@@ -959,6 +1501,8 @@ psa_ps_status_t sst_object_table_set_obj_tbl_info(psa_ps_uid_t uid,
     psa_ps_status_t err;
     uint32_t idx = 0;
     uint32_t backup_idx = 0;
+    uint32_t changed_idx[2];
+    uint32_t changed_num = 0;
     struct sst_obj_table_entry_t backup_entry = {
 #ifdef SST_ENCRYPTION
         .tag = {0U},
@@ -980,11 +1524,16 @@ psa_ps_status_t sst_object_table_set_obj_tbl_info(psa_ps_uid_t uid,
 
         /* Deletes old object information if it exist in the table */
         sst_table_delete_entry(backup_idx);
+        changed_idx[changed_num++] = backup_idx;
     }
 
     idx = SST_OBJECT_FS_ID_TO_IDX(obj_tbl_info->fid);
+    if (p_table->obj_db[idx].uid != TFM_SST_INVALID_UID) {
+        sst_obj_index_remove(idx);
+    }
     p_table->obj_db[idx].uid = uid;
     p_table->obj_db[idx].client_id = client_id;
+    sst_obj_index_add(idx);
 
     /* Add new object information */
 #ifdef SST_ENCRYPTION
@@ -993,16 +1542,18 @@ psa_ps_status_t sst_object_table_set_obj_tbl_info(psa_ps_uid_t uid,
 #else
     p_table->obj_db[idx].version = obj_tbl_info->version;
 #endif
+    changed_idx[changed_num++] = idx;
 
-    err = sst_object_table_save_table(p_table);
+    err = sst_object_table_commit(changed_idx, changed_num);
     if (err != PSA_PS_SUCCESS) {
+        sst_table_delete_entry(idx);
+
         if (backup_entry.uid != TFM_SST_INVALID_UID) {
             /* Rollback the change in the table */
             (void)tfm_memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                              SST_OBJECTS_TABLE_ENTRY_SIZE);
+            sst_obj_index_add(backup_idx);
         }
-
-        sst_table_delete_entry(idx);
     }
 
     return err;
@@ -1059,11 +1610,12 @@ psa_ps_status_t sst_object_table_delete_object(psa_ps_uid_t uid,
 
     sst_table_delete_entry(backup_idx);
 
-    err = sst_object_table_save_table(p_table);
+    err = sst_object_table_commit(&backup_idx, 1);
     if (err != PSA_PS_SUCCESS) {
        /* Rollback the change in the table */
        (void)tfm_memcpy(&p_table->obj_db[backup_idx], &backup_entry,
                         SST_OBJECTS_TABLE_ENTRY_SIZE);
+       sst_obj_index_add(backup_idx);
     }
 
     return err;
@@ -1073,5 +1625,12 @@ psa_ps_status_t sst_object_table_delete_old_table(void)
 {
     uint32_t table_id = SST_TABLE_FS_ID(sst_obj_table_ctx.scratch_table);
 
+#ifdef SST_TABLE_JOURNAL
+    if (sst_flash_fs_file_exist(table_id) != PSA_PS_SUCCESS) {
+        /* The last change was journaled, so there is no old table */
+        return PSA_PS_SUCCESS;
+    }
+#endif
+
     return sst_flash_fs_file_delete(table_id);
 }
@@ -159,6 +159,12 @@ struct tfm_spm_service_t {
     struct tfm_msg_queue_t msg_queue;        /* Message queue                */
     struct tfm_list_node_t list;             /* For list operation           */
 };
+
+/* Entry of the service index, sorted by SID at build time */
+struct tfm_spm_service_sid_t {
+    uint32_t sid;                       /* Service identifier                */
+    struct tfm_spm_service_t *service;  /* RoT service pointer               */
+};
 #endif /* ifdef(TFM_PSA_API) */
 
 /*********************** common definitions ***********************/
@@ -36,6 +36,7 @@
 /* Extern service variable */
 extern struct tfm_spm_service_t service[];
 extern const struct tfm_spm_service_db_t service_db[];
+extern struct tfm_spm_service_sid_t service_sid_index[];
 
 /* Extern SPM variable */
 extern struct spm_partition_db_t g_spm_partition_db;
@@ -182,34 +183,43 @@ struct tfm_spm_service_t *
     return NULL;
 }
 
-struct tfm_spm_service_t *tfm_spm_get_service_by_sid(uint32_t sid)
+/**
+ * \brief                   Find the entry of the service index of a SID.
+ *
+ * \param[in] sid           RoT Service identity
+ *
+ * \retval NULL             No service has this SID
+ * \retval "Not NULL"       Entry of the service index
+ */
+static struct tfm_spm_service_sid_t *tfm_spm_find_service_sid(uint32_t sid)
 {
-    uint32_t i;
-    struct tfm_list_node_t *node, *head;
-    struct tfm_spm_service_t *service;
-    struct spm_partition_desc_t *partition;
-
-    for (i = 0; i < g_spm_partition_db.partition_count; i++) {
-        partition = &g_spm_partition_db.partitions[i];
-        /* Skip partition without IPC flag */
-        if ((tfm_spm_partition_get_flags(i) & SPM_PART_FLAG_IPC) == 0) {
-            continue;
+    uint32_t low = 0;
+    uint32_t high = sizeof(service_sid_index) /
+                    sizeof(struct tfm_spm_service_sid_t);
+    uint32_t mid;
+
+    /* The index is sorted by SID when it is generated from the manifests */
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        if (service_sid_index[mid].sid == sid) {
+            return &service_sid_index[mid];
+        } else if (service_sid_index[mid].sid < sid) {
+            low = mid + 1;
+        } else {
+            high = mid;
         }
+    }
+    return NULL;
+}
 
-        if (tfm_list_is_empty(&partition->runtime_data.service_list)) {
-            continue;
-        }
+struct tfm_spm_service_t *tfm_spm_get_service_by_sid(uint32_t sid)
+{
+    struct tfm_spm_service_sid_t *entry = tfm_spm_find_service_sid(sid);
 
-        head = &partition->runtime_data.service_list;
-        TFM_LIST_FOR_EACH(node, head) {
-            service = TFM_GET_CONTAINER_PTR(node, struct tfm_spm_service_t,
-                                            list);
-            if (service->service_db->sid == sid) {
-                return service;
-            }
-        }
+    if (!entry) {
+        return NULL;
     }
-    return NULL;
+    return entry->service;
 }
 
 struct tfm_spm_service_t *
@@ -401,6 +411,31 @@ void tfm_spm_fill_msg(struct tfm_msg_body_t *msg,
     }
 }
 
+#ifdef TFM_MSG_QUEUE_PRIORITY
+/*
+ * A message takes the priority class of its client thread, which is the
+ * current thread when the message is sent. The priority of a secure partition
+ * thread is set in its manifest.
+ */
+static uint32_t tfm_spm_get_msg_prior_class(const struct tfm_msg_body_t *msg)
+{
+    uint32_t prior;
+
+    /*
+     * The client of an RPC message runs on the peer core. It is served at the
+     * priority of the non-secure partition.
+     */
+    if (is_tfm_rpc_msg(msg)) {
+        prior = TFM_PRIORITY_LOW;
+    } else {
+        prior = tfm_thrd_curr_thread()->prior;
+    }
+
+    return (prior & THRD_PRIOR_MASK) * TFM_MSG_QUEUE_PRIOR_CLASSES /
+           (THRD_PRIOR_MASK + 1);
+}
+#endif
+
 int32_t tfm_spm_send_event(struct tfm_spm_service_t *service,
                            struct tfm_msg_body_t *msg)
 {
@@ -410,6 +445,10 @@ int32_t tfm_spm_send_event(struct tfm_spm_service_t *service,
     TFM_CORE_ASSERT(service);
     TFM_CORE_ASSERT(msg);
 
+#ifdef TFM_MSG_QUEUE_PRIORITY
+    msg->prior_class = tfm_spm_get_msg_prior_class(msg);
+#endif
+
     /* Enqueue message to service message queue */
     if (tfm_msg_enqueue(&service->msg_queue, msg) != IPC_SUCCESS) {
         return IPC_ERROR_GENERIC;
@@ -516,6 +555,7 @@ void tfm_spm_init(void)
     struct spm_partition_desc_t *partition;
     struct tfm_thrd_ctx *pth, *p_ns_entry_thread = NULL;
     const struct tfm_spm_partition_platform_data_t **platform_data_p;
+    struct tfm_spm_service_sid_t *entry;
 
     tfm_pool_init(conn_handle_pool,
                   POOL_BUFFER_SIZE(conn_handle_pool),
@@ -601,6 +641,12 @@ void tfm_spm_init(void)
         tfm_list_init(&service[i].handle_list);
         tfm_list_add_tail(&partition->runtime_data.service_list,
                           &service[i].list);
+
+        entry = tfm_spm_find_service_sid(service[i].service_db->sid);
+        if (!entry) {
+            tfm_core_panic();
+        }
+        entry->service = &service[i];
     }
 
     /*
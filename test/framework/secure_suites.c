@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -29,12 +29,20 @@ static struct test_suite_t test_suites[] = {
 #ifdef SST_TEST_NV_COUNTERS
     {&register_testsuite_s_rollback_protection, 0, 0, 0},
 #endif
+
+#ifdef SST_TEST_TABLE_JOURNAL
+    {&register_testsuite_s_table_journal, 0, 0, 0},
+#endif
 #endif
 
 #ifdef ENABLE_INTERNAL_TRUSTED_STORAGE_SERVICE_TESTS
     /* Secure ITS test cases */
     {&register_testsuite_s_psa_its_interface, 0, 0, 0},
     {&register_testsuite_s_psa_its_reliability, 0, 0, 0},
+
+#ifdef ITS_TEST_FLASH_FS
+    {&register_testsuite_s_its_flash_fs, 0, 0, 0},
+#endif
 #endif
 
 #ifdef ENABLE_CRYPTO_SERVICE_TESTS
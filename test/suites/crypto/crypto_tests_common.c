@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -482,6 +482,280 @@ void psa_hash_test(const psa_algorithm_t alg,
     ret->val = TEST_PASSED;
 }
 
+void psa_hash_large_input_test(const psa_algorithm_t alg,
+                               struct test_result_t *ret)
+{
+    static const uint8_t msg[LARGE_MSG_SIZE] = {0};
+    uint8_t hash[PSA_HASH_MAX_SIZE] = {0};
+    size_t hash_length = 0;
+    uint32_t idx;
+
+    psa_status_t status;
+    psa_hash_operation_t handle = psa_hash_operation_init();
+
+    /* Hash the message in small chunks to get the reference value */
+    status = psa_hash_setup(&handle, alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up hash operation object");
+        return;
+    }
+
+    for (idx = 0; idx < LARGE_MSG_SIZE; idx += BYTE_SIZE_CHUNK) {
+        status = psa_hash_update(&handle, &msg[idx], BYTE_SIZE_CHUNK);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Error updating the hash operation object");
+            return;
+        }
+    }
+
+    status = psa_hash_finish(&handle, hash, sizeof(hash), &hash_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error finalising the hash operation object");
+        return;
+    }
+
+    /* Hash the whole message in a single update */
+    handle = psa_hash_operation_init();
+    status = psa_hash_setup(&handle, alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up hash operation object");
+        return;
+    }
+
+    status = psa_hash_update(&handle, msg, LARGE_MSG_SIZE);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error updating the hash operation object with large input");
+        return;
+    }
+
+    /* Both hashes must match */
+    status = psa_hash_verify(&handle, hash, hash_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Hash of the large input is not as expected");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+void psa_mac_large_input_test(const psa_algorithm_t alg,
+                              struct test_result_t *ret)
+{
+    static const uint8_t msg[LARGE_MSG_SIZE] = {0};
+    const uint8_t data[] = "THIS IS MY KEY1";
+    uint8_t mac[PSA_HASH_MAX_SIZE] = {0};
+    size_t mac_length = 0;
+    uint32_t idx;
+
+    psa_key_handle_t key_handle;
+    psa_status_t status;
+    psa_mac_operation_t handle = psa_mac_operation_init();
+    psa_key_policy_t policy = psa_key_policy_init();
+    psa_key_usage_t usage = (PSA_KEY_USAGE_SIGN | PSA_KEY_USAGE_VERIFY);
+
+    ret->val = TEST_PASSED;
+
+    /* Allocate a transient key */
+    status = psa_allocate_key(&key_handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Failed to allocate key");
+        return;
+    }
+
+    /* Setup the key policy */
+    psa_key_policy_set_usage(&policy, usage, alg);
+    status = psa_set_key_policy(key_handle, &policy);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Failed to set key policy");
+        goto destroy_key_mac_large;
+    }
+
+    status = psa_import_key(key_handle, PSA_KEY_TYPE_HMAC, data,
+                            sizeof(data));
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error importing a key");
+        goto destroy_key_mac_large;
+    }
+
+    /* Compute the MAC of the message in small chunks as reference */
+    status = psa_mac_sign_setup(&handle, key_handle, alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up mac operation object");
+        goto destroy_key_mac_large;
+    }
+
+    for (idx = 0; idx < LARGE_MSG_SIZE; idx += BYTE_SIZE_CHUNK) {
+        status = psa_mac_update(&handle, &msg[idx], BYTE_SIZE_CHUNK);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Error during mac operation");
+            goto destroy_key_mac_large;
+        }
+    }
+
+    status = psa_mac_sign_finish(&handle, mac, sizeof(mac), &mac_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error during finalising the mac operation");
+        goto destroy_key_mac_large;
+    }
+
+    /* Verify the MAC of the whole message given in a single update */
+    handle = psa_mac_operation_init();
+    status = psa_mac_verify_setup(&handle, key_handle, alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up mac operation object");
+        goto destroy_key_mac_large;
+    }
+
+    status = psa_mac_update(&handle, msg, LARGE_MSG_SIZE);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error during mac operation with large input");
+        goto destroy_key_mac_large;
+    }
+
+    status = psa_mac_verify_finish(&handle, mac, mac_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("MAC of the large input is not as expected");
+        goto destroy_key_mac_large;
+    }
+
+destroy_key_mac_large:
+    /* Destroy the key */
+    status = psa_destroy_key(key_handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error destroying a key");
+    }
+}
+
+void psa_cipher_large_input_test(const psa_key_type_t key_type,
+                                 const psa_algorithm_t alg,
+                                 struct test_result_t *ret)
+{
+    static const uint8_t plain_text[LARGE_MSG_SIZE] = {0};
+    static uint8_t encrypted_data[LARGE_MSG_SIZE];
+    uint8_t decrypted_data[BYTE_SIZE_CHUNK];
+    const uint8_t data[] = "THIS IS MY KEY1";
+    const uint8_t iv[] = "012345678901234";
+    const size_t iv_length = PSA_BLOCK_CIPHER_BLOCK_SIZE(key_type);
+    size_t output_length = 0;
+    uint32_t comp_result;
+    uint32_t idx;
+
+    psa_key_handle_t key_handle;
+    psa_status_t status;
+    psa_cipher_operation_t handle = psa_cipher_operation_init();
+    psa_cipher_operation_t handle_dec = psa_cipher_operation_init();
+    psa_key_policy_t policy = psa_key_policy_init();
+    psa_key_usage_t usage = (PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT);
+
+    ret->val = TEST_PASSED;
+
+    /* Allocate a transient key */
+    status = psa_allocate_key(&key_handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Failed to allocate key");
+        return;
+    }
+
+    /* Setup the key policy */
+    psa_key_policy_set_usage(&policy, usage, alg);
+    status = psa_set_key_policy(key_handle, &policy);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Failed to set key policy");
+        goto destroy_key_cipher_large;
+    }
+
+    status = psa_import_key(key_handle, key_type, data, sizeof(data));
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error importing a key");
+        goto destroy_key_cipher_large;
+    }
+
+    /* Encrypt the whole message in a single update */
+    status = psa_cipher_encrypt_setup(&handle, key_handle, alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up cipher operation object");
+        goto destroy_key_cipher_large;
+    }
+
+    status = psa_cipher_set_iv(&handle, iv, iv_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting the IV on the cypher operation object");
+        (void)psa_cipher_abort(&handle);
+        goto destroy_key_cipher_large;
+    }
+
+    status = psa_cipher_update(&handle, plain_text, LARGE_MSG_SIZE,
+                               encrypted_data, sizeof(encrypted_data),
+                               &output_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error encrypting the large input");
+        (void)psa_cipher_abort(&handle);
+        goto destroy_key_cipher_large;
+    }
+
+    if (output_length != LARGE_MSG_SIZE) {
+        TEST_FAIL("Unexpected length of the encrypted large input");
+        (void)psa_cipher_abort(&handle);
+        goto destroy_key_cipher_large;
+    }
+
+    status = psa_cipher_abort(&handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error aborting the operation");
+        goto destroy_key_cipher_large;
+    }
+
+    /* Decrypt the result in small chunks and check the plain text */
+    status = psa_cipher_decrypt_setup(&handle_dec, key_handle, alg);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting up cipher operation object");
+        goto destroy_key_cipher_large;
+    }
+
+    status = psa_cipher_set_iv(&handle_dec, iv, iv_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error setting the IV for decryption");
+        (void)psa_cipher_abort(&handle_dec);
+        goto destroy_key_cipher_large;
+    }
+
+    for (idx = 0; idx < LARGE_MSG_SIZE; idx += BYTE_SIZE_CHUNK) {
+        status = psa_cipher_update(&handle_dec, &encrypted_data[idx],
+                                   BYTE_SIZE_CHUNK, decrypted_data,
+                                   sizeof(decrypted_data), &output_length);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Error during decryption");
+            (void)psa_cipher_abort(&handle_dec);
+            goto destroy_key_cipher_large;
+        }
+
+#if DOMAIN_NS == 1U
+        comp_result = memcmp(&plain_text[idx], decrypted_data,
+                             BYTE_SIZE_CHUNK);
+#else
+        comp_result = tfm_memcmp(&plain_text[idx], decrypted_data,
+                                 BYTE_SIZE_CHUNK);
+#endif
+        if ((output_length != BYTE_SIZE_CHUNK) || (comp_result != 0)) {
+            TEST_FAIL("Decrypted data doesn't match with plain text");
+            (void)psa_cipher_abort(&handle_dec);
+            goto destroy_key_cipher_large;
+        }
+    }
+
+    status = psa_cipher_abort(&handle_dec);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error aborting the operation");
+    }
+
+destroy_key_cipher_large:
+    /* Destroy the key */
+    status = psa_destroy_key(key_handle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Error destroying a key");
+    }
+}
+
 static const uint8_t hmac_val[][PSA_HASH_SIZE(PSA_ALG_SHA_512)] = {
     {0x0d, 0xa6, 0x9d, 0x02, 0x43, 0x17, 0x3e, 0x7e, /*!< SHA-1 */
      0xe7, 0x3b, 0xc6, 0xa9, 0x51, 0x06, 0x8a, 0xea,
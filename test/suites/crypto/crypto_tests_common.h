@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -58,6 +58,13 @@ extern "C" {
  */
 #define TEST_MAX_KEY_LENGTH (64)
 
+/**
+ * \brief Size in bytes of the message used in the large input tests. It is
+ *        bigger than the default size of the internal scratch buffer of the
+ *        service in IPC mode
+ */
+#define LARGE_MSG_SIZE (6144)
+
 /**
  * \brief Tests the key interfaces with different key types
  *
@@ -100,6 +107,38 @@ void psa_invalid_cipher_test(const psa_key_type_t key_type,
  */
 void psa_hash_test(const psa_algorithm_t alg,
                    struct test_result_t *ret);
+/**
+ * \brief Tests hashing a message bigger than the internal buffers of the
+ *        service in a single update
+ *
+ * \param[in]  alg PSA algorithm
+ * \param[out] ret Test result
+ *
+ */
+void psa_hash_large_input_test(const psa_algorithm_t alg,
+                               struct test_result_t *ret);
+/**
+ * \brief Tests verifying the MAC of a message bigger than the internal
+ *        buffers of the service in a single update
+ *
+ * \param[in]  alg PSA algorithm
+ * \param[out] ret Test result
+ *
+ */
+void psa_mac_large_input_test(const psa_algorithm_t alg,
+                              struct test_result_t *ret);
+/**
+ * \brief Tests encrypting a message bigger than the internal buffers of the
+ *        service in a single update
+ *
+ * \param[in]  key_type PSA key type
+ * \param[in]  alg      PSA algorithm
+ * \param[out] ret      Test result
+ *
+ */
+void psa_cipher_large_input_test(const psa_key_type_t key_type,
+                                 const psa_algorithm_t alg,
+                                 struct test_result_t *ret);
 /**
  * \brief Tests different MAC algorithms
  *
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -22,6 +22,9 @@ static void tfm_crypto_test_6011(struct test_result_t *ret);
 static void tfm_crypto_test_6012(struct test_result_t *ret);
 static void tfm_crypto_test_6013(struct test_result_t *ret);
 static void tfm_crypto_test_6014(struct test_result_t *ret);
+static void tfm_crypto_test_6015(struct test_result_t *ret);
+static void tfm_crypto_test_6016(struct test_result_t *ret);
+static void tfm_crypto_test_6017(struct test_result_t *ret);
 static void tfm_crypto_test_6019(struct test_result_t *ret);
 static void tfm_crypto_test_6020(struct test_result_t *ret);
 static void tfm_crypto_test_6021(struct test_result_t *ret);
@@ -57,6 +60,12 @@ static struct test_t crypto_tests[] = {
      "Non Secure Hash (SHA-384) interface", {0} },
     {&tfm_crypto_test_6014, "TFM_CRYPTO_TEST_6014",
      "Non Secure Hash (SHA-512) interface", {0} },
+    {&tfm_crypto_test_6015, "TFM_CRYPTO_TEST_6015",
+     "Non Secure Hash (SHA-256) of a large input", {0} },
+    {&tfm_crypto_test_6016, "TFM_CRYPTO_TEST_6016",
+     "Non Secure HMAC (SHA-256) verification of a large input", {0} },
+    {&tfm_crypto_test_6017, "TFM_CRYPTO_TEST_6017",
+     "Non Secure Symmetric encryption (AES-128-CTR) of a large input", {0} },
     {&tfm_crypto_test_6019, "TFM_CRYPTO_TEST_6019",
      "Non Secure HMAC (SHA-1) interface", {0} },
     {&tfm_crypto_test_6020, "TFM_CRYPTO_TEST_6020",
@@ -156,6 +165,21 @@ static void tfm_crypto_test_6014(struct test_result_t *ret)
     psa_hash_test(PSA_ALG_SHA_512, ret);
 }
 
+static void tfm_crypto_test_6015(struct test_result_t *ret)
+{
+    psa_hash_large_input_test(PSA_ALG_SHA_256, ret);
+}
+
+static void tfm_crypto_test_6016(struct test_result_t *ret)
+{
+    psa_mac_large_input_test(PSA_ALG_HMAC(PSA_ALG_SHA_256), ret);
+}
+
+static void tfm_crypto_test_6017(struct test_result_t *ret)
+{
+    psa_cipher_large_input_test(PSA_KEY_TYPE_AES, PSA_ALG_CTR, ret);
+}
+
 static void tfm_crypto_test_6019(struct test_result_t *ret)
 {
     psa_mac_test(PSA_ALG_HMAC(PSA_ALG_SHA_1), 0, ret);
@@ -23,6 +23,9 @@ static void tfm_crypto_test_5011(struct test_result_t *ret);
 static void tfm_crypto_test_5012(struct test_result_t *ret);
 static void tfm_crypto_test_5013(struct test_result_t *ret);
 static void tfm_crypto_test_5014(struct test_result_t *ret);
+static void tfm_crypto_test_5015(struct test_result_t *ret);
+static void tfm_crypto_test_5016(struct test_result_t *ret);
+static void tfm_crypto_test_5017(struct test_result_t *ret);
 static void tfm_crypto_test_5019(struct test_result_t *ret);
 static void tfm_crypto_test_5020(struct test_result_t *ret);
 static void tfm_crypto_test_5021(struct test_result_t *ret);
@@ -59,6 +62,12 @@ static struct test_t crypto_tests[] = {
      "Secure Hash (SHA-384) interface", {0} },
     {&tfm_crypto_test_5014, "TFM_CRYPTO_TEST_5014",
      "Secure Hash (SHA-512) interface", {0} },
+    {&tfm_crypto_test_5015, "TFM_CRYPTO_TEST_5015",
+     "Secure Hash (SHA-256) of a large input", {0} },
+    {&tfm_crypto_test_5016, "TFM_CRYPTO_TEST_5016",
+     "Secure HMAC (SHA-256) verification of a large input", {0} },
+    {&tfm_crypto_test_5017, "TFM_CRYPTO_TEST_5017",
+     "Secure Symmetric encryption (AES-128-CTR) of a large input", {0} },
     {&tfm_crypto_test_5019, "TFM_CRYPTO_TEST_5019",
      "Secure HMAC (SHA-1) interface", {0} },
     {&tfm_crypto_test_5020, "TFM_CRYPTO_TEST_5020",
@@ -160,6 +169,21 @@ static void tfm_crypto_test_5014(struct test_result_t *ret)
     psa_hash_test(PSA_ALG_SHA_512, ret);
 }
 
+static void tfm_crypto_test_5015(struct test_result_t *ret)
+{
+    psa_hash_large_input_test(PSA_ALG_SHA_256, ret);
+}
+
+static void tfm_crypto_test_5016(struct test_result_t *ret)
+{
+    psa_mac_large_input_test(PSA_ALG_HMAC(PSA_ALG_SHA_256), ret);
+}
+
+static void tfm_crypto_test_5017(struct test_result_t *ret)
+{
+    psa_cipher_large_input_test(PSA_KEY_TYPE_AES, PSA_ALG_CTR, ret);
+}
+
 static void tfm_crypto_test_5019(struct test_result_t *ret)
 {
     psa_mac_test(PSA_ALG_HMAC(PSA_ALG_SHA_1), 0, ret);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -12,6 +12,14 @@
 #ifdef TFM_PSA_API
 #include "psa_manifest/sid.h"
 #endif
+#include "tfm_api.h"
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+#include "tfm_ns_mailbox.h"
+#endif
+#ifdef TFM_MAILBOX_WAIT_IRQ
+#include "os_wrapper/thread.h"
+#include "os_wrapper/semaphore.h"
+#endif
 
 /* List of tests */
 static void tfm_ipc_test_1001(struct test_result_t *ret);
@@ -35,6 +43,16 @@ static void tfm_ipc_test_1009(struct test_result_t *ret);
 
 static void tfm_ipc_test_1010(struct test_result_t *ret);
 
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+static void tfm_ipc_test_1011(struct test_result_t *ret);
+#endif
+
+static void tfm_ipc_test_1013(struct test_result_t *ret);
+
+#if defined(TFM_MULTI_CORE_TOPOLOGY) && defined(TFM_MAILBOX_WAIT_IRQ)
+static void tfm_ipc_test_1014(struct test_result_t *ret);
+#endif
+
 static struct test_t ipc_veneers_tests[] = {
     {&tfm_ipc_test_1001, "TFM_IPC_TEST_1001",
      "Get PSA framework version", {0}},
@@ -62,6 +80,16 @@ static struct test_t ipc_veneers_tests[] = {
 #endif
     {&tfm_ipc_test_1010, "TFM_IPC_TEST_1010",
      "Test psa_call with the status of PSA_ERROR_PROGRAMMER_ERROR", {0}},
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+    {&tfm_ipc_test_1011, "TFM_IPC_TEST_1011",
+     "Fill every mailbox queue slot with PSA client calls", {0}},
+#endif
+    {&tfm_ipc_test_1013, "TFM_IPC_TEST_1013",
+     "Test tfm_psa_call_batch with successful and failing requests", {0}},
+#if defined(TFM_MULTI_CORE_TOPOLOGY) && defined(TFM_MAILBOX_WAIT_IRQ)
+    {&tfm_ipc_test_1014, "TFM_IPC_TEST_1014",
+     "Wake up threads waiting for concurrent PSA client calls", {0}},
+#endif
 };
 
 void register_testsuite_ns_ipc_interface(struct test_suite_t *p_test_suite)
@@ -360,3 +388,229 @@ static void tfm_ipc_test_1010(struct test_result_t *ret)
 
     psa_close(handle);
 }
+
+#ifdef TFM_MULTI_CORE_TOPOLOGY
+/**
+ * \brief Send one psa_connect() request per mailbox queue slot at once, so
+ *        that every SPE mailbox queue slot is in use, and check that each
+ *        request is replied.
+ *
+ * \note The RoT Service only accepts a single connection. Exactly one request
+ *       succeeds and the others are refused.
+ */
+static void tfm_ipc_test_1011(struct test_result_t *ret)
+{
+    struct psa_client_params_t params;
+    mailbox_msg_handle_t msg_handles[NUM_MAILBOX_QUEUE_SLOT];
+    int32_t reply;
+    uint32_t i, connected = 0;
+    psa_handle_t handle = PSA_NULL_HANDLE;
+
+    params.psa_connect_params.sid = IPC_SERVICE_TEST_BASIC_SID;
+    params.psa_connect_params.version = IPC_SERVICE_TEST_BASIC_VERSION;
+
+    for (i = 0; i < NUM_MAILBOX_QUEUE_SLOT; i++) {
+        msg_handles[i] = tfm_ns_mailbox_tx_client_req(MAILBOX_PSA_CONNECT,
+                                                      &params, 1);
+        if (msg_handles[i] < 0) {
+            TEST_FAIL("Failed to send a request to a free mailbox slot\r\n");
+            return;
+        }
+    }
+
+    /* No NSPE mailbox queue slot is left */
+    if (tfm_ns_mailbox_tx_client_req(MAILBOX_PSA_CONNECT, &params, 1) !=
+        MAILBOX_QUEUE_FULL) {
+        TEST_FAIL("A request is sent while all mailbox slots are used\r\n");
+        return;
+    }
+
+    for (i = 0; i < NUM_MAILBOX_QUEUE_SLOT; i++) {
+        while (!tfm_ns_mailbox_is_msg_replied(msg_handles[i])) {
+        }
+
+        if (tfm_ns_mailbox_rx_client_reply(msg_handles[i], &reply) !=
+            MAILBOX_SUCCESS) {
+            TEST_FAIL("Failed to fetch the reply of a request\r\n");
+            return;
+        }
+
+        if (reply > 0) {
+            handle = (psa_handle_t)reply;
+            connected++;
+        } else if (reply != PSA_ERROR_CONNECTION_REFUSED) {
+            TEST_FAIL("Unexpected reply to psa_connect()\r\n");
+            return;
+        }
+    }
+
+    if (handle != PSA_NULL_HANDLE) {
+        psa_close(handle);
+    }
+
+    if (connected != 1) {
+        TEST_FAIL("The RoT Service should accept a single connection\r\n");
+        return;
+    }
+
+    /* The mailbox is usable again once all the replies are fetched */
+    if (psa_version(IPC_SERVICE_TEST_BASIC_SID) == PSA_VERSION_NONE) {
+        TEST_FAIL("The mailbox is not usable after all slots were used\r\n");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+#endif
+
+/**
+ * \brief Submit a batch which mixes requests to IPC_SERVICE_TEST_BASIC and
+ *        IPC_SERVICE_TEST_CLIENT_PROGRAMMER_ERROR, and check the status of
+ *        each request.
+ */
+static void tfm_ipc_test_1013(struct test_result_t *ret)
+{
+    psa_handle_t basic_handle, error_handle;
+    struct tfm_psa_call_batch_req_t reqs[4];
+    psa_status_t status[4];
+    psa_status_t expected[4] = {PSA_SUCCESS, PSA_ERROR_PROGRAMMER_ERROR,
+                                PSA_SUCCESS, PSA_ERROR_PROGRAMMER_ERROR};
+    psa_status_t batch_status;
+    uint32_t i;
+
+    basic_handle = psa_connect(IPC_SERVICE_TEST_BASIC_SID,
+                               IPC_SERVICE_TEST_BASIC_VERSION);
+    if (basic_handle <= 0) {
+        TEST_FAIL("The RoT Service has refused the connection!\r\n");
+        return;
+    }
+
+    error_handle = psa_connect(IPC_SERVICE_TEST_CLIENT_PROGRAMMER_ERROR_SID,
+                             IPC_SERVICE_TEST_CLIENT_PROGRAMMER_ERROR_VERSION);
+    if (error_handle <= 0) {
+        psa_close(basic_handle);
+        TEST_FAIL("The RoT Service has refused the connection!\r\n");
+        return;
+    }
+
+    /*
+     * The second request to the failing service is rejected by SPM, as the
+     * connection has been terminated by the first one.
+     */
+    for (i = 0; i < 4; i++) {
+        reqs[i].handle = (i % 2 == 0) ? basic_handle : error_handle;
+        reqs[i].type = PSA_IPC_CALL;
+        reqs[i].in_vec = NULL;
+        reqs[i].in_len = 0;
+        reqs[i].out_vec = NULL;
+        reqs[i].out_len = 0;
+        status[i] = PSA_ERROR_GENERIC_ERROR;
+    }
+
+    batch_status = tfm_psa_call_batch(reqs, 4, status);
+
+    psa_close(basic_handle);
+    psa_close(error_handle);
+
+    if (batch_status != PSA_SUCCESS) {
+        TEST_FAIL("The batch should be processed!\r\n");
+        return;
+    }
+
+    for (i = 0; i < 4; i++) {
+        if (status[i] != expected[i]) {
+            TEST_LOG("Request %d returned %d\r\n", i, status[i]);
+            TEST_FAIL("Unexpected status of a batched request!\r\n");
+            return;
+        }
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+#if defined(TFM_MULTI_CORE_TOPOLOGY) && defined(TFM_MAILBOX_WAIT_IRQ)
+#define WAIT_TEST_THREAD_NUM        NUM_MAILBOX_QUEUE_SLOT
+#define WAIT_TEST_CALL_NUM          16
+#define WAIT_TEST_STACK_SIZE        512
+/* Time for all the threads to complete, in OS ticks */
+#define WAIT_TEST_TIMEOUT           10000
+
+static void *wait_test_semaphore;
+static volatile uint32_t wait_test_failures;
+
+/**
+ * \brief Issues PSA client calls which wait for the reply interrupt, then
+ *        releases the test semaphore.
+ */
+static void wait_test_task(void *arg)
+{
+    uint32_t i;
+
+    (void)arg;
+
+    for (i = 0; i < WAIT_TEST_CALL_NUM; i++) {
+        if (psa_version(IPC_SERVICE_TEST_BASIC_SID) == PSA_VERSION_NONE) {
+            wait_test_failures++;
+        }
+    }
+
+    os_wrapper_semaphore_release(wait_test_semaphore);
+
+    os_wrapper_thread_exit();
+}
+
+/**
+ * \brief Run threads which wait for their replies at the same time, and
+ *        check that every thread is woken up by the reply interrupt.
+ */
+static void tfm_ipc_test_1014(struct test_result_t *ret)
+{
+    void *thread;
+    uint32_t priority;
+    uint32_t i;
+
+    wait_test_failures = 0;
+
+    wait_test_semaphore = os_wrapper_semaphore_create(WAIT_TEST_THREAD_NUM,
+                                                      0, "ipc_wait_sema");
+    if (!wait_test_semaphore) {
+        TEST_FAIL("Semaphore creation failed\r\n");
+        return;
+    }
+
+    if (os_wrapper_thread_get_priority(os_wrapper_thread_get_handle(),
+                                       &priority) != OS_WRAPPER_SUCCESS) {
+        os_wrapper_semaphore_delete(wait_test_semaphore);
+        TEST_FAIL("Failed to get current thread priority\r\n");
+        return;
+    }
+
+    for (i = 0; i < WAIT_TEST_THREAD_NUM; i++) {
+        thread = os_wrapper_thread_new("ipc_wait_test", WAIT_TEST_STACK_SIZE,
+                                       wait_test_task, NULL, priority);
+        if (!thread) {
+            TEST_FAIL("Failed to create test thread\r\n");
+            return;
+        }
+    }
+
+    for (i = 0; i < WAIT_TEST_THREAD_NUM; i++) {
+        /* A timeout means that a thread has missed its reply interrupt */
+        if (os_wrapper_semaphore_acquire(wait_test_semaphore,
+                                         WAIT_TEST_TIMEOUT) !=
+            OS_WRAPPER_SUCCESS) {
+            TEST_FAIL("A thread is not woken up by its reply\r\n");
+            return;
+        }
+    }
+
+    os_wrapper_semaphore_delete(wait_test_semaphore);
+
+    if (wait_test_failures != 0) {
+        TEST_FAIL("A PSA client call failed\r\n");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2018-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -8,12 +8,23 @@
 #include "ipc_s_tests.h"
 #include "psa/client.h"
 #include "test/framework/test_framework_helpers.h"
+#if defined(TFM_MSG_QUEUE_PRIORITY) && (TFM_LVL == 1)
+#include "secure_fw/core/ipc/include/tfm_internal_defines.h"
+#include "secure_fw/core/ipc/include/tfm_message_queue.h"
+#endif
 
 /* List of tests */
 static void tfm_ipc_test_1001(struct test_result_t *ret);
+#if defined(TFM_MSG_QUEUE_PRIORITY) && (TFM_LVL == 1)
+static void tfm_ipc_test_1002(struct test_result_t *ret);
+#endif
 
 static struct test_t ipc_veneers_tests[] = {
     {&tfm_ipc_test_1001, "TFM_IPC_TEST_1001", "Secure functional", {0} },
+#if defined(TFM_MSG_QUEUE_PRIORITY) && (TFM_LVL == 1)
+    {&tfm_ipc_test_1002, "TFM_IPC_TEST_1002",
+     "Message queue priority classes", {0} },
+#endif
 };
 
 void register_testsuite_s_ipc_interface(struct test_suite_t *p_test_suite)
@@ -37,3 +48,87 @@ static void tfm_ipc_test_1001(struct test_result_t *ret)
 {
     ret->val = TEST_PASSED;
 }
+
+#if defined(TFM_MSG_QUEUE_PRIORITY) && (TFM_LVL == 1)
+#define MSG_QUEUE_TEST_MSG_NUM  8
+
+/**
+ * \brief Enqueues messages of mixed priority classes into a message queue,
+ *        and checks the dequeue order. Then checks that a message of a low
+ *        class is not starved by a flow of higher class messages.
+ *
+ * \note The message queue is a local object handled by the SPM functions, so
+ *       this test only runs when the test partition is privileged.
+ */
+static void tfm_ipc_test_1002(struct test_result_t *ret)
+{
+    struct tfm_msg_queue_t queue = {0};
+    struct tfm_msg_body_t msgs[MSG_QUEUE_TEST_MSG_NUM];
+    /* Class of each message in enqueue order */
+    const uint32_t classes[MSG_QUEUE_TEST_MSG_NUM] = {
+        3, 1, 0, 2, 1, 3, 0, TFM_MSG_QUEUE_PRIOR_CLASSES
+    };
+    /*
+     * Expected dequeue order: by class, then FIFO within a class. The class
+     * out of range is handled as the lowest class.
+     */
+    const uint32_t expected[MSG_QUEUE_TEST_MSG_NUM] = {2, 6, 1, 4, 3, 0, 5, 7};
+    struct tfm_msg_body_t *msg;
+    uint32_t i;
+
+    if (TFM_MSG_QUEUE_PRIOR_CLASSES != 4) {
+        TEST_LOG("The test expects 4 priority classes, SKIPPED\r\n");
+        ret->val = TEST_PASSED;
+        return;
+    }
+
+    for (i = 0; i < MSG_QUEUE_TEST_MSG_NUM; i++) {
+        msgs[i].prior_class = classes[i];
+        if (tfm_msg_enqueue(&queue, &msgs[i]) != IPC_SUCCESS) {
+            TEST_FAIL("Failed to enqueue a message\r\n");
+            return;
+        }
+    }
+
+    for (i = 0; i < MSG_QUEUE_TEST_MSG_NUM; i++) {
+        if (tfm_msg_dequeue(&queue) != &msgs[expected[i]]) {
+            TEST_FAIL("Messages are not dequeued in priority order\r\n");
+            return;
+        }
+    }
+
+    if (!tfm_msg_queue_is_empty(&queue) || tfm_msg_dequeue(&queue) != NULL) {
+        TEST_FAIL("The message queue should be empty\r\n");
+        return;
+    }
+
+    /*
+     * Keep one message of the highest class waiting while a message of the
+     * lowest class is queued. The latter must be dequeued once it has waited
+     * for TFM_MSG_QUEUE_AGING_LIMIT dequeues.
+     */
+    msgs[0].prior_class = TFM_MSG_QUEUE_PRIOR_CLASSES - 1;
+    (void)tfm_msg_enqueue(&queue, &msgs[0]);
+    for (i = 0; i <= TFM_MSG_QUEUE_AGING_LIMIT; i++) {
+        msgs[1].prior_class = 0;
+        (void)tfm_msg_enqueue(&queue, &msgs[1]);
+        msg = tfm_msg_dequeue(&queue);
+        if (i < TFM_MSG_QUEUE_AGING_LIMIT && msg != &msgs[1]) {
+            TEST_FAIL("The highest class should be dequeued first\r\n");
+            return;
+        }
+        if (i == TFM_MSG_QUEUE_AGING_LIMIT) {
+            if (msg != &msgs[0]) {
+                TEST_FAIL("A message of the lowest class is starved\r\n");
+                return;
+            }
+            if (tfm_msg_dequeue(&queue) != &msgs[1]) {
+                TEST_FAIL("The highest class message is lost\r\n");
+                return;
+            }
+        }
+    }
+
+    ret->val = TEST_PASSED;
+}
+#endif
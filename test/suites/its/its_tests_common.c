@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -19,6 +19,75 @@
 static const uint8_t write_asset_data[ITS_MAX_ASSET_SIZE] = {0xBF};
 static uint8_t read_asset_data[ITS_MAX_ASSET_SIZE] = {0};
 
+/* Number of UIDs which can be set by test 021, as the write once UID is
+ * already stored.
+ */
+#define TEST_021_MAX_UIDS  (ITS_NUM_ASSETS - 1U)
+
+/* Number of rewrites of an asset of the maximum size which use up the free
+ * space of a data block.
+ */
+#define TEST_021_REWRITES  (((ITS_SECTOR_SIZE * ITS_SECTORS_PER_BLOCK) / \
+                             ITS_MAX_ASSET_SIZE) + 1U)
+
+static uint8_t pattern_asset_data[ITS_MAX_ASSET_SIZE] = {0};
+
+/**
+ * \brief Sets an asset of the maximum size filled with the given pattern.
+ *
+ * \param[in] uid      UID of the asset
+ * \param[in] pattern  Value of every byte of the asset
+ *
+ * \return Returns the status of the set
+ */
+static psa_status_t its_test_set_pattern(psa_storage_uid_t uid,
+                                         uint8_t pattern)
+{
+    uint32_t i;
+
+    for (i = 0; i < ITS_MAX_ASSET_SIZE; i++) {
+        pattern_asset_data[i] = pattern;
+    }
+
+    return psa_its_set(uid, ITS_MAX_ASSET_SIZE, pattern_asset_data,
+                       PSA_STORAGE_FLAG_NONE);
+}
+
+/**
+ * \brief Checks that an asset of the maximum size is filled with the given
+ *        pattern.
+ *
+ * \param[in] uid      UID of the asset
+ * \param[in] pattern  Expected value of every byte of the asset
+ *
+ * \return Returns PSA_SUCCESS if the asset content is the expected one
+ */
+static psa_status_t its_test_check_pattern(psa_storage_uid_t uid,
+                                           uint8_t pattern)
+{
+    psa_status_t status;
+    size_t read_data_length = 0;
+    uint32_t i;
+
+    status = psa_its_get(uid, 0, ITS_MAX_ASSET_SIZE, read_asset_data,
+                         &read_data_length);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (read_data_length != ITS_MAX_ASSET_SIZE) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    for (i = 0; i < ITS_MAX_ASSET_SIZE; i++) {
+        if (read_asset_data[i] != pattern) {
+            return PSA_ERROR_GENERIC_ERROR;
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
 void tfm_its_test_common_001(struct test_result_t *ret)
 {
     psa_status_t status;
@@ -1041,3 +1110,218 @@ void tfm_its_test_common_019(struct test_result_t *ret)
 
     ret->val = TEST_PASSED;
 }
+
+void tfm_its_test_common_020(struct test_result_t *ret)
+{
+    psa_status_t status;
+    const psa_storage_uid_t uid_1 = TEST_UID_1;
+    const psa_storage_uid_t uid_2 = TEST_UID_2;
+    const psa_storage_create_flags_t flags = PSA_STORAGE_FLAG_NONE;
+    const size_t offset = 0;
+    const uint8_t write_data_1[] = WRITE_DATA;
+    const uint8_t write_data_2[] = "ONE";
+    uint8_t read_data[] = READ_DATA;
+    size_t read_data_length = 0;
+    struct psa_storage_info_t info = {0};
+    int comp_result;
+
+    /* Set two UIDs, so that they are stored next to each other */
+    status = psa_its_set(uid_1, WRITE_DATA_SIZE, write_data_1, flags);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Set should not fail for the first UID");
+        return;
+    }
+
+    status = psa_its_set(uid_2, sizeof(write_data_2), write_data_2, flags);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Set should not fail for the second UID");
+        return;
+    }
+
+    /* Set the first UID with a smaller size */
+    status = psa_its_set(uid_1, sizeof(write_data_2), write_data_2, flags);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Set with a smaller size should not fail");
+        return;
+    }
+
+    /* Set the first UID with the original size again */
+    status = psa_its_set(uid_1, WRITE_DATA_SIZE, write_data_1, flags);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Set with a larger size should not fail");
+        return;
+    }
+
+    /* Check the size of the first UID */
+    status = psa_its_get_info(uid_1, &info);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Get info should not fail");
+        return;
+    }
+
+    if (info.size != WRITE_DATA_SIZE) {
+        TEST_FAIL("Size should be the one of the last set");
+        return;
+    }
+
+    /* Check the content of the first UID */
+    status = psa_its_get(uid_1, offset, WRITE_DATA_SIZE, read_data,
+                         &read_data_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Get should not fail for the first UID");
+        return;
+    }
+
+#if DOMAIN_NS == 1U
+    comp_result = memcmp(read_data, write_data_1, WRITE_DATA_SIZE);
+#else
+    comp_result = tfm_memcmp(read_data, write_data_1, WRITE_DATA_SIZE);
+#endif
+    if (comp_result != 0) {
+        TEST_FAIL("Read buffer has incorrect data for the first UID");
+        return;
+    }
+
+    /* Check that the second UID has not been modified */
+    status = psa_its_get(uid_2, offset, sizeof(write_data_2), read_data,
+                         &read_data_length);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Get should not fail for the second UID");
+        return;
+    }
+
+#if DOMAIN_NS == 1U
+    comp_result = memcmp(read_data, write_data_2, sizeof(write_data_2));
+#else
+    comp_result = tfm_memcmp(read_data, write_data_2, sizeof(write_data_2));
+#endif
+    if (comp_result != 0) {
+        TEST_FAIL("Read buffer has incorrect data for the second UID");
+        return;
+    }
+
+    /* Remove the UIDs to clean up storage for the next test */
+    status = psa_its_remove(uid_1);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Remove should not fail for the first UID");
+        return;
+    }
+
+    status = psa_its_remove(uid_2);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Remove should not fail for the second UID");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+void tfm_its_test_common_021(struct test_result_t *ret)
+{
+    psa_status_t status;
+    uint8_t patterns[TEST_021_MAX_UIDS];
+    uint8_t next_pattern;
+    uint32_t num_uids;
+    uint32_t middle;
+    uint32_t last;
+    uint32_t i;
+
+    /* Fill the storage with assets of the maximum size, so that the last
+     * ones are stored in a dedicated data block, if there is any.
+     */
+    for (num_uids = 0; num_uids < TEST_021_MAX_UIDS; num_uids++) {
+        patterns[num_uids] = (uint8_t)num_uids;
+        status = its_test_set_pattern(TEST_UID_1 + num_uids,
+                                      patterns[num_uids]);
+        if (status == PSA_ERROR_INSUFFICIENT_STORAGE) {
+            break;
+        }
+
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Set should not fail with available storage");
+            return;
+        }
+    }
+
+    if (num_uids < 3U) {
+        TEST_FAIL("At least three assets should fit in the storage");
+        return;
+    }
+
+    next_pattern = (uint8_t)num_uids;
+    middle = num_uids - 2U;
+    last = num_uids - 1U;
+
+    /* Rewrite the last asset. When its data block has enough free space, the
+     * new version is written there and the previous one becomes a gap.
+     */
+    patterns[last] = next_pattern++;
+    status = its_test_set_pattern(TEST_UID_1 + last, patterns[last]);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Rewrite of the last UID should not fail");
+        return;
+    }
+
+    /* Remove the asset in the middle, which is followed by the gap. The data
+     * block is repacked, as it has a gap.
+     */
+    status = psa_its_remove(TEST_UID_1 + middle);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Remove should not fail for the middle UID");
+        return;
+    }
+
+    status = its_test_check_pattern(TEST_UID_1 + last, patterns[last]);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Last UID should be intact after the remove");
+        return;
+    }
+
+    /* Set the middle asset again, in the space freed by the repack */
+    patterns[middle] = next_pattern++;
+    status = its_test_set_pattern(TEST_UID_1 + middle, patterns[middle]);
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Set should not fail in the freed space");
+        return;
+    }
+
+    /* Rewrite the last asset until the free space of its data block is used
+     * up, so that the block is also repacked to write a new version.
+     */
+    for (i = 0; i < TEST_021_REWRITES; i++) {
+        patterns[last] = next_pattern++;
+        status = its_test_set_pattern(TEST_UID_1 + last, patterns[last]);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Rewrite of the last UID should not fail");
+            return;
+        }
+
+        status = its_test_check_pattern(TEST_UID_1 + middle,
+                                        patterns[middle]);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Middle UID should be intact after a rewrite");
+            return;
+        }
+    }
+
+    /* Check all the assets, then remove them to clean up storage for the next
+     * test.
+     */
+    for (i = 0; i < num_uids; i++) {
+        status = its_test_check_pattern(TEST_UID_1 + i, patterns[i]);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Read data should be the last data set for every UID");
+            return;
+        }
+    }
+
+    for (i = 0; i < num_uids; i++) {
+        status = psa_its_remove(TEST_UID_1 + i);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Remove should not fail");
+            return;
+        }
+    }
+
+    ret->val = TEST_PASSED;
+}
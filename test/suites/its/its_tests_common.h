@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -230,6 +230,25 @@ void tfm_its_test_common_018(struct test_result_t *ret);
  */
 void tfm_its_test_common_019(struct test_result_t *ret);
 
+/**
+ * \brief Tests sets with different data sizes to the same UID, checking that
+ *        another UID stored next to it is not modified.
+ *
+ * \param[out] ret  Test result
+ */
+void tfm_its_test_common_020(struct test_result_t *ret);
+
+/**
+ * \brief Tests sets in the space left by removes and previous versions.
+ *        Fill the storage, rewrite the last UID and remove the UID before it,
+ *        then set it again and rewrite the last UID until the free space of
+ *        its data block is used up. Check that no UID is modified by the
+ *        writes of the other ones.
+ *
+ * \param[out] ret  Test result
+ */
+void tfm_its_test_common_021(struct test_result_t *ret);
+
 #ifdef __cplusplus
 }
 #endif
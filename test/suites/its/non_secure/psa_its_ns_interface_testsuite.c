@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -48,6 +48,10 @@ static struct test_t psa_its_ns_tests[] = {
      "Multiple sets to same UID from same thread"},
     {&tfm_its_test_common_019, "TFM_ITS_TEST_1019",
      "Set, get and remove interface with different asset sizes"},
+    {&tfm_its_test_common_020, "TFM_ITS_TEST_1020",
+     "Sets with different sizes to same UID"},
+    {&tfm_its_test_common_021, "TFM_ITS_TEST_1021",
+     "Sets in the space of removed and rewritten UIDs"},
 };
 
 void register_testsuite_ns_psa_its_interface(struct test_suite_t *p_test_suite)
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "its_s_tests.h"
+
+#include "flash_layout.h"
+#include "secure_fw/services/internal_trusted_storage/flash_fs/its_flash_fs.h"
+#include "secure_fw/services/internal_trusted_storage/its_utils.h"
+#include "test/framework/test_framework_helpers.h"
+#include "tfm_memory_utils.h"
+
+/* Client ID of the test files, not used by any client of the ITS service */
+#define TEST_CLIENT_ID      0x7FFF4954
+
+/* Enough files of the maximum size to fill more than one data block, so that
+ * the files placed in the logical block 0 and in the other data blocks are
+ * written.
+ */
+#define TEST_NUM_FILES      (ITS_NUM_ASSETS - 1U)
+#define TEST_FILE_SIZE      ITS_MAX_ASSET_SIZE
+
+/* Region overwritten by each partial write, aligned with the program unit */
+#define TEST_WRITE_OFFSET   GET_ALIGNED_FLASH_BYTES(16U)
+#define TEST_WRITE_SIZE     GET_ALIGNED_FLASH_BYTES(16U)
+
+/* Number of partial writes of each file. The first writes of the files
+ * outside of the logical block 0 take the free space of their data block,
+ * the following ones need the gaps left by the previous versions to be
+ * removed.
+ */
+#define TEST_NUM_ROUNDS     4U
+
+/* Size of the chunks read back to check the content of a file */
+#define TEST_READ_SIZE      64U
+
+/* List of tests */
+static void tfm_its_test_4001(struct test_result_t *ret);
+
+static struct test_t flash_fs_tests[] = {
+    {&tfm_its_test_4001, "TFM_ITS_TEST_4001",
+     "Partial writes at an offset keep the rest of the file", {0}},
+};
+
+void register_testsuite_s_its_flash_fs(struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(flash_fs_tests) / sizeof(flash_fs_tests[0]));
+
+    set_testsuite("ITS flash filesystem tests (TFM_ITS_TEST_4XXX)",
+                  flash_fs_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Builds the file ID of a test file.
+ *
+ * \param[in]  file  Index of the test file
+ * \param[out] fid   File ID
+ */
+static void its_test_get_fid(uint32_t file, uint8_t *fid)
+{
+    const int32_t client_id = TEST_CLIENT_ID;
+    const uint64_t uid = file + 1U;
+
+    tfm_memcpy(fid, &client_id, sizeof(client_id));
+    tfm_memcpy(fid + sizeof(client_id), &uid, sizeof(uid));
+}
+
+/**
+ * \brief Gets the expected byte of a test file.
+ *
+ * \param[in] file   Index of the test file
+ * \param[in] round  Number of partial writes done in the file
+ * \param[in] pos    Position of the byte in the file
+ *
+ * \return Value of the byte
+ */
+static uint8_t its_test_file_byte(uint32_t file, uint32_t round, size_t pos)
+{
+    if ((round > 0) && (pos >= TEST_WRITE_OFFSET) &&
+        (pos < (TEST_WRITE_OFFSET + TEST_WRITE_SIZE))) {
+        return (uint8_t)(0xA0U + (file << 4) + round);
+    }
+
+    return (uint8_t)((file * 31U) + pos);
+}
+
+/**
+ * \brief Data callback of the filesystem which generates the content of a
+ *        test file.
+ *
+ * \param[in]  context  Test file index, round and position, as an array
+ * \param[out] buf      Buffer to store the data
+ * \param[in]  size     Size of the data
+ *
+ * \return Returns PSA_SUCCESS
+ */
+static psa_status_t its_test_get_data(void *context, uint8_t *buf, size_t size)
+{
+    uint32_t *cursor = (uint32_t *)context;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        buf[i] = its_test_file_byte(cursor[0], cursor[1], cursor[2]++);
+    }
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Checks the whole content of a test file.
+ *
+ * \param[in] file   Index of the test file
+ * \param[in] round  Number of partial writes done in the file
+ *
+ * \return Returns PSA_SUCCESS if the content is the expected one
+ */
+static psa_status_t its_test_check_file(uint32_t file, uint32_t round)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint8_t buf[TEST_READ_SIZE];
+    struct its_file_info_t info;
+    psa_status_t status;
+    size_t pos;
+    size_t i;
+
+    its_test_get_fid(file, fid);
+
+    status = its_flash_fs_file_get_info(fid, &info);
+    if (status != PSA_SUCCESS) {
+        return status;
+    }
+
+    if (info.size_current != TEST_FILE_SIZE) {
+        return PSA_ERROR_GENERIC_ERROR;
+    }
+
+    for (pos = 0; pos < TEST_FILE_SIZE; pos += TEST_READ_SIZE) {
+        status = its_flash_fs_file_read(fid, TEST_READ_SIZE, pos, buf);
+        if (status != PSA_SUCCESS) {
+            return status;
+        }
+
+        for (i = 0; i < TEST_READ_SIZE; i++) {
+            if (buf[i] != its_test_file_byte(file, round, pos + i)) {
+                return PSA_ERROR_GENERIC_ERROR;
+            }
+        }
+    }
+
+    return PSA_SUCCESS;
+}
+
+/**
+ * \brief Writes a part of each file in turn, several times, and checks that
+ *        the content of the files which is not overwritten is kept, also
+ *        after the filesystem is prepared again.
+ *
+ * \param[out] ret  Test result
+ */
+static void tfm_its_test_4001(struct test_result_t *ret)
+{
+    uint8_t fid[ITS_FILE_ID_SIZE];
+    uint32_t cursor[3];
+    psa_status_t status;
+    uint32_t round;
+    uint32_t file;
+
+    for (file = 0; file < TEST_NUM_FILES; file++) {
+        its_test_get_fid(file, fid);
+        cursor[0] = file;
+        cursor[1] = 0;
+        cursor[2] = 0;
+
+        status = its_flash_fs_file_create(fid, TEST_FILE_SIZE, TEST_FILE_SIZE,
+                                          0, its_test_get_data, cursor);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Create should not fail");
+            return;
+        }
+    }
+
+    for (round = 1; round <= TEST_NUM_ROUNDS; round++) {
+        for (file = 0; file < TEST_NUM_FILES; file++) {
+            its_test_get_fid(file, fid);
+            cursor[0] = file;
+            cursor[1] = round;
+            cursor[2] = TEST_WRITE_OFFSET;
+
+            status = its_flash_fs_file_write(fid, TEST_WRITE_SIZE,
+                                             TEST_WRITE_OFFSET,
+                                             its_test_get_data, cursor);
+            if (status != PSA_SUCCESS) {
+                TEST_FAIL("Partial write should not fail");
+                return;
+            }
+
+            if (its_test_check_file(file, round) != PSA_SUCCESS) {
+                TEST_FAIL("File content should be kept around the write");
+                return;
+            }
+        }
+    }
+
+    /* Reads the filesystem metadata back from flash, as after a reboot */
+    status = its_flash_fs_prepare();
+    if (status != PSA_SUCCESS) {
+        TEST_FAIL("Prepare should not fail");
+        return;
+    }
+
+    for (file = 0; file < TEST_NUM_FILES; file++) {
+        if (its_test_check_file(file, TEST_NUM_ROUNDS) != PSA_SUCCESS) {
+            TEST_FAIL("File content should be kept after a prepare");
+            return;
+        }
+
+        its_test_get_fid(file, fid);
+        status = its_flash_fs_file_delete(fid);
+        if (status != PSA_SUCCESS) {
+            TEST_FAIL("Delete should not fail");
+            return;
+        }
+    }
+
+    ret->val = TEST_PASSED;
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -30,6 +30,13 @@ void register_testsuite_s_psa_its_interface(struct test_suite_t *p_test_suite);
 void register_testsuite_s_psa_its_reliability(struct test_suite_t
                                                                  *p_test_suite);
 
+/**
+ * \brief Register testsuite for the ITS flash filesystem tests.
+ *
+ * \param[in] p_test_suite  The test suite to be executed.
+ */
+void register_testsuite_s_its_flash_fs(struct test_suite_t *p_test_suite);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2019-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -68,6 +68,10 @@ static struct test_t psa_its_s_tests[] = {
      "Get info interface with NULL info pointer"},
     {&tfm_its_test_2023, "TFM_ITS_TEST_2023",
      "Attempt to get a UID set by a different partition"},
+    {&tfm_its_test_common_020, "TFM_ITS_TEST_2024",
+     "Sets with different sizes to same UID"},
+    {&tfm_its_test_common_021, "TFM_ITS_TEST_2025",
+     "Sets in the space of removed and rewritten UIDs"},
 };
 
 void register_testsuite_s_psa_its_interface(struct test_suite_t *p_test_suite)
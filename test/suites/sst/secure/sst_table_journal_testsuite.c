@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2020, Arm Limited. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ *
+ */
+
+#include "sst_tests.h"
+
+#include "psa/protected_storage.h"
+#include "tfm_memory_utils.h"
+#include "s_test_helpers.h"
+
+/* This include is required to expose the sst_system_prepare function, via the
+ * tfm_sst_test_system_prepare API, to simulate a reboot in the system.
+ * sst_system_prepare is called when the SST service is initialized.
+ */
+#include "test/test_services/tfm_sst_test_service/tfm_sst_test_service_api.h"
+
+#include "test/framework/test_framework_helpers.h"
+
+/* Test UIDs */
+#define TEST_UID_1 2UL  /* UID 1 cannot be used as it references a write once
+                         * asset, created in psa_ps_s_interface_testsuite.c
+                         */
+#define TEST_UID_2 3UL
+
+/* Write data */
+#define WRITE_DATA       "THE_FIVE_BOXING_WIZARDS_JUMP_QUICKLY"
+#define WRITE_DATA_SIZE  (sizeof(WRITE_DATA) - 1)
+#define READ_DATA        "############################################"
+#define RESULT_DATA      ("####" WRITE_DATA "####")
+
+/* Number of sets in test 5002. Each set commits at least one change of the
+ * object table, so the journal of the default size is compacted twice.
+ */
+#define LOOP_ITERATIONS_002 20U
+
+/* List of tests */
+static void tfm_sst_test_5001(struct test_result_t *ret);
+static void tfm_sst_test_5002(struct test_result_t *ret);
+
+static struct test_t table_journal_tests[] = {
+    {&tfm_sst_test_5001, "TFM_SST_TEST_5001",
+     "Replay of the object table journal after a reboot", {0}},
+    {&tfm_sst_test_5002, "TFM_SST_TEST_5002",
+     "Compaction of the object table journal", {0}},
+};
+
+void register_testsuite_s_table_journal(struct test_suite_t *p_test_suite)
+{
+    uint32_t list_size = (sizeof(table_journal_tests) /
+                          sizeof(table_journal_tests[0]));
+
+    set_testsuite("SST object table journal tests (TFM_SST_TEST_5XXX)",
+                  table_journal_tests, list_size, p_test_suite);
+}
+
+/**
+ * \brief Checks that the changes committed in the journal, and not in the
+ *        object table, are applied after a reboot.
+ */
+static void tfm_sst_test_5001(struct test_result_t *ret)
+{
+    psa_ps_status_t status;
+    const psa_ps_create_flags_t flags = PSA_PS_FLAG_NONE;
+    const uint32_t data_len = WRITE_DATA_SIZE;
+    const uint32_t offset = 0;
+    const uint8_t write_data[] = WRITE_DATA;
+    uint8_t read_data[] = READ_DATA;
+    struct psa_ps_info_t info = {0};
+
+    /* Simulates a reboot, so that the journal is empty when the test starts */
+    status = tfm_sst_test_system_prepare();
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("AM prepare should not fail");
+        return;
+    }
+
+    /* Creates two assets and removes the first one. The changes fit in the
+     * journal, so the object table is not saved.
+     */
+    status = psa_ps_set(TEST_UID_1, data_len, write_data, flags);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Set should not fail for UID 1");
+        return;
+    }
+
+    status = psa_ps_set(TEST_UID_2, data_len, write_data, flags);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Set should not fail for UID 2");
+        return;
+    }
+
+    status = psa_ps_remove(TEST_UID_1);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Remove should not fail for UID 1");
+        return;
+    }
+
+    /* Simulates a power loss followed by a reboot. The object table is read
+     * from the persistent memory and the journal is replayed.
+     */
+    status = tfm_sst_test_system_prepare();
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("AM prepare should not fail");
+        return;
+    }
+
+    /* The remove of the first asset has been replayed */
+    status = psa_ps_get_info(TEST_UID_1, &info);
+    if (status != PSA_PS_ERROR_UID_NOT_FOUND) {
+        TEST_FAIL("UID 1 should not exist after the reboot");
+        return;
+    }
+
+    /* The creation of the second asset has been replayed */
+    status = psa_ps_get(TEST_UID_2, offset, data_len,
+                        (read_data + HALF_PADDING_SIZE));
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Get should not fail for UID 2");
+        return;
+    }
+
+    if (tfm_memcmp(read_data, RESULT_DATA, sizeof(read_data)) != 0) {
+        TEST_FAIL("Read buffer has incorrect data");
+        return;
+    }
+
+    /* Removes the asset to clean up storage for the next test */
+    status = psa_ps_remove(TEST_UID_2);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Remove should not fail for UID 2");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
+
+/**
+ * \brief Checks that the object table is consistent after a reboot, whatever
+ *        the number of changes committed since the last compaction of the
+ *        journal.
+ */
+static void tfm_sst_test_5002(struct test_result_t *ret)
+{
+    psa_ps_status_t status;
+    const psa_ps_uid_t uid = TEST_UID_1;
+    const psa_ps_create_flags_t flags = PSA_PS_FLAG_NONE;
+    const uint32_t offset = 0;
+    uint8_t write_data[] = WRITE_DATA;
+    uint8_t read_data[WRITE_DATA_SIZE];
+    uint32_t itr;
+
+    for (itr = 0; itr < LOOP_ITERATIONS_002; itr++) {
+        TEST_LOG("  > Iteration %d of %d\r", itr + 1, LOOP_ITERATIONS_002);
+
+        /* Changes the data of every iteration, so that an older version of
+         * the asset cannot be read back by mistake.
+         */
+        write_data[0] = (uint8_t)('A' + itr);
+
+        status = psa_ps_set(uid, WRITE_DATA_SIZE, write_data, flags);
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Set should not fail with valid UID");
+            return;
+        }
+
+        /* Simulates a power loss followed by a reboot */
+        status = tfm_sst_test_system_prepare();
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("AM prepare should not fail");
+            return;
+        }
+
+        status = psa_ps_get(uid, offset, WRITE_DATA_SIZE, read_data);
+        if (status != PSA_PS_SUCCESS) {
+            TEST_FAIL("Get should not fail with valid UID");
+            return;
+        }
+
+        if (tfm_memcmp(read_data, write_data, WRITE_DATA_SIZE) != 0) {
+            TEST_FAIL("Read data should be the last data set");
+            return;
+        }
+    }
+
+    TEST_LOG("\n");
+
+    /* Removes the asset to clean up storage for the next test */
+    status = psa_ps_remove(uid);
+    if (status != PSA_PS_SUCCESS) {
+        TEST_FAIL("Remove should not fail with valid UID");
+        return;
+    }
+
+    ret->val = TEST_PASSED;
+}
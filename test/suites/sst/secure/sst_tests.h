@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2019, Arm Limited. All rights reserved.
+ * Copyright (c) 2017-2020, Arm Limited. All rights reserved.
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
@@ -38,6 +38,15 @@ void register_testsuite_s_rollback_protection(
                                              struct test_suite_t *p_test_suite);
 #endif
 
+#ifdef SST_TEST_TABLE_JOURNAL
+/**
+ * \brief Register testsuite for the sst object table journal tests.
+ *
+ * \param[in] p_test_suite  The test suite to be executed.
+ */
+void register_testsuite_s_table_journal(struct test_suite_t *p_test_suite);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
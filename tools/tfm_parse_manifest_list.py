@@ -1,5 +1,5 @@
 #-------------------------------------------------------------------------------
-# Copyright (c) 2018-2019, Arm Limited. All rights reserved.
+# Copyright (c) 2018-2020, Arm Limited. All rights reserved.
 #
 # SPDX-License-Identifier: BSD-3-Clause
 #
@@ -124,6 +124,42 @@ def process_manifest(manifest_list_file, append):
 
     return manifest_header_list, db
 
+def gen_sorted_sid_list(db):
+    """
+    Build the list of the services of the IPC partitions, sorted by SID, so
+    that the SPM can look up a service by SID with a binary search.
+
+    Parameters
+    ----------
+    db:
+        The data base of the manifests.
+
+    Returns
+    -------
+    The sorted list of the services, each with its SID, name and the
+    conditional of its partition.
+    """
+    sid_list = []
+
+    for manifest in db:
+        if not manifest["attr"].get("tfm_partition_ipc"):
+            continue
+
+        for service in manifest["manifest"].get("services", []):
+            sid_list.append({"sid": int(str(service["sid"]), 0),
+                             "name": service["name"],
+                             "conditional": manifest["attr"].get("conditional")})
+
+    sid_list.sort(key=lambda service: service["sid"])
+
+    for prev, curr in zip(sid_list, sid_list[1:]):
+        if prev["sid"] == curr["sid"]:
+            print ("Error: services " + prev["name"] + " and " + curr["name"] +
+                   " have the same SID")
+            exit(1)
+
+    return sid_list
+
 def gen_files(context, gen_file_list, append):
     """
     Generate files according to the gen_file_list
@@ -281,6 +317,7 @@ def main():
 
     utilities['donotedit_warning']=donotedit_warning
     utilities['manifest_header_list']=manifest_header_list
+    utilities['sorted_sid_list']=gen_sorted_sid_list(db)
 
     context['manifests'] = db
     context['utilities'] = utilities